@@ -0,0 +1,59 @@
+#include <cassert>
+
+class Shape
+{
+public:
+  virtual int sides()
+  {
+    return 0;
+  }
+};
+
+class Triangle : public Shape
+{
+public:
+  virtual int sides()
+  {
+    return 3;
+  }
+};
+
+class Square : public Shape
+{
+public:
+  virtual int sides()
+  {
+    return 4;
+  }
+};
+
+static int twice(int x)
+{
+  return 2 * x;
+}
+
+struct callback
+{
+  void *fn;
+};
+
+int count(void *p)
+{
+  return static_cast<Shape *>(p)->sides();
+}
+
+int main()
+{
+  Triangle t;
+  Square s;
+  assert(count(&t) == 3);
+  assert(count(&s) == 4);
+
+  // Function addresses kept as data
+  callback cb;
+  cb.fn = (void *)&twice;
+  unsigned long addr = (unsigned long)cb.fn;
+  int (*f)(int) = (int (*)(int))addr;
+  assert(f(s.sides()) == 6);
+  return 0;
+}
@@ -0,0 +1,49 @@
+#include <cassert>
+
+int nondet_int();
+
+class Animal
+{
+public:
+  virtual int legs()
+  {
+    return 4;
+  }
+  virtual int wings()
+  {
+    return 0;
+  }
+};
+
+class Bird : public Animal
+{
+public:
+  virtual int legs()
+  {
+    return 2;
+  }
+  virtual int wings()
+  {
+    return 2;
+  }
+};
+
+class Fish : public Animal
+{
+public:
+  virtual int legs()
+  {
+    return 0;
+  }
+};
+
+int main()
+{
+  Animal a;
+  Bird b;
+  Fish f;
+  int n = nondet_int();
+  Animal *p = n == 0 ? &a : n == 1 ? static_cast<Animal *>(&b) : &f;
+  assert(p->legs() + p->wings() != 4);
+  return 0;
+}
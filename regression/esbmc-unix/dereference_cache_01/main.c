@@ -0,0 +1,20 @@
+#include <assert.h>
+
+int nondet_int();
+
+int a[4], b[4];
+
+int main()
+{
+  int *p = nondet_int() ? a : b;
+  int sum = 0;
+
+  for(int i = 0; i < 4; i++)
+  {
+    p[i] = i;
+    sum += p[i];
+  }
+
+  assert(sum == 6);
+  return 0;
+}
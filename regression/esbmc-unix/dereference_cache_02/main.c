@@ -0,0 +1,11 @@
+int main()
+{
+  int a[4];
+  int *p = a;
+  int sum = 0;
+
+  for(int i = 0; i <= 4; i++)
+    sum += p[i];
+
+  return sum;
+}
@@ -0,0 +1,49 @@
+#include <assert.h>
+
+int nondet_int();
+
+struct ops
+{
+  int (*get)(int);
+  void (*put)(int *, int);
+};
+
+static int get_twice(int x)
+{
+  return 2 * x;
+}
+
+static int get_plus(int x)
+{
+  return x + 1;
+}
+
+static void put_value(int *p, int x)
+{
+  *p = x;
+}
+
+static int unrelated(int x)
+{
+  return -x;
+}
+
+struct ops table[2] = {{get_twice, put_value}, {get_plus, put_value}};
+
+int apply(int (*f)(int), int x)
+{
+  return f(x);
+}
+
+int main()
+{
+  int (*other)(int) = unrelated;
+  int i = nondet_int();
+  __ESBMC_assume(i >= 0 && i < 2);
+
+  int v;
+  table[i].put(&v, table[i].get(3));
+  assert(v == 6 || v == 4);
+  assert(apply(other, 1) == -1);
+  return 0;
+}
@@ -0,0 +1,20 @@
+#include <assert.h>
+
+int nondet_int();
+
+static int inc(int x)
+{
+  return x + 1;
+}
+
+static int dec(int x)
+{
+  return x - 1;
+}
+
+int main()
+{
+  int (*f)(int) = nondet_int() ? inc : dec;
+  assert(f(1) == 2);
+  return 0;
+}
@@ -0,0 +1,29 @@
+#include <assert.h>
+#include <pthread.h>
+
+static int inc(int x)
+{
+  return x + 1;
+}
+
+static int dec(int x)
+{
+  return x - 1;
+}
+
+int (*g)(int) = inc;
+
+void *t(void *arg)
+{
+  g = dec;
+  return NULL;
+}
+
+int main()
+{
+  pthread_t id;
+  pthread_create(&id, NULL, t, NULL);
+  int r = g(1);
+  assert(r == 2 || r == 0);
+  return 0;
+}
@@ -0,0 +1,16 @@
+#include <stddef.h>
+
+int nondet_int();
+
+static int inc(int x)
+{
+  return x + 1;
+}
+
+int main()
+{
+  int (*f)(int) = NULL;
+  if(nondet_int())
+    f = inc;
+  return f(1);
+}
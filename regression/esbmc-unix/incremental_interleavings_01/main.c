@@ -0,0 +1,30 @@
+#include <assert.h>
+#include <pthread.h>
+
+int a = 0, b = 0;
+
+void *t1(void *arg)
+{
+  a = 1;
+  b = a + 1;
+  return NULL;
+}
+
+void *t2(void *arg)
+{
+  int x = b;
+  int y = a;
+  assert(x <= y + 1);
+  assert(!(x == 2 && y == 1));
+  return NULL;
+}
+
+int main()
+{
+  pthread_t id1, id2;
+  pthread_create(&id1, NULL, t1, NULL);
+  pthread_create(&id2, NULL, t2, NULL);
+  pthread_join(id1, NULL);
+  pthread_join(id2, NULL);
+  return 0;
+}
@@ -0,0 +1,29 @@
+#include <assert.h>
+#include <pthread.h>
+
+int x = 0;
+
+void *t1(void *arg)
+{
+  x = 1;
+  x = x + 1;
+  return NULL;
+}
+
+void *t2(void *arg)
+{
+  x = 3;
+  x = x * 2;
+  return NULL;
+}
+
+int main()
+{
+  pthread_t id1, id2;
+  pthread_create(&id1, NULL, t1, NULL);
+  pthread_create(&id2, NULL, t2, NULL);
+  pthread_join(id1, NULL);
+  pthread_join(id2, NULL);
+  assert(x == 2 || x == 6);
+  return 0;
+}
@@ -0,0 +1,27 @@
+#include <assert.h>
+#include <pthread.h>
+
+pthread_mutex_t m;
+int x = 0;
+
+void *inc(void *arg)
+{
+  pthread_mutex_lock(&m);
+  x = x + 1;
+  pthread_mutex_unlock(&m);
+  return NULL;
+}
+
+int main()
+{
+  pthread_t id1, id2, id3;
+  pthread_mutex_init(&m, NULL);
+  pthread_create(&id1, NULL, inc, NULL);
+  pthread_create(&id2, NULL, inc, NULL);
+  pthread_create(&id3, NULL, inc, NULL);
+  pthread_join(id1, NULL);
+  pthread_join(id2, NULL);
+  pthread_join(id3, NULL);
+  assert(x == 3);
+  return 0;
+}
@@ -0,0 +1,23 @@
+#include <assert.h>
+
+struct point
+{
+  int x;
+  int y;
+};
+
+struct point pts[8];
+
+int main()
+{
+  struct point *p = pts;
+
+  for(int i = 0; i < 8; i++)
+  {
+    (p + i)->x = i;
+    (p + i)->y = 2 * i;
+  }
+
+  assert(pts[7].y == 14);
+  return 0;
+}
@@ -0,0 +1,20 @@
+#include <stdio.h>
+
+struct point
+{
+  int x;
+  int y;
+};
+
+struct point pts[8];
+
+int main()
+{
+  struct point *p = pts;
+  int i = 0;
+
+  scanf("%d", &i);
+  (p + i)->x = 1;
+
+  return 0;
+}
@@ -0,0 +1,22 @@
+#include <assert.h>
+#include <pthread.h>
+
+int x = 0;
+
+void *inc(void *arg)
+{
+  int tmp = x;
+  x = tmp + 1;
+  return NULL;
+}
+
+int main()
+{
+  pthread_t id1, id2;
+  pthread_create(&id1, NULL, inc, NULL);
+  pthread_create(&id2, NULL, inc, NULL);
+  pthread_join(id1, NULL);
+  pthread_join(id2, NULL);
+  assert(x == 2);
+  return 0;
+}
@@ -0,0 +1,27 @@
+#include <assert.h>
+#include <pthread.h>
+
+pthread_mutex_t m = PTHREAD_MUTEX_INITIALIZER;
+int x = 0;
+
+void *inc(void *arg)
+{
+  int n = *(int *)arg;
+  pthread_mutex_lock(&m);
+  int tmp = x;
+  x = tmp + n;
+  pthread_mutex_unlock(&m);
+  return NULL;
+}
+
+int main()
+{
+  pthread_t id1, id2;
+  int a = 1, b = 2;
+  pthread_create(&id1, NULL, inc, &a);
+  pthread_create(&id2, NULL, inc, &b);
+  pthread_join(id1, NULL);
+  pthread_join(id2, NULL);
+  assert(x == 3);
+  return 0;
+}
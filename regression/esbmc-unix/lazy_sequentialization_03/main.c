@@ -0,0 +1,22 @@
+#include <assert.h>
+#include <pthread.h>
+
+int x = 0;
+
+void *inc(void *arg)
+{
+  int tmp = x;
+  x = tmp + 1;
+  return NULL;
+}
+
+int main()
+{
+  pthread_t id[2];
+  for(int i = 0; i < 2; i++)
+    pthread_create(&id[i], NULL, inc, NULL);
+  for(int i = 0; i < 2; i++)
+    pthread_join(id[i], NULL);
+  assert(x == 2);
+  return 0;
+}
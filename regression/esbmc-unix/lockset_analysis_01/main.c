@@ -0,0 +1,32 @@
+#include <assert.h>
+#include <pthread.h>
+
+pthread_mutex_t m = PTHREAD_MUTEX_INITIALIZER;
+int count = 0;
+int last = 0;
+
+void *t1(void *arg)
+{
+  last = 1;
+  pthread_mutex_lock(&m);
+  count++;
+  assert(count <= 2);
+  pthread_mutex_unlock(&m);
+  return NULL;
+}
+
+void *t2(void *arg)
+{
+  pthread_mutex_lock(&m);
+  count++;
+  pthread_mutex_unlock(&m);
+  return NULL;
+}
+
+int main()
+{
+  pthread_t id1, id2;
+  pthread_create(&id1, NULL, t1, NULL);
+  pthread_create(&id2, NULL, t2, NULL);
+  return 0;
+}
@@ -0,0 +1,26 @@
+#include <pthread.h>
+
+pthread_mutex_t m = PTHREAD_MUTEX_INITIALIZER;
+int count = 0;
+
+void *t1(void *arg)
+{
+  pthread_mutex_lock(&m);
+  count++;
+  pthread_mutex_unlock(&m);
+  return NULL;
+}
+
+void *t2(void *arg)
+{
+  count++;
+  return NULL;
+}
+
+int main()
+{
+  pthread_t id1, id2;
+  pthread_create(&id1, NULL, t1, NULL);
+  pthread_create(&id2, NULL, t2, NULL);
+  return 0;
+}
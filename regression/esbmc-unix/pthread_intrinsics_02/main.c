@@ -0,0 +1,33 @@
+#include <pthread.h>
+
+pthread_mutex_t a, b;
+
+void *t1(void *arg)
+{
+  pthread_mutex_lock(&a);
+  pthread_mutex_lock(&b);
+  pthread_mutex_unlock(&b);
+  pthread_mutex_unlock(&a);
+  return NULL;
+}
+
+void *t2(void *arg)
+{
+  pthread_mutex_lock(&b);
+  pthread_mutex_lock(&a);
+  pthread_mutex_unlock(&a);
+  pthread_mutex_unlock(&b);
+  return NULL;
+}
+
+int main()
+{
+  pthread_t id1, id2;
+  pthread_mutex_init(&a, NULL);
+  pthread_mutex_init(&b, NULL);
+  pthread_create(&id1, NULL, t1, NULL);
+  pthread_create(&id2, NULL, t2, NULL);
+  pthread_join(id1, NULL);
+  pthread_join(id2, NULL);
+  return 0;
+}
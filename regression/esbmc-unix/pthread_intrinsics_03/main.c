@@ -0,0 +1,17 @@
+#include <pthread.h>
+
+pthread_mutex_t m = PTHREAD_MUTEX_INITIALIZER;
+
+void *t(void *arg)
+{
+  pthread_mutex_unlock(&m);
+  return NULL;
+}
+
+int main()
+{
+  pthread_t id;
+  pthread_create(&id, NULL, t, NULL);
+  pthread_join(id, NULL);
+  return 0;
+}
@@ -0,0 +1,20 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define N 64
+
+int main()
+{
+  char *p[N];
+  for(int i = 0; i < N; i++)
+    p[i] = malloc(4);
+
+  // Live objects never overlap, in whichever order they are laid out
+  for(int i = 0; i + 1 < N; i++)
+    assert(
+      (uintptr_t)p[i] + 4 <= (uintptr_t)p[i + 1] ||
+      (uintptr_t)p[i + 1] + 4 <= (uintptr_t)p[i]);
+
+  return 0;
+}
@@ -0,0 +1,18 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+int main()
+{
+  char *a = malloc(8);
+  char *b = malloc(8);
+  char *c = malloc(8);
+
+  // Objects are disjoint, but not necessarily far apart
+  assert((uintptr_t)c - (uintptr_t)a > 64);
+
+  free(a);
+  free(b);
+  free(c);
+  return 0;
+}
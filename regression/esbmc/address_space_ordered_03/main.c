@@ -0,0 +1,24 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/* Allocation-heavy benchmark for the address space encoding: the pairwise
+ * encoding asserts about N^2 / 2 non-overlap constraints here, the ordered
+ * one about 2 * N. Run it with both --address-space-encoding settings to
+ * compare. */
+#define N 2000
+
+int nondet_int();
+
+int main()
+{
+  static char *p[N];
+  for(int i = 0; i < N; i++)
+    p[i] = malloc(16);
+
+  int i = nondet_int();
+  __ESBMC_assume(i > 0 && i < N);
+  assert(p[i] != p[i - 1]);
+
+  return 0;
+}
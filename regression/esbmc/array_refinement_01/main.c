@@ -0,0 +1,18 @@
+#include <assert.h>
+
+int a[100000];
+
+int main()
+{
+  unsigned i = nondet_uint();
+  unsigned j = nondet_uint();
+  __ESBMC_assume(i < 100000 && j < 100000);
+
+  a[i] = 1;
+  a[j] = 2;
+
+  // Only a write to the same index can change a[i]
+  assert(a[i] == 1 || i == j);
+  assert(a[j] == 2);
+  return 0;
+}
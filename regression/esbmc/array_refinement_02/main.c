@@ -0,0 +1,18 @@
+#include <assert.h>
+
+int a[100000];
+
+int main()
+{
+  unsigned i = nondet_uint();
+  unsigned j = nondet_uint();
+  unsigned k = nondet_uint();
+  __ESBMC_assume(i < 100000 && j < 100000 && k < 100000);
+
+  a[i] = 1;
+  a[j] = 2;
+
+  // Fails when k is i, or when j and k alias
+  assert(a[k] == 0);
+  return 0;
+}
@@ -0,0 +1,17 @@
+#include <assert.h>
+
+float nondet_float();
+
+int main()
+{
+  float x = nondet_float();
+  __ESBMC_assume(x >= 1.0f && x <= 2.0f);
+
+  float y = x * 2.0f;
+  assert(y >= 2.0f && y <= 4.0f);
+
+  // Scaling by powers of two is exact in this range
+  float z = y / 2.0f;
+  assert(z == x);
+  return 0;
+}
@@ -0,0 +1,14 @@
+#include <assert.h>
+
+float nondet_float();
+
+int main()
+{
+  float x = nondet_float();
+  __ESBMC_assume(x > 0.0f && x < 1.0f);
+
+  // Small values of x are absorbed by the addition
+  float y = x + 1.0f;
+  assert(y - 1.0f == x);
+  return 0;
+}
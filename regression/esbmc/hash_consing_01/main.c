@@ -0,0 +1,16 @@
+#include <assert.h>
+
+int a[16];
+
+int main()
+{
+  int *p = a;
+  for(int i = 0; i < 16; i++)
+    *(p + i) = i;
+
+  for(int i = 0; i < 16; i++)
+    assert(*(p + i) == a[i]);
+
+  assert(a[15] == 16);
+  return 0;
+}
@@ -0,0 +1,42 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+struct node
+{
+  int value;
+  struct node *next;
+};
+
+int main()
+{
+  int a[4] = {1, 2, 3, 4};
+  int *p = a + 1;
+  int *q = &a[3];
+  assert(*p == 2);
+  assert(q - p == 2);
+  assert(p < q);
+
+  struct node n2 = {2, NULL};
+  struct node n1 = {1, &n2};
+  assert(n1.next->value == 2);
+  assert(n1.next->next == NULL);
+
+  int *ptrs[3] = {&a[0], NULL, q};
+  assert(*ptrs[2] == 4);
+  assert(ptrs[1] == NULL);
+
+  uintptr_t addr = (uintptr_t)p;
+  int *r = (int *)(addr + sizeof(int));
+  assert(*r == 3);
+
+  int *heap = malloc(sizeof(int));
+  if(heap)
+  {
+    *heap = 5;
+    assert(*heap == 5);
+    free(heap);
+  }
+
+  return 0;
+}
@@ -0,0 +1,16 @@
+#include <stdlib.h>
+
+int nondet_int();
+
+int main()
+{
+  int a[2];
+  int *p = a;
+  int n = nondet_int();
+  if(n > 0)
+    p = malloc(sizeof(int));
+
+  // Out of bounds when p points to the heap object
+  p[1] = 0;
+  return 0;
+}
@@ -0,0 +1,21 @@
+#include <assert.h>
+
+struct s
+{
+  int a[8];
+  int n;
+};
+
+int main()
+{
+  struct s x;
+  x.n = 0;
+  for(int i = 0; i < 8; i++)
+  {
+    x.a[i] = i * 2;
+    x.n += x.a[i];
+  }
+
+  assert(x.n == 56);
+  return 0;
+}
@@ -0,0 +1,16 @@
+#include <assert.h>
+
+unsigned char nondet_uchar();
+
+int main()
+{
+  unsigned char c = nondet_uchar();
+  int limit = 200;
+  int a = c * 2, b = c * 2;
+
+  if(c < limit)
+    assert(a == b);
+
+  assert(c <= 255);
+  return 0;
+}
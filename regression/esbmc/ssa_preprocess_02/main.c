@@ -0,0 +1,13 @@
+#include <assert.h>
+
+int nondet_int();
+
+int main()
+{
+  int x = nondet_int();
+  int y = x + 5;
+  int z = ~y;
+
+  assert(z != 7);
+  return 0;
+}
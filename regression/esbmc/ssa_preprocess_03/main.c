@@ -0,0 +1,18 @@
+#include <assert.h>
+
+int nondet_int();
+
+int main()
+{
+  // Only used here, so x ^ 85 may take any value x does
+  int x = nondet_int();
+  int y = x ^ 85;
+  if(y == 7)
+    return 1;
+
+  // Used twice, so u + 1 must keep its shape
+  int u = nondet_int();
+  int v = u + 1;
+  assert(v != u);
+  return 0;
+}
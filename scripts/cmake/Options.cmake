@@ -35,6 +35,7 @@ option(ENABLE_MATHSAT "Use MathSAT solver (default: OFF)" OFF)
 option(ENABLE_YICES "Use Yices solver (default: OFF)" OFF)
 option(ENABLE_CVC4 "Use CVC4 solver (default: OFF)" OFF)
 option(ENABLE_BITWUZLA "Use Bitwuzla solver (default: OFF)" OFF)
+option(ENABLE_SAT "Use the built-in SAT solver (default: OFF)" OFF)
 
 #############################
 # OTHERS
@@ -269,11 +269,20 @@ digit_div(onedig_t *r, const onedig_t *y, unsigned yl, onedig_t *q, unsigned ql)
 }
 
 // Newly allocate uninitialized space for specified number of digits.
+// Small enough values live in the inline digits of this.
 inline void BigInt::allocate(unsigned digits)
 {
-  size = adjust_size(digits);
   length = 0;
-  digit = new onedig_t[size];
+  if(digits <= inline_digits)
+  {
+    size = inline_digits;
+    digit = inline_digit;
+  }
+  else
+  {
+    size = adjust_size(digits);
+    digit = new onedig_t[size];
+  }
 }
 
 // Used in assignment: When smaller than specified digits, allocate
@@ -282,7 +291,7 @@ inline void BigInt::reallocate(unsigned digits)
 {
   if(digits > size)
   {
-    if(size)
+    if(on_heap())
       delete[] digit;
     size = adjust_size(digits);
     digit = new onedig_t[size];
@@ -295,14 +304,14 @@ inline void BigInt::resize(unsigned digits)
   if(digits > size)
   {
     onedig_t *old_digit = digit;
-    unsigned old_size = size;
+    bool old_on_heap = on_heap();
     size = adjust_size(digits);
     digit = new onedig_t[size];
 
     if(old_digit != nullptr)
     {
       memcpy(digit, old_digit, length * sizeof(onedig_t));
-      if(old_size)
+      if(old_on_heap)
         delete[] old_digit;
     }
   }
@@ -365,7 +374,7 @@ void BigInt::assign(llong_t l)
 
 BigInt::~BigInt()
 {
-  if(size > 0)
+  if(on_heap())
   {
     memset(digit, 0, size * sizeof digit[0]); // Crypto-paranoia.
     delete[] digit;
@@ -378,80 +387,78 @@ BigInt::BigInt(onedig_t *dig, unsigned len, bool pos)
 }
 
 BigInt::BigInt()
-  : size(adjust_size(small)),
-    length(0),
-    digit(new onedig_t[size]),
-    positive(true)
+  : size(inline_digits), length(0), digit(inline_digit), positive(true)
 {
 }
 
 BigInt::BigInt(signed long int n)
-  : size(adjust_size(small)), length(0), digit(new onedig_t[size])
+  : size(inline_digits), length(0), digit(inline_digit)
 {
   assign(llong_t(n));
 }
 
 BigInt::BigInt(unsigned long int n)
-  : size(adjust_size(small)), length(0), digit(new onedig_t[size])
+  : size(inline_digits), length(0), digit(inline_digit)
 {
   assign(ullong_t(n));
 }
 
 BigInt::BigInt(int n)
-  : size(adjust_size(small)), length(0), digit(new onedig_t[size])
+  : size(inline_digits), length(0), digit(inline_digit)
 {
   assign(llong_t(n));
 }
 
 BigInt::BigInt(unsigned u)
-  : size(adjust_size(small)), length(0), digit(new onedig_t[size])
+  : size(inline_digits), length(0), digit(inline_digit)
 {
   assign(ullong_t(u));
 }
 
 BigInt::BigInt(llong_t l)
-  : size(adjust_size(small)), length(0), digit(new onedig_t[size])
+  : size(inline_digits), length(0), digit(inline_digit)
 {
   assign(l);
 }
 
 BigInt::BigInt(ullong_t ul)
-  : size(adjust_size(small)), length(0), digit(new onedig_t[size])
+  : size(inline_digits), length(0), digit(inline_digit)
 {
   assign(ul);
 }
 
-BigInt::BigInt(BigInt const &y)
-  : size(adjust_size(y.length)),
-    length(y.length),
-    digit(new onedig_t[size]),
-    positive(y.positive)
+BigInt::BigInt(BigInt const &y) : positive(y.positive)
 {
+  allocate(y.length);
+  length = y.length;
   memcpy(digit, y.digit, length * sizeof(onedig_t));
 }
 
-BigInt::BigInt(BigInt &&y) : BigInt()
+BigInt::BigInt(BigInt &&y) noexcept : BigInt()
 {
   swap(y);
 }
 
 BigInt::BigInt(char const *s, onedig_t b)
-  : size(adjust_size(small)),
-    length(0),
-    digit(new onedig_t[size]),
-    positive(true)
+  : size(inline_digits), length(0), digit(inline_digit), positive(true)
 {
   scan(s, b);
 }
 
 BigInt &BigInt::operator=(BigInt const &y)
 {
-  BigInt copy(y);
-  swap(copy);
+  if(this != &y)
+  {
+    // Reuse the digit vector of this whenever it is large enough.
+    reallocate(y.length);
+    length = y.length;
+    positive = y.positive;
+    memcpy(digit, y.digit, length * sizeof(onedig_t));
+  }
   return *this;
 }
 
-BigInt &BigInt::operator=(BigInt &&y)
+BigInt &BigInt::operator=(BigInt &&y) noexcept
 {
   swap(y);
   return *this;
@@ -812,10 +819,24 @@ void BigInt::mul(onedig_t const *dig, unsigned len, bool pos)
         digit[length++] = c;
     }
   }
+  else if(length + len <= size)
+  {
+    // The result fits into this, compute it aside and copy it in.
+    onedig_t *r = (onedig_t *)alloca((length + len) * sizeof(onedig_t));
+
+    if(length < len)
+      digit_mul(digit, length, dig, len, r);
+    else
+      digit_mul(dig, len, digit, length, r);
+
+    length += len;
+    memcpy(digit, r, length * sizeof(onedig_t));
+    adjust();
+  }
   else
   {
     // Get a new string of digits for the result.
-    unsigned old_size = size;
+    bool old_on_heap = on_heap();
     size = adjust_size(length + len);
     onedig_t *r = new onedig_t[size];
 
@@ -827,7 +848,7 @@ void BigInt::mul(onedig_t const *dig, unsigned len, bool pos)
       digit_mul(dig, len, digit, length, r);
 
     // Replace digit string of this with result.
-    if(old_size)
+    if(old_on_heap)
       delete[] digit;
     digit = r;
     length += len;
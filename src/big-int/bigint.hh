@@ -94,18 +94,29 @@ public:
   typedef unsigned long ullong_t;
 #endif
 
-  // Maximum number of onedig_t digits which could also be represented
-  // by an elementary type.
   enum
   {
-    small = sizeof(ullong_t) / sizeof(onedig_t)
+    // Maximum number of onedig_t digits which could also be represented
+    // by an elementary type.
+    small = sizeof(ullong_t) / sizeof(onedig_t),
+    // Number of onedig_t digits stored within the object itself. Values up
+    // to 128 bits never touch the heap, the digit vector only spills beyond.
+    inline_digits = 16 / sizeof(onedig_t)
   };
+  static_assert(inline_digits > small, "inline digits must hold an ullong_t");
 
 private:
   unsigned size;   // Length of digit vector.
   unsigned length; // Used places in digit vector.
   onedig_t *digit; // Least significant first.
   bool positive;   // Signed magnitude representation.
+  onedig_t inline_digit[inline_digits];
+
+  // Whether the digit vector was allocated by this and must be deleted.
+  bool on_heap() const
+  {
+    return size > 0 && digit != inline_digit;
+  }
 
   // Create or resize this.
   inline void allocate(unsigned digits);
@@ -141,11 +152,11 @@ public:
   BigInt(llong_t);
   BigInt(ullong_t);
   BigInt(BigInt const &);
-  BigInt(BigInt &&);
+  BigInt(BigInt &&) noexcept;
   BigInt(char const *, onedig_t = 10);
 
   BigInt &operator=(BigInt const &);
-  BigInt &operator=(BigInt &&);
+  BigInt &operator=(BigInt &&) noexcept;
 
   // Input conversion from text.
 
@@ -312,10 +323,18 @@ public:
 
   void swap(BigInt &other)
   {
+    bool this_inline = digit == inline_digit;
+    bool other_inline = other.digit == other.inline_digit;
     std::swap(other.size, size);
     std::swap(other.length, length);
     std::swap(other.digit, digit);
     std::swap(other.positive, positive);
+    std::swap(other.inline_digit, inline_digit);
+    // Inline digits moved along with the buffers, repoint to them
+    if(this_inline)
+      other.digit = other.inline_digit;
+    if(other_inline)
+      digit = inline_digit;
   }
 };
 
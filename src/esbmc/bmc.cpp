@@ -6,6 +6,8 @@
 #include <chrono>
 
 #ifndef _WIN32
+#include <fcntl.h>
+#include <sys/wait.h>
 #include <unistd.h>
 #include <sched.h>
 #else
@@ -25,6 +27,7 @@
 #include <goto-symex/goto_trace.h>
 #include <goto-symex/reachability_tree.h>
 #include <goto-symex/slice.h>
+#include <goto-symex/ssa_preprocess.h>
 #include <goto-symex/xml_goto_trace.h>
 #include <langapi/language_util.h>
 #include <langapi/languages.h>
@@ -54,6 +57,12 @@ bmct::bmct(goto_functionst &funcs, optionst &opts, contextt &_context)
     else
       algorithms.emplace_back(std::make_unique<symex_slicet>(options));
 
+    // Rewrite the sliced equation as a whole before it is converted
+    if(
+      options.get_bool_option("ssa-preprocess") &&
+      !options.get_bool_option("smt-during-symex"))
+      algorithms.emplace_back(std::make_unique<ssa_preprocesst>(options));
+
     // Run cache if user has specified the option
     if(options.get_bool_option("cache-asserts"))
       // Store the set between runs
@@ -158,12 +167,122 @@ void bmct::generate_smt_from_equation(
   log_status("Encoding remaining VCC(s) using {}", logic);
 
   fine_timet encode_start = current_time();
-  eq->convert(*smt_conv.get());
+  if(
+    options.get_bool_option("incremental-interleavings") &&
+    smt_conv == runtime_solver)
+    convert_incrementally(*eq);
+  else
+    eq->convert(*smt_conv.get());
   fine_timet encode_stop = current_time();
   log_status(
     "Encoding to solver time: {}s", time2string(encode_stop - encode_start));
 }
 
+/// Whether steps \p a and \p b of two interleavings constrain the solver in
+/// the same way
+static bool same_constraint(
+  const symex_target_equationt::SSA_stept &a,
+  const symex_target_equationt::SSA_stept &b)
+{
+  if(a.type != b.type || a.ignore != b.ignore)
+    return false;
+
+  return a.ignore || (a.guard == b.guard && a.cond == b.cond &&
+                      a.lhs == b.lhs && a.rhs == b.rhs &&
+                      a.output_args == b.output_args);
+}
+
+void bmct::convert_incrementally(symex_target_equationt &eq)
+{
+  smt_convt &smt_conv = *runtime_solver;
+  if(claims_ctx_open)
+  {
+    smt_conv.pop_ctx();
+    claims_ctx_open = false;
+  }
+
+  // Assertions constrain nothing until the claims are asserted, and the
+  // reachability tree drops them from the prefix when it backtracks, so
+  // only the other steps are compared
+  size_t common = 0;
+  for(const auto &step : eq.SSA_steps)
+  {
+    if(step.is_assert())
+      continue;
+    if(
+      common == converted_steps.size() ||
+      !same_constraint(step, converted_steps[common]))
+      break;
+    common++;
+  }
+
+  // Backtrack to the last context that lies entirely in the common prefix
+  while(converted_steps.size() > common)
+  {
+    size_t start = converted_ctxs.back();
+    converted_ctxs.pop_back();
+    smt_conv.pop_ctx();
+    converted_steps.resize(start);
+    converted_assumpts.resize(start);
+    common = std::min(common, start);
+  }
+
+  log_status(
+    "Reusing {} step(s) converted for a previous interleaving", common);
+
+  // Convert the rest of the steps in a context of their own
+  smt_convt::ast_vec assertions;
+  smt_astt assumpt_ast = converted_assumpts.empty()
+                           ? smt_conv.convert_ast(gen_true_expr())
+                           : converted_assumpts.back();
+  size_t i = 0;
+  for(auto &step : eq.SSA_steps)
+  {
+    if(step.is_assert())
+      continue;
+
+    if(i < common)
+    {
+      const symex_target_equationt::SSA_stept &conv = converted_steps[i];
+      step.guard_ast = conv.guard_ast;
+      step.cond_ast = conv.cond_ast;
+      step.converted_output_args = conv.converted_output_args;
+    }
+    else
+    {
+      if(i == common)
+      {
+        smt_conv.push_ctx();
+        converted_ctxs.push_back(common);
+      }
+
+      eq.convert_internal_step(smt_conv, assumpt_ast, assertions, step);
+      converted_steps.push_back(step);
+      converted_assumpts.push_back(assumpt_ast);
+    }
+    i++;
+  }
+
+  // The claims of this interleaving are implied by the assumptions before
+  // them, which are recorded with the steps
+  smt_conv.push_ctx();
+  claims_ctx_open = true;
+
+  assumpt_ast = smt_conv.convert_ast(gen_true_expr());
+  i = 0;
+  for(auto &step : eq.SSA_steps)
+  {
+    if(step.is_assert())
+      eq.convert_internal_step(smt_conv, assumpt_ast, assertions, step);
+    else
+      assumpt_ast = converted_assumpts[i++];
+  }
+
+  if(!assertions.empty())
+    smt_conv.assert_ast(
+      smt_conv.make_n_ary(&smt_conv, &smt_convt::mk_or, assertions));
+}
+
 smt_convt::resultt bmct::run_decision_procedure(
   std::shared_ptr<smt_convt> &smt_conv,
   std::shared_ptr<symex_target_equationt> &eq)
@@ -182,7 +301,7 @@ smt_convt::resultt bmct::run_decision_procedure(
   log_progress("Solving with solver {}", smt_conv->solver_text());
 
   fine_timet sat_start = current_time();
-  smt_convt::resultt dec_result = smt_conv->dec_solve();
+  smt_convt::resultt dec_result = smt_conv->refined_dec_solve();
   fine_timet sat_stop = current_time();
 
   // output runtime
@@ -386,7 +505,10 @@ smt_convt::resultt bmct::start_bmc()
 {
   std::shared_ptr<symex_target_equationt> eq;
   smt_convt::resultt res = run(eq);
-  report_trace(res, eq);
+  // Counterexamples found by interleaving workers, or under --all-runs, are
+  // already reported
+  if(eq || res != smt_convt::P_SATISFIABLE)
+    report_trace(res, eq);
   report_result(res);
   return res;
 }
@@ -399,6 +521,16 @@ smt_convt::resultt bmct::run(std::shared_ptr<symex_target_equationt> &eq)
   if(options.get_bool_option("schedule"))
     return run_thread(eq);
 
+  int workers = atoi(options.get_option("interleaving-workers").c_str());
+  if(workers > 1)
+    return run_interleaving_workers(workers);
+
+  return explore_interleavings(eq);
+}
+
+smt_convt::resultt
+bmct::explore_interleavings(std::shared_ptr<symex_target_equationt> &eq)
+{
   smt_convt::resultt res;
   do
   {
@@ -420,8 +552,17 @@ smt_convt::resultt bmct::run(std::shared_ptr<symex_target_equationt> &eq)
     if(res)
     {
       if(res == smt_convt::P_SATISFIABLE)
+      {
         ++interleaving_failed;
 
+        // The next interleaving replaces this equation and its model
+        if(options.get_bool_option("all-runs"))
+        {
+          report_trace(res, eq);
+          fflush(nullptr);
+        }
+      }
+
       if(!options.get_bool_option("all-runs"))
         return res;
     }
@@ -429,13 +570,150 @@ smt_convt::resultt bmct::run(std::shared_ptr<symex_target_equationt> &eq)
 
     log_status("BMC program time: {}s", time2string(bmc_stop - bmc_start));
 
+    // Drop the terms that were only referenced by the last interleaving
+    if(irep2_hash_cons::enabled)
+      irep2_hash_cons::collect();
+
     // Only run for one run
     if(options.get_bool_option("interactive-ileaves"))
       return res;
 
   } while(symex->setup_next_formula());
 
-  return interleaving_failed > 0 ? smt_convt::P_SATISFIABLE : res;
+  if(interleaving_failed > 0)
+  {
+    eq.reset();
+    return smt_convt::P_SATISFIABLE;
+  }
+
+  return res;
+}
+
+smt_convt::resultt bmct::run_interleaving_workers(unsigned int workers)
+{
+#ifdef _WIN32
+  log_error("Windows does not support interleaving workers");
+  abort();
+#else
+  struct worker_resultt
+  {
+    smt_convt::resultt res;
+    uint64_t interleavings;
+    uint64_t failed;
+  };
+
+  // Results flow back through one pipe. Whoever takes the byte in the token
+  // pipe gets to print its counterexample, the others are cut short.
+  int result_pipe[2], token_pipe[2];
+  if(pipe(result_pipe) || pipe(token_pipe))
+  {
+    log_error("Pipe creation failed");
+    abort();
+  }
+
+  fcntl(token_pipe[0], F_SETFL, fcntl(token_pipe[0], F_GETFL) | O_NONBLOCK);
+  char token = 0;
+  if(write(token_pipe[1], &token, 1) != 1)
+  {
+    log_error("Pipe write failed");
+    abort();
+  }
+
+  log_status("Exploring interleavings with {} workers", workers);
+
+  std::vector<pid_t> children;
+  for(unsigned int w = 0; w < workers; w++)
+  {
+    pid_t pid = fork();
+    if(pid == -1)
+    {
+      log_error("Fork failed");
+      for(pid_t child : children)
+        kill(child, SIGKILL);
+      abort();
+    }
+
+    if(pid != 0)
+    {
+      children.push_back(pid);
+      continue;
+    }
+
+    // Worker process, counting its own interleavings only
+    close(result_pipe[0]);
+    symex->set_worker(w, workers);
+    interleaving_number = 0;
+    interleaving_failed = 0;
+
+    std::shared_ptr<symex_target_equationt> eq;
+    worker_resultt r;
+    r.res = explore_interleavings(eq);
+
+    bool report = true;
+    if(
+      r.res == smt_convt::P_SATISFIABLE &&
+      !options.get_bool_option("all-runs"))
+    {
+      report = read(token_pipe[0], &token, 1) == 1;
+      if(report)
+        report_trace(r.res, eq);
+    }
+
+    // The parent kills every worker once it reads a violation, so the
+    // counterexample must be out before that
+    fflush(nullptr);
+
+    if(report)
+    {
+      r.interleavings = interleaving_number.to_uint64();
+      r.failed = interleaving_failed.to_uint64();
+      if(write(result_pipe[1], &r, sizeof(r)) != sizeof(r))
+        log_error("Short write communicating with the parent");
+    }
+
+    _exit(0);
+  }
+
+  close(result_pipe[1]);
+  close(token_pipe[0]);
+  close(token_pipe[1]);
+
+  // Gather results until every worker is done, or one found a violation
+  smt_convt::resultt res = smt_convt::P_UNSATISFIABLE;
+  unsigned int results = 0;
+  worker_resultt r;
+  while(read(result_pipe[0], &r, sizeof(r)) == sizeof(r))
+  {
+    results++;
+    interleaving_number += r.interleavings;
+    interleaving_failed += r.failed;
+
+    if(r.res == smt_convt::P_SATISFIABLE)
+    {
+      res = r.res;
+      if(!options.get_bool_option("all-runs"))
+        break;
+    }
+    else if(res == smt_convt::P_UNSATISFIABLE)
+      res = r.res;
+  }
+
+  // A worker only goes quiet if another found a violation first
+  if(res != smt_convt::P_SATISFIABLE && results != workers)
+  {
+    log_error("An interleaving worker terminated unexpectedly");
+    res = smt_convt::P_ERROR;
+  }
+
+  for(pid_t child : children)
+  {
+    kill(child, SIGKILL);
+    waitpid(child, nullptr, 0);
+  }
+
+  close(result_pipe[0]);
+  return res;
+#endif
 }
 
 void bmct::bidirectional_search(
@@ -604,6 +882,10 @@ smt_convt::resultt bmct::run_thread(std::shared_ptr<symex_target_equationt> &eq)
 
   fine_timet symex_stop = current_time();
 
+  // The remaining traces are all checked by other interleaving workers
+  if(!result)
+    return smt_convt::P_UNSATISFIABLE;
+
   eq = std::dynamic_pointer_cast<symex_target_equationt>(result->target);
 
   log_status(
@@ -664,7 +946,10 @@ smt_convt::resultt bmct::run_thread(std::shared_ptr<symex_target_equationt> &eq)
       return smt_convt::P_UNSATISFIABLE;
     }
 
-    if(!options.get_bool_option("smt-during-symex"))
+    if(
+      !options.get_bool_option("smt-during-symex") &&
+      (!options.get_bool_option("incremental-interleavings") ||
+       !runtime_solver))
     {
       runtime_solver =
         std::shared_ptr<smt_convt>(create_solver("", ns, options));
@@ -764,8 +1049,9 @@ smt_convt::resultt bmct::multi_property_check(
       /* TODO: We might move this into solver_convt. It is
        * useful to have the solver as a thread.
        */
-      std::thread solver_job(
-        [&result, &runtime_solver]() { result = runtime_solver->dec_solve(); });
+      std::thread solver_job([&result, &runtime_solver]() {
+        result = runtime_solver->refined_dec_solve();
+      });
 
       const bool fail_fast = options.get_bool_option("multi-fail-fast");
       // This loop is mainly for fail-fast.
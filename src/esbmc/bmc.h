@@ -66,6 +66,11 @@ protected:
     std::shared_ptr<symex_target_equationt> &eq);
 
   smt_convt::resultt run_thread(std::shared_ptr<symex_target_equationt> &eq);
+  smt_convt::resultt
+  explore_interleavings(std::shared_ptr<symex_target_equationt> &eq);
+  /** Splits the interleavings among \p workers processes, see
+   *  reachability_treet::set_worker. */
+  smt_convt::resultt run_interleaving_workers(unsigned int workers);
   smt_convt::resultt multi_property_check(
     std::shared_ptr<symex_target_equationt> &eq,
     size_t remaining_claims);
@@ -74,6 +79,21 @@ protected:
   void generate_smt_from_equation(
     std::shared_ptr<smt_convt> &smt_conv,
     std::shared_ptr<symex_target_equationt> &eq);
+
+  /** Converts \p eq into #runtime_solver, keeping whatever the previous
+   *  interleaving converted up to the first step where the two differ. The
+   *  claims are asserted in a context of their own, left open until the next
+   *  call so the model can still be read. See --incremental-interleavings. */
+  void convert_incrementally(symex_target_equationt &eq);
+
+  /// Non-assertion steps converted into #runtime_solver so far, in order
+  std::vector<symex_target_equationt::SSA_stept> converted_steps;
+  /// Assumption chain after each step of #converted_steps
+  std::vector<smt_astt> converted_assumpts;
+  /// Index in #converted_steps where each open solver context starts
+  std::vector<size_t> converted_ctxs;
+  /// Whether the context holding the last claims is still open
+  bool claims_ctx_open = false;
 };
 
 #endif
@@ -32,6 +32,7 @@ extern "C"
 #include <goto-programs/goto_k_induction.h>
 #include <goto-programs/abstract-interpretation/interval_analysis.h>
 #include <goto-programs/loop_numbers.h>
+#include <goto-programs/lockset_analysis.h>
 #include <goto-programs/read_goto_binary.h>
 #include <goto-programs/write_goto_binary.h>
 #include <goto-programs/remove_no_op.h>
@@ -40,6 +41,8 @@ extern "C"
 #include <goto-programs/show_claims.h>
 #include <goto-programs/loop_unroll.h>
 #include <goto-programs/mark_decl_as_non_det.h>
+#include <goto-programs/goto_sequentialize.h>
+#include <goto-programs/goto_devirtualize.h>
 #include <goto2c/goto2c.h>
 #include <util/irep.h>
 #include <langapi/languages.h>
@@ -48,6 +51,7 @@ extern "C"
 #include <pointer-analysis/goto_program_dereference.h>
 #include <pointer-analysis/show_value_sets.h>
 #include <pointer-analysis/value_set_analysis.h>
+#include <util/simplify_cache.h>
 #include <util/symbol.h>
 #include <util/time_stopping.h>
 
@@ -284,6 +288,12 @@ void esbmc_parseoptionst::get_command_line_options(optionst &options)
   if(cmdline.isset("compact-trace"))
     options.set_option("no-slice", true);
 
+  if(cmdline.isset("hash-consing"))
+    irep2_hash_cons::enable();
+
+  if(cmdline.isset("simplify-cache"))
+    simplify_cachet::enabled = true;
+
   if(cmdline.isset("smt-during-symex"))
   {
     log_status("Enabling --no-slice due to presence of --smt-during-symex");
@@ -301,6 +311,46 @@ void esbmc_parseoptionst::get_command_line_options(optionst &options)
     }
   }
 
+  if(
+    cmdline.isset("interleaving-workers") &&
+    (cmdline.isset("state-hashing") || cmdline.isset("interactive-ileaves")))
+  {
+    log_error(
+      "--interleaving-workers can't be used with --state-hashing or "
+      "--interactive-ileaves");
+    abort();
+  }
+
+  if(
+    cmdline.isset("dpor") &&
+    (cmdline.isset("state-hashing") || cmdline.isset("interleaving-workers") ||
+     cmdline.isset("context-bound")))
+  {
+    log_error(
+      "--dpor can't be used with --state-hashing, --interleaving-workers or "
+      "--context-bound");
+    abort();
+  }
+
+  if(
+    cmdline.isset("lazy-sequentialization") &&
+    (cmdline.isset("deadlock-check") || cmdline.isset("data-races-check")))
+  {
+    log_error(
+      "--lazy-sequentialization can't be used with --deadlock-check or "
+      "--data-races-check");
+    abort();
+  }
+
+  if(
+    cmdline.isset("incremental-interleavings") &&
+    cmdline.isset("smt-during-symex"))
+  {
+    log_error(
+      "--incremental-interleavings can't be used with --smt-during-symex");
+    abort();
+  }
+
   // check the user's parameters to run incremental verification
   if(!cmdline.isset("unlimited-k-steps"))
   {
@@ -474,6 +524,13 @@ int esbmc_parseoptionst::doit()
 
   // Initialize goto_functions algorithms
   {
+    // Replacing calls through function pointers by direct calls to the
+    // functions they may point to
+    if(cmdline.isset("devirtualize"))
+      goto_preprocess_algorithms.emplace_back(
+        std::make_unique<goto_devirtualizet>(
+          context, !cmdline.isset("no-pointer-check")));
+
     // Loop unrolling
     if(cmdline.isset("goto-unwind") && !cmdline.isset("unwind"))
     {
@@ -486,6 +543,21 @@ int esbmc_parseoptionst::doit()
     if(cmdline.isset("initialize-nondet-variables"))
       goto_preprocess_algorithms.emplace_back(
         std::make_unique<mark_decl_as_non_det>(context));
+
+    // Replacing threads by a bounded round-robin scheduler, with as many
+    // rounds as the context bound, and as many threads per create call in a
+    // loop as the loop's unwinding bound
+    if(cmdline.isset("lazy-sequentialization"))
+    {
+      int rounds = cmdline.isset("context-bound")
+                     ? atoi(cmdline.getval("context-bound"))
+                     : -1;
+      int loop_threads =
+        cmdline.isset("unwind") ? atoi(cmdline.getval("unwind")) : 0;
+      goto_preprocess_algorithms.emplace_back(
+        std::make_unique<goto_sequentializet>(
+          context, rounds > 0 ? rounds : 2, std::max(loop_threads, 0)));
+    }
   }
 
   // Run this before the main flow. This method performs its own
@@ -1385,6 +1457,12 @@ int esbmc_parseoptionst::do_bmc(bmct &bmc)
   if(res == smt_convt::P_ERROR)
     abort();
 
+  if(irep2_hash_cons::enabled)
+    irep2_hash_cons::print_stats();
+
+  if(simplify_cachet::enabled)
+    simplify_cachet::get().print_stats();
+
 #ifdef HAVE_SENDFILE_ESBMC
   if(bmc.options.get_bool_option("memstats"))
   {
@@ -1717,7 +1795,18 @@ bool esbmc_parseoptionst::process_goto_program(
       value_set_analysist value_set_analysis(ns);
       value_set_analysis(goto_functions);
 
-      add_race_assertions(value_set_analysis, context, goto_functions);
+      if(cmdline.isset("lockset-analysis"))
+      {
+        lockset_analysist lockset(ns);
+        lockset(goto_functions);
+        log_status(
+          "Skipping data race checks on {} race-free global(s)",
+          lockset.get_race_free().size());
+        add_race_assertions(
+          value_set_analysis, context, goto_functions, &lockset);
+      }
+      else
+        add_race_assertions(value_set_analysis, context, goto_functions);
 
       value_set_analysis.update(goto_functions);
     }
@@ -200,6 +200,18 @@ const struct group_opt_templ all_cmd_options[] = {
      NULL,
      "do not unroll bounded loops at goto level"},
     {"slice-assumes", NULL, "remove unused assume statements"},
+    {"ssa-preprocess",
+     NULL,
+     "substitute, share and narrow values across the whole equation before "
+     "solving"},
+    {"dereference-cache",
+     NULL,
+     "reuse the case split of a dereference whose pointer and value set are "
+     "unchanged"},
+    {"devirtualize",
+     NULL,
+     "replace calls through function pointers by direct calls to the "
+     "functions they may point to"},
     {"extended-try-analysis", NULL, ""},
     {"skip-bmc", NULL, ""}}},
   {"Incremental BMC",
@@ -223,6 +235,7 @@ const struct group_opt_templ all_cmd_options[] = {
     {"cvc", NULL, "use CVC4"},
     {"yices", NULL, "use Yices"},
     {"bitwuzla", NULL, "use Bitwuzla"},
+    {"sat", NULL, "use the built-in bit-blasting SAT solver"},
     {"bv", NULL, "use solver with bit-vector arithmetic"},
     {"ir", NULL, "use solver with integer/real arithmetic"},
     {"parallel-solving",
@@ -255,11 +268,28 @@ const struct group_opt_templ all_cmd_options[] = {
      NULL,
      "encode floating-point as bit-vectors(default for solvers that don't "
      "support the SMT floating-point theory)"},
+    {"fp-refinement",
+     NULL,
+     "with bit-vector floating-point, add the circuits of +, -, * and / "
+     "only for operations a model gets wrong"},
     {"tuple-node-flattener", NULL, "encode tuples using our tuple to node API"},
     {"tuple-sym-flattener",
      NULL,
      "encode tuples using our tuple to symbol API"},
     {"array-flattener", NULL, "encode arrays using our array API"},
+    {"array-refinement",
+     NULL,
+     "with our array API, add read-over-write and index congruence "
+     "constraints lazily, when a model violates them"},
+    {"address-space-encoding",
+     boost::program_options::value<std::string>()->value_name(
+       "pairwise|ordered"),
+     "constrain object addresses by pairwise non-overlap (default), or by "
+     "laying objects out in allocation order with linearly many constraints"},
+    {"pointer-encoding",
+     boost::program_options::value<std::string>()->value_name("tuple|flat"),
+     "encode pointers as object/offset tuples (default), or as a single "
+     "bit-vector holding the object number above the offset"},
     {"no-return-value-opt",
      NULL,
      "disable return value optimization to compute the stack size"}}},
@@ -320,6 +350,10 @@ const struct group_opt_templ all_cmd_options[] = {
      NULL,
      "enable global and local deadlock check with mutex"},
     {"data-races-check", NULL, "enable data races check"},
+    {"lockset-analysis",
+     NULL,
+     "skip data race checks and context switches on globals that only one "
+     "thread accesses, or only while holding the same mutex"},
     {"lock-order-check", NULL, "enable for lock acquisition ordering check"},
     {"atomicity-check", NULL, "enable atomicity check at visible assignments"},
     {"stack-limit",
@@ -374,9 +408,27 @@ const struct group_opt_templ all_cmd_options[] = {
      "do not not merge gotos when restoring the last paths after a "
      "context-switch"},
     {"no-por", NULL, "do not do partial order reduction"},
+    {"dpor",
+     NULL,
+     "use dynamic partial order reduction instead of the static one"},
     {"all-runs",
      NULL,
-     "check all interleavings, even if a bug was already found"}}},
+     "check all interleavings, even if a bug was already found"},
+    {"interleaving-workers",
+     boost::program_options::value<int>()->value_name("nr"),
+     "split the interleavings among nr worker processes"},
+    {"lazy-sequentialization",
+     NULL,
+     "check a sequential program simulating --context-bound rounds of "
+     "round-robin scheduling (default: 2) instead of the interleavings"},
+    {"incremental-interleavings",
+     NULL,
+     "keep one solver for all interleavings, reusing the encoding of the "
+     "prefix each shares with the previous one"},
+    {"pthread-intrinsics",
+     NULL,
+     "lock and unlock pthread mutexes in symex rather than through their C "
+     "models"}}},
   {"Interval Analysis",
    {{"interval-analysis",
      NULL,
@@ -426,7 +478,10 @@ const struct group_opt_templ all_cmd_options[] = {
      "assumes that Integers will not overflow (Integers)"},
     {"interval-analysis-narrowing",
      NULL,
-     "enables use of narrowing in abstract states (Integers and Reals)"}}},
+     "enables use of narrowing in abstract states (Integers and Reals)"},
+    {"interval-analysis-offsets",
+     NULL,
+     "bound pointer offsets in symex by the intervals of local integers"}}},
   {"Miscellaneous options",
    {{"memlimit",
      boost::program_options::value<std::string>()->value_name("limit"),
@@ -437,6 +492,13 @@ const struct group_opt_templ all_cmd_options[] = {
      "configure time limit, integer followed by {s,m,h}"},
     {"enable-core-dump", NULL, "do not disable core dump output"},
     {"no-simplify", NULL, "do not simplify any expression"},
+    {"simplify-cache",
+     NULL,
+     "memoize the simplification of repeated subexpressions"},
+    {"hash-consing",
+     NULL,
+     "share structurally equal expressions and types through a hash-consing "
+     "table"},
     {"no-propagation", NULL, "disable constant propagation"},
     {"add-symex-value-sets",
      NULL,
@@ -82,7 +82,8 @@ void add_race_assertions(
   value_setst &value_sets,
   contextt &context,
   goto_programt &goto_program,
-  w_guardst &w_guards)
+  w_guardst &w_guards,
+  const lockset_analysist *lockset)
 {
   namespacet ns(context);
 
@@ -95,6 +96,13 @@ void add_race_assertions(
       exprt tmp_expr = migrate_expr_back(instruction.code);
       rw_sett rw_set(ns, value_sets, i_it, to_code(tmp_expr));
 
+      // No need to check what no two threads can access concurrently
+      if(lockset)
+        for(auto it = rw_set.entries.begin(); it != rw_set.entries.end();)
+          it = lockset->is_race_free(it->second.symbol)
+                 ? rw_set.entries.erase(it)
+                 : std::next(it);
+
       if(rw_set.entries.empty())
         continue;
 
@@ -167,7 +175,7 @@ void add_race_assertions(
 {
   w_guardst w_guards(context);
 
-  add_race_assertions(value_sets, context, goto_program, w_guards);
+  add_race_assertions(value_sets, context, goto_program, w_guards, nullptr);
 
   w_guards.add_initialization(goto_program);
   goto_program.update();
@@ -176,12 +184,14 @@ void add_race_assertions(
 void add_race_assertions(
   value_setst &value_sets,
   contextt &context,
-  goto_functionst &goto_functions)
+  goto_functionst &goto_functions,
+  const lockset_analysist *lockset)
 {
   w_guardst w_guards(context);
 
   Forall_goto_functions(f_it, goto_functions)
-    add_race_assertions(value_sets, context, f_it->second.body, w_guards);
+    add_race_assertions(
+      value_sets, context, f_it->second.body, w_guards, lockset);
 
   // get "main"
   goto_functionst::function_mapt::iterator m_it =
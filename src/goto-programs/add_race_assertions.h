@@ -3,6 +3,7 @@
 
 #include <goto-programs/goto_functions.h>
 #include <goto-programs/goto_program.h>
+#include <goto-programs/lockset_analysis.h>
 #include <pointer-analysis/value_sets.h>
 
 void add_race_assertions(
@@ -13,6 +14,7 @@ void add_race_assertions(
 void add_race_assertions(
   value_setst &value_sets,
   contextt &context,
-  goto_functionst &goto_functions);
+  goto_functionst &goto_functions,
+  const lockset_analysist *lockset = nullptr);
 
 #endif
@@ -0,0 +1,516 @@
+#include <goto-programs/goto_devirtualize.h>
+#include <irep2/irep2_utils.h>
+#include <util/base_type.h>
+#include <util/migrate.h>
+#include <util/prefix.h>
+#include <util/std_types.h>
+
+/// Prefix of the names of the slots in C++ virtual tables
+static const char vtable_prefix[] = "virtual_table::";
+
+static bool is_vtable_slot(const expr2tc &e)
+{
+  return is_member2t(e) &&
+         has_prefix(id2string(to_member2t(e).member), vtable_prefix);
+}
+
+static expr2tc root_object(expr2tc e)
+{
+  while(is_member2t(e) || is_index2t(e))
+    e = is_member2t(e) ? to_member2t(e).source_value
+                       : to_index2t(e).source_value;
+  return e;
+}
+
+static irep_idt return_cell(const irep_idt &function)
+{
+  return id2string(function) + "#return_value";
+}
+
+void goto_devirtualizet::sourcest::add(const sourcest &other)
+{
+  functions.insert(other.functions.begin(), other.functions.end());
+  cells.insert(other.cells.begin(), other.cells.end());
+  top = top || other.top;
+}
+
+bool goto_devirtualizet::run(goto_functionst &goto_functions)
+{
+  collect(goto_functions);
+  collect_flows(goto_functions);
+  solve();
+
+  unsigned calls = 0;
+  for(auto &f : goto_functions.function_map)
+  {
+    if(!f.second.body_available)
+      continue;
+
+    goto_programt &body = f.second.body;
+    for(auto it = body.instructions.begin(); it != body.instructions.end();)
+    {
+      auto next = std::next(it);
+      if(it->is_function_call())
+      {
+        const code_function_call2t &call = to_code_function_call2t(it->code);
+        if(
+          is_dereference2t(call.function) && is_code_type(call.function->type))
+        {
+          const expr2tc &ptr = to_dereference2t(call.function).value;
+          devirtualize(f.first, body, it, targets(ptr, call.function->type));
+          calls++;
+        }
+      }
+      it = next;
+    }
+  }
+
+  if(calls == 0)
+    return false;
+
+  log_status("Devirtualized {} function pointer call(s)", calls);
+  goto_functions.update();
+  return true;
+}
+
+void goto_devirtualizet::collect(const goto_functionst &goto_functions)
+{
+  for(const auto &f : goto_functions.function_map)
+  {
+    if(!f.second.body_available)
+      continue;
+
+    for(const auto &i : f.second.body.instructions)
+    {
+      collect_expr(i.guard);
+      if(!i.is_function_call())
+      {
+        collect_expr(i.code);
+        continue;
+      }
+
+      // The function called directly isn't a value
+      const code_function_call2t &call = to_code_function_call2t(i.code);
+      collect_expr(call.ret);
+      if(!is_symbol2t(call.function))
+        collect_expr(call.function);
+      for(const auto &arg : call.operands)
+        collect_expr(arg);
+    }
+  }
+}
+
+void goto_devirtualizet::collect_expr(const expr2tc &e)
+{
+  if(is_nil_expr(e))
+    return;
+
+  if(is_symbol2t(e) && is_code_type(e->type))
+    taken.insert(to_symbol2t(e).thename);
+
+  if(is_address_of2t(e))
+  {
+    expr2tc obj = root_object(to_address_of2t(e).ptr_obj);
+    if(is_symbol2t(obj))
+      address_taken.insert(to_symbol2t(obj).thename);
+  }
+
+  // Functions called through a pointer to another type. Tests like
+  // `if(fp)` cast to narrower types, which can't hold the pointer.
+  if(is_typecast2t(e))
+  {
+    const type2tc &from = to_typecast2t(e).from->type;
+    if(
+      is_pointer_type(from) && is_code_type(to_pointer_type(from).subtype) &&
+      !base_type_eq(from, e->type, ns) &&
+      (is_pointer_type(e->type) ||
+       (is_bv_type(e->type) && e->type->get_width() >= from->get_width())))
+      cast_types.push_back(to_pointer_type(from).subtype);
+  }
+
+  // Or through another member of a union
+  if(
+    is_member2t(e) && is_pointer_type(e->type) &&
+    is_code_type(to_pointer_type(e->type).subtype) &&
+    is_union_type(ns.follow(to_member2t(e).source_value->type)))
+    cast_types.push_back(to_pointer_type(e->type).subtype);
+
+  e->foreach_operand([this](const expr2tc &op) { collect_expr(op); });
+}
+
+void goto_devirtualizet::collect_flows(const goto_functionst &goto_functions)
+{
+  sourcest any;
+  any.top = true;
+
+  for(const auto &f : goto_functions.function_map)
+  {
+    if(!f.second.body_available)
+      continue;
+
+    // Functions called through pointers may get any argument
+    if(taken.count(f.first))
+      for(const auto &arg : f.second.type.arguments())
+        add_to(arg.get_identifier(), any);
+
+    for(const auto &i : f.second.body.instructions)
+    {
+      if(i.is_assign())
+      {
+        const code_assign2t &assign2 = to_code_assign2t(i.code);
+        assign(assign2.target, assign2.source);
+      }
+      else if(i.is_return())
+      {
+        const code_return2t &ret = to_code_return2t(i.code);
+        if(!is_nil_expr(ret.operand))
+          add_to(return_cell(f.first), values(ret.operand));
+      }
+      else if(i.is_function_call())
+      {
+        const code_function_call2t &call = to_code_function_call2t(i.code);
+        auto callee = is_symbol2t(call.function)
+                        ? goto_functions.function_map.find(
+                            to_symbol2t(call.function).thename)
+                        : goto_functions.function_map.end();
+        bool known = callee != goto_functions.function_map.end() &&
+                     callee->second.body_available;
+
+        if(known)
+        {
+          const auto &params = callee->second.type.arguments();
+          for(size_t n = 0; n < params.size() && n < call.operands.size(); n++)
+            add_to(params[n].get_identifier(), values(call.operands[n]));
+        }
+
+        irep_idt cell;
+        if(!is_nil_expr(call.ret) && is_cell(call.ret, cell))
+        {
+          sourcest src;
+          if(known)
+            src.cells.insert(return_cell(callee->first));
+          else
+            src.top = true;
+          add_to(cell, src);
+        }
+      }
+    }
+  }
+}
+
+void goto_devirtualizet::solve()
+{
+  bool changed = true;
+  while(changed)
+  {
+    changed = false;
+    for(auto &c : cells)
+    {
+      sourcest &dest = c.second;
+      for(const auto &id : std::set<irep_idt>(dest.cells))
+      {
+        // Nothing was seen flowing into the cell, it may hold anything
+        auto src = cells.find(id);
+        if(src == cells.end())
+        {
+          changed = changed || !dest.top;
+          dest.top = true;
+          continue;
+        }
+
+        if(&src->second == &dest)
+          continue;
+
+        size_t before = dest.functions.size() + dest.cells.size();
+        bool top = dest.top;
+        dest.add(src->second);
+        size_t after = dest.functions.size() + dest.cells.size();
+        changed = changed || dest.top != top || after != before;
+      }
+    }
+  }
+}
+
+bool goto_devirtualizet::is_cell(const expr2tc &e, irep_idt &cell) const
+{
+  if(is_vtable_slot(e))
+  {
+    cell = to_member2t(e).member;
+    return true;
+  }
+
+  // Members and elements of a variable share its cell
+  expr2tc obj = root_object(e);
+  if(
+    !is_symbol2t(obj) || is_code_type(obj->type) ||
+    address_taken.count(to_symbol2t(obj).thename))
+    return false;
+
+  cell = to_symbol2t(obj).thename;
+  return true;
+}
+
+goto_devirtualizet::sourcest
+goto_devirtualizet::values(const expr2tc &e) const
+{
+  sourcest res;
+  if(is_typecast2t(e))
+    return values(to_typecast2t(e).from);
+
+  if(is_if2t(e))
+  {
+    res = values(to_if2t(e).true_value);
+    res.add(values(to_if2t(e).false_value));
+    return res;
+  }
+
+  if(is_with2t(e))
+  {
+    res = values(to_with2t(e).source_value);
+    res.add(values(to_with2t(e).update_value));
+    return res;
+  }
+
+  if(is_address_of2t(e))
+  {
+    // The address of data is no function
+    const expr2tc &obj = to_address_of2t(e).ptr_obj;
+    if(is_symbol2t(obj) && is_code_type(obj->type))
+      res.functions.insert(to_symbol2t(obj).thename);
+    return res;
+  }
+
+  if(is_symbol2t(e) && is_code_type(e->type))
+  {
+    res.functions.insert(to_symbol2t(e).thename);
+    return res;
+  }
+
+  if(is_symbol2t(e) && to_symbol2t(e).thename == "NULL")
+    return res;
+
+  irep_idt cell;
+  if((is_symbol2t(e) || is_member2t(e) || is_index2t(e)) && is_cell(e, cell))
+  {
+    res.cells.insert(cell);
+    return res;
+  }
+
+  if(
+    is_constant_struct2t(e) || is_constant_union2t(e) ||
+    is_constant_array2t(e))
+  {
+    e->foreach_operand(
+      [this, &res](const expr2tc &op) { res.add(values(op)); });
+    return res;
+  }
+
+  if(is_constant_array_of2t(e))
+    return values(to_constant_array_of2t(e).initializer);
+
+  if(is_constant_expr(e))
+    return res;
+
+  // Read from memory, or made up
+  res.top = true;
+  return res;
+}
+
+void goto_devirtualizet::assign(const expr2tc &lhs, const expr2tc &rhs)
+{
+  // Virtual tables are only ever initialized
+  type2tc t = ns.follow(lhs->type);
+  if(is_vtable(t))
+  {
+    const struct_type2t &vt = to_struct_type(t);
+    for(size_t n = 0; n < vt.member_names.size(); n++)
+    {
+      sourcest src;
+      if(is_constant_struct2t(rhs))
+        src = values(to_constant_struct2t(rhs).datatype_members[n]);
+      else
+        src.top = true;
+      add_to(vt.member_names[n], src);
+    }
+    return;
+  }
+
+  // Function addresses may pass through data of any type, but stores
+  // through pointers reach no cell
+  irep_idt cell;
+  if(is_cell(lhs, cell))
+    add_to(cell, values(rhs));
+}
+
+void goto_devirtualizet::add_to(const irep_idt &cell, const sourcest &src)
+{
+  cells[cell].add(src);
+}
+
+/// Whether values of types \p a and \p b are passed the same way
+static bool
+compatible_value(const type2tc &a, const type2tc &b, const namespacet &ns)
+{
+  if(base_type_eq(a, b, ns))
+    return true;
+
+  if(is_pointer_type(a) && is_pointer_type(b))
+    return is_empty_type(to_pointer_type(a).subtype) ||
+           is_empty_type(to_pointer_type(b).subtype);
+
+  return is_bv_type(a) && is_bv_type(b) && a->get_width() == b->get_width();
+}
+
+bool goto_devirtualizet::compatible(const type2tc &a, const type2tc &b) const
+{
+  const code_type2t &ca = to_code_type(a);
+  const code_type2t &cb = to_code_type(b);
+
+  // Overriding methods may return pointers to derived classes
+  bool pointers = is_pointer_type(ca.ret_type) && is_pointer_type(cb.ret_type);
+  if(!pointers && !compatible_value(ca.ret_type, cb.ret_type, ns))
+    return false;
+
+  // Either one may be declared without a prototype
+  if(ca.arguments.empty() || cb.arguments.empty())
+    return true;
+
+  if(ca.arguments.size() != cb.arguments.size() && !ca.ellipsis && !cb.ellipsis)
+    return false;
+
+  for(size_t n = 0; n < ca.arguments.size() && n < cb.arguments.size(); n++)
+    if(!compatible_value(ca.arguments[n], cb.arguments[n], ns))
+      return false;
+
+  return true;
+}
+
+bool goto_devirtualizet::is_vtable(const type2tc &t) const
+{
+  if(!is_struct_type(t))
+    return false;
+
+  const struct_type2t &s = to_struct_type(t);
+  return !s.member_names.empty() &&
+         has_prefix(id2string(s.member_names.front()), vtable_prefix);
+}
+
+std::set<irep_idt>
+goto_devirtualizet::targets(const expr2tc &ptr, const type2tc &type) const
+{
+  sourcest src = values(ptr);
+  for(const auto &id : src.cells)
+  {
+    auto c = cells.find(id);
+    if(c == cells.end())
+    {
+      src.top = true;
+      continue;
+    }
+
+    const sourcest &cell = c->second;
+    src.functions.insert(cell.functions.begin(), cell.functions.end());
+    src.top = src.top || cell.top;
+  }
+
+  if(src.top)
+    src.functions.insert(taken.begin(), taken.end());
+
+  std::set<irep_idt> res;
+  for(const auto &f : src.functions)
+  {
+    const symbolt *s = ns.lookup(f);
+    if(s == nullptr || !s->type.is_code())
+      continue;
+
+    type2tc t = migrate_type(s->type);
+    bool cast = std::any_of(
+      cast_types.begin(), cast_types.end(), [this, &t](const type2tc &c) {
+        return compatible(c, t);
+      });
+    if(cast || compatible(t, type))
+      res.insert(f);
+  }
+
+  return res;
+}
+
+void goto_devirtualizet::devirtualize(
+  const irep_idt &function,
+  goto_programt &body,
+  goto_programt::targett it,
+  const std::set<irep_idt> &targets)
+{
+  const code_function_call2t &call = to_code_function_call2t(it->code);
+  expr2tc ptr = to_dereference2t(call.function).value;
+  goto_programt p;
+  goto_programt::targett t;
+
+  // Read the pointer once, even a variable: another thread may change it
+  // between two comparisons
+  symbolt s;
+  s.id = id2string(function) + "::$fptr$" + std::to_string(fresh++);
+  s.name = s.id;
+  s.type = migrate_type_back(ptr->type);
+  s.lvalue = true;
+  s.location = it->location;
+  context.add(s);
+  const irep_idt tmp = s.id;
+
+  t = p.add_instruction(DECL);
+  t->code = code_decl2tc(ptr->type, tmp);
+  t = p.add_instruction(ASSIGN);
+  t->code = code_assign2tc(symbol2tc(ptr->type, tmp), ptr);
+  ptr = symbol2tc(ptr->type, tmp);
+
+  std::vector<std::pair<goto_programt::targett, expr2tc>> cases;
+  for(const auto &f : targets)
+  {
+    type2tc type = migrate_type(ns.lookup(f)->type);
+    expr2tc sym = symbol2tc(type, f);
+    t = p.add_instruction(GOTO);
+    t->guard =
+      equality2tc(ptr, typecast2tc(ptr->type, address_of2tc(type, sym)));
+    cases.emplace_back(t, sym);
+  }
+
+  goto_programt::targett assertion;
+  if(pointer_check)
+  {
+    assertion = p.add_instruction(ASSERT);
+    assertion->guard = gen_false_expr();
+  }
+
+  std::vector<goto_programt::targett> exits;
+  exits.push_back(p.add_instruction(GOTO));
+
+  for(auto &c : cases)
+  {
+    t = p.add_instruction(FUNCTION_CALL);
+    c.first->set_target(t);
+    expr2tc direct = it->code;
+    to_code_function_call2t(direct).function = c.second;
+    t->code = direct;
+    if(&c != &cases.back())
+      exits.push_back(p.add_instruction(GOTO));
+  }
+
+  t = p.add_instruction(DEAD);
+  t->code = code_dead2tc(ptr->type, tmp);
+  for(auto &e : exits)
+    e->make_goto(t, gen_true_expr());
+
+  for(auto &i : p.instructions)
+  {
+    i.location = it->location;
+    i.function = it->function;
+  }
+  if(pointer_check)
+    assertion->location.comment(
+      "dereference failure: invalid function pointer");
+
+  // Nothing jumps to the first instruction, which takes the place of the call
+  size_t n = p.instructions.size();
+  body.insert_swap(it, p);
+  body.instructions.erase(std::next(it, n));
+}
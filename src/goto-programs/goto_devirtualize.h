@@ -0,0 +1,92 @@
+#ifndef ESBMC_GOTO_DEVIRTUALIZE_H
+#define ESBMC_GOTO_DEVIRTUALIZE_H
+
+#include <util/algorithms.h>
+#include <util/context.h>
+#include <util/namespace.h>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
+/**
+ * @brief Replaces each call through a function pointer by a dispatch on the
+ * pointer's value to direct calls of the functions it may point to.
+ *
+ * The targets come from a flow-insensitive points-to analysis over the whole
+ * program. It tracks the function addresses stored into the variables whose
+ * own address is never taken, whatever their type, through assignments,
+ * arguments and return values, and into the slots of the C++ virtual tables.
+ * A pointer read from anywhere else, or from a variable nothing is seen
+ * stored into, may point to any function whose address is taken. Either
+ * way, only functions whose type is compatible with the call are kept,
+ * unless their address is cast to another type somewhere.
+ *
+ * A pointer matching none of the targets is invalid: the dispatch asserts
+ * that, unless pointer checks are disabled, and calls nothing.
+ */
+class goto_devirtualizet : public goto_functions_algorithm
+{
+public:
+  goto_devirtualizet(contextt &context, bool pointer_check)
+    : goto_functions_algorithm(true),
+      context(context),
+      ns(context),
+      pointer_check(pointer_check)
+  {
+  }
+
+  bool run(goto_functionst &goto_functions) override;
+
+protected:
+  typedef std::unordered_set<irep_idt, irep_id_hash> id_sett;
+
+  contextt &context;
+  const namespacet ns;
+  const bool pointer_check;
+
+  /// What a value may point to: functions, and the contents of cells
+  struct sourcest
+  {
+    std::set<irep_idt> functions;
+    std::set<irep_idt> cells;
+    /// Whether it may point to any function whose address is taken
+    bool top = false;
+
+    void add(const sourcest &other);
+  };
+
+  /// Cells are tracked variables, return values and virtual table slots
+  std::unordered_map<irep_idt, sourcest, irep_id_hash> cells;
+
+  /// Functions whose address is taken
+  id_sett taken;
+  /// Symbols whose address is taken, which are never cells
+  id_sett address_taken;
+  /// Types of the function pointers cast to another type
+  std::vector<type2tc> cast_types;
+
+  unsigned fresh = 0;
+
+  void collect(const goto_functionst &goto_functions);
+  void collect_expr(const expr2tc &e);
+  void collect_flows(const goto_functionst &goto_functions);
+  void solve();
+
+  bool is_cell(const expr2tc &e, irep_idt &cell) const;
+  sourcest values(const expr2tc &e) const;
+  void assign(const expr2tc &lhs, const expr2tc &rhs);
+  void add_to(const irep_idt &cell, const sourcest &src);
+
+  bool compatible(const type2tc &a, const type2tc &b) const;
+  bool is_vtable(const type2tc &t) const;
+
+  /// Functions a call through \p ptr, of type \p type, may reach
+  std::set<irep_idt> targets(const expr2tc &ptr, const type2tc &type) const;
+  void devirtualize(
+    const irep_idt &function,
+    goto_programt &body,
+    goto_programt::targett it,
+    const std::set<irep_idt> &targets);
+};
+
+#endif
@@ -0,0 +1,764 @@
+#include <goto-programs/goto_inline.h>
+#include <goto-programs/goto_sequentialize.h>
+#include <irep2/irep2_utils.h>
+#include <limits>
+#include <util/c_types.h>
+#include <util/migrate.h>
+#include <util/options.h>
+#include <util/prefix.h>
+#include <util/std_types.h>
+
+/// Thread instances beyond this are assumed to come from recursive creation
+static const unsigned max_threads = 64;
+
+static irep_idt called_function(const goto_programt::instructiont &i)
+{
+  if(!i.is_function_call())
+    return irep_idt();
+
+  const code_function_call2t &call = to_code_function_call2t(i.code);
+  if(!is_symbol2t(call.function))
+    return irep_idt();
+
+  return to_symbol2t(call.function).thename;
+}
+
+/// The function named by \p arg, the start routine argument of a
+/// pthread_create call, if it is a constant
+static irep_idt start_routine(const expr2tc &arg)
+{
+  expr2tc e = arg;
+  while(is_typecast2t(e))
+    e = to_typecast2t(e).from;
+
+  if(is_address_of2t(e))
+    e = to_address_of2t(e).ptr_obj;
+
+  if(!is_symbol2t(e) || !is_code_type(e->type))
+    return irep_idt();
+
+  return to_symbol2t(e).thename;
+}
+
+static bool is_join(const irep_idt &f)
+{
+  return has_prefix(id2string(f), "c:@F@pthread_join");
+}
+
+/// Calls a thread may only make from its start routine
+static bool is_thread_call(const irep_idt &f)
+{
+  return f == "c:@F@pthread_create" || f == "c:@F@pthread_exit" ||
+         is_join(f);
+}
+
+/// Calls that symex or this pass deal with, rather than the body
+static bool is_special_call(const irep_idt &f)
+{
+  return is_thread_call(f) || f == "c:@F@pthread_self" ||
+         has_prefix(id2string(f), "c:@F@__ESBMC");
+}
+
+static bool is_decl(const goto_programt::instructiont &i)
+{
+  // Inlined parameters are declared by OTHER instructions
+  return i.is_decl() || (i.is_other() && is_code_decl2t(i.code));
+}
+
+/// Which instructions of \p body are inside a loop, in order
+static std::vector<bool> in_loop(const goto_programt &body)
+{
+  std::unordered_map<const goto_programt::instructiont *, size_t> index;
+  for(const auto &i : body.instructions)
+    index.emplace(&i, index.size());
+
+  std::vector<bool> res(index.size(), false);
+  size_t n = 0;
+  for(const auto &i : body.instructions)
+  {
+    if(i.is_goto() && !i.targets.empty())
+    {
+      size_t head = index.at(&*i.targets.front());
+      for(size_t j = head; j <= n; j++)
+        res[j] = true;
+    }
+    n++;
+  }
+
+  return res;
+}
+
+/// Replaces \p it by the instructions of \p p, keeping the jumps to it.
+/// Nothing in \p p may jump to its first instruction. The instructions
+/// without a location get the one of \p it.
+static void
+replace(goto_programt &body, goto_programt::targett it, goto_programt &p)
+{
+  assert(!p.instructions.empty());
+  size_t n = p.instructions.size();
+  goto_programt::instructiont orig;
+  orig.swap(*it);
+  body.insert_swap(it, p);
+  body.instructions.erase(std::next(it, n));
+
+  for(auto i = it; n != 0; ++i, --n)
+  {
+    if(i->location.is_nil())
+      i->location = orig.location;
+    i->function = orig.function;
+  }
+}
+
+bool goto_sequentializet::run(goto_functionst &goto_functions)
+{
+  auto main = goto_functions.function_map.find("c:@F@main");
+  if(main == goto_functions.function_map.end() || !main->second.body_available)
+    return false;
+
+  threads.push_back({"c:@F@main", "__ESBMC_lazy_thread_0", {}, {}, {}});
+  find_threads(goto_functions);
+  if(threads.size() == 1)
+    return false;
+
+  log_status(
+    "Sequentializing {} threads over {} round(s)", threads.size(), rounds);
+
+  type2tc flags =
+    array_type2tc(get_bool_type(), gen_ulong(threads.size()), false);
+  active = add_global("__ESBMC_lazy_active", flags);
+  done = add_global("__ESBMC_lazy_done", flags);
+  pc = add_global(
+    "__ESBMC_lazy_pc",
+    array_type2tc(get_uint32_type(), gen_ulong(threads.size()), false));
+  retval = add_global(
+    "__ESBMC_lazy_retval",
+    array_type2tc(
+      pointer_type2tc(get_empty_type()), gen_ulong(threads.size()), false));
+
+  for(unsigned k = 0; k < threads.size(); k++)
+    make_locals(k, goto_functions.function_map.at(threads[k].start));
+
+  for(unsigned k = 0; k < threads.size(); k++)
+  {
+    goto_functiont f =
+      sequentialize(k, goto_functions.function_map.at(threads[k].start));
+    goto_functions.function_map[threads[k].id].body.swap(f.body);
+    goto_functiont &g = goto_functions.function_map[threads[k].id];
+    g.type = f.type;
+    g.body_available = true;
+    g.inlined_funcs = f.inlined_funcs;
+  }
+
+  make_scheduler(main->second);
+  goto_functions.update();
+  return true;
+}
+
+void goto_sequentializet::find_threads(goto_functionst &goto_functions)
+{
+  std::unordered_set<irep_idt, irep_id_hash> starts;
+  for(unsigned k = 0; k < threads.size(); k++)
+  {
+    auto f = goto_functions.function_map.find(threads[k].start);
+    if(f == goto_functions.function_map.end() || !f->second.body_available)
+    {
+      log_error(
+        "Lazy sequentialization needs the body of thread start routine {}",
+        threads[k].start);
+      abort();
+    }
+
+    // Preemption points are only added to the start routines themselves
+    if(starts.insert(threads[k].start).second)
+      inline_calls(goto_functions, f->second);
+
+    std::vector<bool> loop = in_loop(f->second.body);
+    auto in_loop_it = loop.begin();
+    for(const auto &i : f->second.body.instructions)
+    {
+      bool looped = *in_loop_it++;
+      if(called_function(i) != "c:@F@pthread_create")
+        continue;
+
+      const code_function_call2t &call = to_code_function_call2t(i.code);
+      irep_idt routine =
+        call.operands.size() == 4 ? start_routine(call.operands[2]) : "";
+      if(routine.empty())
+      {
+        log_error(
+          "Lazy sequentialization needs pthread_create to name the start "
+          "routine at {}",
+          i.location);
+        abort();
+      }
+
+      // Each iteration of a loop may create another thread
+      if(looped && loop_threads == 0)
+      {
+        log_error(
+          "Lazy sequentialization needs --unwind to bound the threads "
+          "created in the loop at {}",
+          i.location);
+        abort();
+      }
+
+      unsigned slots = looped ? loop_threads : 1;
+      if(threads.size() + slots > max_threads)
+      {
+        log_error(
+          "Lazy sequentialization supports up to {} threads, is "
+          "pthread_create called recursively, or in a loop unwound too far?",
+          max_threads);
+        abort();
+      }
+
+      threads[k].children.emplace_back();
+      for(unsigned n = 0; n < slots; n++)
+      {
+        unsigned child = threads.size();
+        threads[k].children.back().push_back(child);
+        threads.push_back(
+          {routine,
+           "__ESBMC_lazy_thread_" + std::to_string(child),
+           {},
+           {},
+           {}});
+      }
+    }
+  }
+
+  // Anywhere else, thread management would escape the scheduler
+  for(const auto &f : goto_functions.function_map)
+  {
+    if(!f.second.body_available || starts.count(f.first))
+      continue;
+
+    for(const auto &i : f.second.body.instructions)
+    {
+      if(!is_thread_call(called_function(i)))
+        continue;
+
+      log_error(
+        "Lazy sequentialization only supports thread management in main and "
+        "thread start routines, found a call in {}",
+        f.first);
+      abort();
+    }
+  }
+}
+
+void goto_sequentializet::inline_calls(
+  goto_functionst &goto_functions,
+  goto_functiont &f)
+{
+  // The inliner leaves the calls to functions without a body alone
+  std::vector<goto_functiont *> kept;
+  for(auto &it : goto_functions.function_map)
+  {
+    if(it.second.body_available && is_special_call(it.first))
+    {
+      it.second.body_available = false;
+      kept.push_back(&it.second);
+    }
+  }
+
+  optionst options;
+  const namespacet ns(context);
+  goto_inlinet inliner(goto_functions, options, ns);
+  inliner.smallfunc_limit = std::numeric_limits<unsigned>::max();
+
+  // Recursive calls are left in place, without a full inlining
+  inliner.goto_inline_rec(f.body, false);
+  f.inlined_funcs.insert(
+    inliner.inlined_funcs.begin(), inliner.inlined_funcs.end());
+
+  for(goto_functiont *g : kept)
+    g->body_available = true;
+}
+
+expr2tc goto_sequentializet::add_global(const irep_idt &id, const type2tc &type)
+{
+  symbolt s;
+  s.id = id;
+  s.name = id;
+  s.type = migrate_type_back(type);
+  s.static_lifetime = true;
+  s.lvalue = true;
+  context.add(s);
+
+  unshared_syms.insert(id);
+  return symbol2tc(type, id);
+}
+
+/// Collects the symbols whose address is taken below \p e
+static void address_taken(
+  const expr2tc &e,
+  std::unordered_set<irep_idt, irep_id_hash> &dest)
+{
+  if(is_nil_expr(e))
+    return;
+
+  if(is_address_of2t(e))
+  {
+    // Members and elements of a local share it as a whole
+    expr2tc obj = to_address_of2t(e).ptr_obj;
+    while(is_member2t(obj) || is_index2t(obj))
+      obj = is_member2t(obj) ? to_member2t(obj).source_value
+                             : to_index2t(obj).source_value;
+    if(is_symbol2t(obj))
+      dest.insert(to_symbol2t(obj).thename);
+  }
+
+  e->foreach_operand(
+    [&dest](const expr2tc &op) { address_taken(op, dest); });
+}
+
+void goto_sequentializet::make_locals(unsigned k, const goto_functiont &start)
+{
+  std::set<irep_idt> ids;
+  get_local_identifiers(start, ids);
+  for(const auto &i : start.body.instructions)
+    if(is_decl(i))
+      ids.insert(to_code_decl2t(i.code).value);
+
+  std::unordered_set<irep_idt, irep_id_hash> escaping;
+  for(const auto &i : start.body.instructions)
+  {
+    address_taken(i.code, escaping);
+    address_taken(i.guard, escaping);
+  }
+
+  for(const irep_idt &id : ids)
+  {
+    const symbolt *sym = context.find_symbol(id);
+    if(sym == nullptr || sym->static_lifetime)
+      continue;
+
+    symbolt s = *sym;
+    s.id = id2string(id) + "@lazy" + std::to_string(k);
+    s.name = s.id;
+    s.static_lifetime = true;
+    s.is_parameter = false;
+    s.value.make_nil();
+    context.add(s);
+
+    threads[k].locals[id] = symbol2tc(migrate_type(sym->type), s.id);
+    if(!escaping.count(id))
+      unshared_syms.insert(s.id);
+  }
+
+  const code_typet::argumentst &args = start.type.arguments();
+  if(!args.empty())
+  {
+    auto it = threads[k].locals.find(args.front().get_identifier());
+    if(it != threads[k].locals.end())
+      threads[k].param = it->second;
+  }
+}
+
+void goto_sequentializet::rename_locals(unsigned k, expr2tc &e) const
+{
+  if(is_nil_expr(e))
+    return;
+
+  if(is_symbol2t(e))
+  {
+    auto it = threads[k].locals.find(to_symbol2t(e).thename);
+    if(it != threads[k].locals.end())
+      e = it->second;
+    return;
+  }
+
+  e->Foreach_operand([this, k](expr2tc &op) { rename_locals(k, op); });
+}
+
+bool goto_sequentializet::is_shared(const expr2tc &e) const
+{
+  if(is_nil_expr(e))
+    return false;
+
+  if(is_dereference2t(e))
+    return true;
+
+  if(is_symbol2t(e))
+  {
+    const irep_idt &id = to_symbol2t(e).thename;
+    const symbolt *sym = context.find_symbol(id);
+    return sym != nullptr && sym->static_lifetime && !sym->type.is_code() &&
+           !unshared_syms.count(id);
+  }
+
+  // Taking an address reads nothing but the indices on the way
+  if(is_address_of2t(e))
+  {
+    const expr2tc &obj = to_address_of2t(e).ptr_obj;
+    if(is_symbol2t(obj))
+      return false;
+  }
+
+  bool shared = false;
+  e->foreach_operand(
+    [this, &shared](const expr2tc &op) { shared = shared || is_shared(op); });
+  return shared;
+}
+
+bool goto_sequentializet::is_visible(const goto_programt::instructiont &i) const
+{
+  switch(i.type)
+  {
+  case FUNCTION_CALL:
+  case ATOMIC_BEGIN:
+    return true;
+
+  case GOTO:
+  case ASSUME:
+  case ASSERT:
+  case ASSIGN:
+  case RETURN:
+  case OTHER:
+    return is_shared(i.guard) || is_shared(i.code);
+
+  default:
+    return false;
+  }
+}
+
+goto_functiont
+goto_sequentializet::sequentialize(unsigned k, const goto_functiont &start)
+{
+  goto_functiont f;
+  f.type.return_type() = empty_typet();
+  f.body.copy_from(start.body);
+  f.inlined_funcs = start.inlined_funcs;
+
+  for(auto &i : f.body.instructions)
+  {
+    i.function = threads[k].id;
+    rename_locals(k, i.code);
+    rename_locals(k, i.guard);
+  }
+
+  // Returns reach the end of the function, where the thread terminates
+  goto_programt::targett end = std::prev(f.body.instructions.end());
+  assert(end->is_end_function());
+  goto_programt term;
+  goto_programt::targett t = term.add_instruction(ASSIGN);
+  t->code = code_assign2tc(element(active, k), gen_false_expr());
+  t = term.add_instruction(ASSIGN);
+  t->code = code_assign2tc(element(done, k), gen_true_expr());
+  for(auto &i : term.instructions)
+    i.location = end->location;
+  f.body.insert_swap(end, term);
+
+  add_preemption_points(k, f.body);
+  replace_thread_calls(k, f.body, end);
+  f.body.update_instructions_function(threads[k].id);
+
+  symbolt s;
+  s.id = threads[k].id;
+  s.name = threads[k].id;
+  s.type = f.type;
+  s.mode = "C";
+  context.add(s);
+  return f;
+}
+
+void goto_sequentializet::add_preemption_points(
+  unsigned k,
+  goto_programt &body)
+{
+  goto_programt::targett exit = std::prev(body.instructions.end());
+
+  std::vector<goto_programt::targett> points;
+  unsigned atomic = 0;
+  for(auto it = body.instructions.begin(); it != exit; ++it)
+  {
+    if(it->is_atomic_end() && atomic > 0)
+      atomic--;
+    if(atomic == 0 && is_visible(*it))
+      points.push_back(it);
+    if(it->is_atomic_begin())
+      atomic++;
+  }
+
+  // Either go on, or save the point reached and leave
+  goto_programt dispatch;
+  for(size_t n = 0; n < points.size(); n++)
+  {
+    goto_programt::targett it = points[n];
+    expr2tc id = constant_int2tc(get_uint32_type(), BigInt(n + 1));
+
+    goto_programt p;
+    goto_programt::targett t = p.add_instruction(GOTO);
+    t->guard = gen_nondet(get_bool_type());
+    t->location = it->location;
+    t = p.add_instruction(ASSIGN);
+    t->code = code_assign2tc(element(pc, k), id);
+    t->location = it->location;
+    t = p.add_instruction(GOTO);
+    t->make_goto(exit, gen_true_expr());
+    t->location = it->location;
+
+    body.insert_swap(it, p);
+    goto_programt::targett resume = std::next(it, 3);
+    it->set_target(resume);
+
+    t = dispatch.add_instruction(GOTO);
+    t->make_goto(resume, equality2tc(element(pc, k), id));
+    t->location = resume->location;
+  }
+
+  body.destructive_insert(body.instructions.begin(), dispatch);
+}
+
+void goto_sequentializet::replace_thread_calls(
+  unsigned k,
+  goto_programt &body,
+  goto_programt::targett term)
+{
+  auto next_child = threads[k].children.begin();
+  for(auto it = body.instructions.begin(); it != body.instructions.end();)
+  {
+    goto_programt::targett cur = it++;
+
+    if(is_decl(*cur))
+    {
+      // The thread's locals now keep their values between activations, a
+      // declaration is where the value becomes undefined
+      const code_decl2t &decl = to_code_decl2t(cur->code);
+      auto l = threads[k].locals.find(decl.value);
+      if(l != threads[k].locals.end())
+      {
+        cur->make_assignment();
+        cur->code = code_assign2tc(l->second, gen_nondet(l->second->type));
+      }
+      continue;
+    }
+
+    if(cur->type == DEAD)
+    {
+      if(threads[k].locals.count(to_code_dead2t(cur->code).value))
+        cur->make_skip();
+      continue;
+    }
+
+    if(cur->is_return())
+    {
+      const code_return2t &ret = to_code_return2t(cur->code);
+      if(k == 0 || is_nil_expr(ret.operand))
+        cur->make_skip();
+      else
+      {
+        expr2tc value =
+          typecast2tc(get_array_subtype(retval->type), ret.operand);
+        cur->make_assignment();
+        cur->code = code_assign2tc(element(retval, k), value);
+      }
+      continue;
+    }
+
+    irep_idt f = called_function(*cur);
+    if(f.empty())
+      continue;
+
+    const code_function_call2t call = to_code_function_call2t(cur->code);
+    goto_programt p;
+    goto_programt::targett t;
+
+    if(f == "c:@F@pthread_create")
+    {
+      assert(next_child != threads[k].children.end());
+      const std::vector<unsigned> &slots = *next_child++;
+
+      // Each call site stands for one thread, or for one per iteration of
+      // the loop it is in, which takes the first slot not used yet
+      bool looped = slots.size() > 1;
+      std::vector<goto_programt::targett> created;
+      for(unsigned child : slots)
+      {
+        expr2tc used = or2tc(element(active, child), element(done, child));
+        goto_programt::targett next;
+        if(looped)
+          next = p.add_instruction(GOTO);
+        else
+        {
+          t = p.add_instruction(ASSUME);
+          t->guard = not2tc(used);
+        }
+
+        const expr2tc &tid = call.operands[0];
+        t = p.add_instruction(ASSIGN);
+        t->code = code_assign2tc(
+          dereference2tc(to_pointer_type(tid->type).subtype, tid),
+          typecast2tc(
+            to_pointer_type(tid->type).subtype, gen_ulong(BigInt(child))));
+
+        t = p.add_instruction(ASSIGN);
+        t->code = code_assign2tc(element(active, child), gen_true_expr());
+
+        if(!is_nil_expr(threads[child].param))
+        {
+          t = p.add_instruction(ASSIGN);
+          t->code = code_assign2tc(
+            threads[child].param,
+            typecast2tc(threads[child].param->type, call.operands[3]));
+        }
+
+        if(looped)
+        {
+          created.push_back(p.add_instruction(GOTO));
+          t = p.add_instruction(SKIP);
+          next->make_goto(t, used);
+        }
+      }
+
+      if(looped)
+      {
+        // Rather than cutting off the executions creating more threads
+        t = p.add_instruction(ASSERT);
+        t->guard = gen_false_expr();
+        t->location = cur->location;
+        t->location.comment(
+          "lazy sequentialization ran out of threads for the loop, raise "
+          "--unwind");
+
+        t = p.add_instruction(SKIP);
+        for(goto_programt::targett g : created)
+          g->make_goto(t, gen_true_expr());
+      }
+    }
+    else if(is_join(f))
+    {
+      // Only a thread that already ended can be joined
+      const expr2tc &tid = call.operands[0];
+      t = p.add_instruction(ASSUME);
+      t->guard = element(done, tid);
+
+      const expr2tc &res = call.operands[1];
+      if(!is_symbol2t(res) || to_symbol2t(res).thename != "NULL")
+      {
+        goto_programt::targett skip = p.add_instruction(GOTO);
+        t = p.add_instruction(ASSIGN);
+        t->code = code_assign2tc(
+          dereference2tc(to_pointer_type(res->type).subtype, res),
+          element(retval, tid));
+        t = p.add_instruction(SKIP);
+        skip->make_goto(t, equality2tc(res, gen_zero(res->type)));
+      }
+    }
+    else if(f == "c:@F@pthread_exit")
+    {
+      if(k != 0)
+      {
+        t = p.add_instruction(ASSIGN);
+        t->code = code_assign2tc(
+          element(retval, k),
+          typecast2tc(get_array_subtype(retval->type), call.operands[0]));
+      }
+      t = p.add_instruction(GOTO);
+      t->make_goto(term, gen_true_expr());
+    }
+    else if(f == "c:@F@pthread_self" || f == "c:@F@__ESBMC_get_thread_id")
+    {
+      if(!is_nil_expr(call.ret))
+      {
+        t = p.add_instruction(ASSIGN);
+        t->code = code_assign2tc(
+          call.ret, typecast2tc(call.ret->type, gen_ulong(BigInt(k))));
+      }
+    }
+    else
+      continue;
+
+    // The library versions succeed, and so do these
+    if(
+      !is_nil_expr(call.ret) && f != "c:@F@pthread_self" &&
+      f != "c:@F@__ESBMC_get_thread_id")
+    {
+      t = p.add_instruction(ASSIGN);
+      t->code = code_assign2tc(call.ret, gen_zero(call.ret->type));
+    }
+
+    if(p.instructions.empty())
+      cur->make_skip();
+    else
+    {
+      // Keep the first instruction a plain one, nothing may jump to it
+      if(p.instructions.front().is_goto())
+        p.instructions.push_front(goto_programt::instructiont(SKIP));
+      replace(body, cur, p);
+    }
+  }
+}
+
+void goto_sequentializet::make_scheduler(goto_functiont &main)
+{
+  const locationt loc = main.body.instructions.front().location;
+  goto_programt s;
+  goto_programt::targett t;
+
+  for(const expr2tc &a : {active, done, pc, retval})
+  {
+    t = s.add_instruction(ASSIGN);
+    t->code = code_assign2tc(a, gen_zero(a->type, true));
+  }
+
+  t = s.add_instruction(ASSIGN);
+  t->code = code_assign2tc(element(active, 0), gen_true_expr());
+
+  // Thread 0 runs main, which gets its arguments from here
+  for(const auto &arg : main.type.arguments())
+  {
+    auto it = threads[0].locals.find(arg.get_identifier());
+    if(it != threads[0].locals.end())
+    {
+      t = s.add_instruction(ASSIGN);
+      t->code = code_assign2tc(
+        it->second, symbol2tc(it->second->type, arg.get_identifier()));
+    }
+  }
+
+  type2tc thread_type = code_type2tc(
+    std::vector<type2tc>(), get_empty_type(), std::vector<irep_idt>(), false);
+  for(unsigned r = 0; r < rounds; r++)
+  {
+    for(unsigned k = 0; k < threads.size(); k++)
+    {
+      goto_programt::targett skip = s.add_instruction(GOTO);
+      t = s.add_instruction(FUNCTION_CALL);
+      t->code = code_function_call2tc(
+        expr2tc(),
+        symbol2tc(thread_type, threads[k].id),
+        std::vector<expr2tc>());
+      t = s.add_instruction(SKIP);
+      skip->make_goto(t, not2tc(element(active, k)));
+    }
+  }
+
+  type2tc ret_type = migrate_type(main.type.return_type());
+  if(!is_empty_type(ret_type))
+  {
+    t = s.add_instruction(RETURN);
+    t->code = code_return2tc(gen_zero(ret_type));
+  }
+  s.add_instruction(END_FUNCTION);
+
+  for(auto &i : s.instructions)
+  {
+    i.location = loc;
+    i.function = "c:@F@main";
+  }
+
+  main.body.swap(s);
+}
+
+expr2tc goto_sequentializet::element(const expr2tc &array, unsigned k) const
+{
+  return element(array, gen_ulong(BigInt(k)));
+}
+
+expr2tc
+goto_sequentializet::element(const expr2tc &array, const expr2tc &idx) const
+{
+  return index2tc(get_array_subtype(array->type), array, idx);
+}
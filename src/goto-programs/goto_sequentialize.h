@@ -0,0 +1,103 @@
+#ifndef ESBMC_GOTO_SEQUENTIALIZE_H
+#define ESBMC_GOTO_SEQUENTIALIZE_H
+
+#include <util/algorithms.h>
+#include <util/context.h>
+#include <util/message.h>
+#include <unordered_set>
+
+/**
+ * @brief Turns a multithreaded program into a sequential one that simulates
+ * a bounded number of round-robin scheduling rounds, in the style of
+ * Lazy-CSeq.
+ *
+ * Every pthread_create call site reachable from main (in main itself or in
+ * the start routine of a thread created there) stands for one thread, or for
+ * one per iteration, up to the unwinding bound, when it is inside a loop;
+ * main is thread 0. The calls made by main and the start routines are
+ * inlined first, then each thread gets a copy of its start routine where:
+ *
+ *  - locals and parameters become globals of that thread, so they survive
+ *    between activations;
+ *  - a nondeterministic preemption point precedes every instruction that
+ *    may touch shared state outside of an atomic block. Preempting stores
+ *    the point reached in the thread's program counter and returns;
+ *  - a dispatch on entry jumps back to the stored program counter;
+ *  - pthread_create, pthread_join, pthread_exit and pthread_self are
+ *    replaced by updates of the scheduler's bookkeeping.
+ *
+ * main then calls every active thread, in order, once per round. The solver
+ * picks the preemption points, so a single symbolic execution covers all
+ * schedules with that many rounds. Recursive calls are not inlined, and run
+ * without preemption, which restricts the schedules considered. Creating
+ * more threads in a loop than the unwinding bound fails an assertion.
+ */
+class goto_sequentializet : public goto_functions_algorithm
+{
+public:
+  goto_sequentializet(
+    contextt &context,
+    unsigned rounds,
+    unsigned loop_threads)
+    : goto_functions_algorithm(true),
+      context(context),
+      rounds(rounds),
+      loop_threads(loop_threads)
+  {
+  }
+
+  bool run(goto_functionst &goto_functions) override;
+
+protected:
+  contextt &context;
+  const unsigned rounds;
+  /// Threads a create call site inside a loop stands for, zero if unbounded
+  const unsigned loop_threads;
+
+  struct threadt
+  {
+    /// Start routine, main for thread 0
+    irep_idt start;
+    /// Function holding the sequentialized copy of #start
+    irep_idt id;
+    /// Threads each create call site of #start may create, in order
+    std::vector<std::vector<unsigned>> children;
+    /// Globals standing for the locals of #start
+    std::unordered_map<irep_idt, expr2tc, irep_id_hash> locals;
+    /// Global standing for the parameter of #start, if any
+    expr2tc param;
+  };
+  std::vector<threadt> threads;
+
+  /// Scheduler bookkeeping, indexed by thread
+  expr2tc active, done, pc, retval;
+  /// Globals made here that no other thread can see: the scheduler's, and
+  /// the locals whose address is never taken
+  std::unordered_set<irep_idt, irep_id_hash> unshared_syms;
+
+  /// Finds the threads created by main, and those they create in turn
+  void find_threads(goto_functionst &goto_functions);
+  /// Inlines the calls of \p f, but those to thread management and intrinsics
+  void inline_calls(goto_functionst &goto_functions, goto_functiont &f);
+  expr2tc add_global(const irep_idt &id, const type2tc &type);
+  void make_locals(unsigned k, const goto_functiont &start);
+  void rename_locals(unsigned k, expr2tc &e) const;
+
+  /// Whether \p e reads or writes something another thread can see
+  bool is_shared(const expr2tc &e) const;
+  bool is_visible(const goto_programt::instructiont &i) const;
+
+  goto_functiont sequentialize(unsigned k, const goto_functiont &start);
+  void add_preemption_points(unsigned k, goto_programt &body);
+  /// Rewrites thread management, \p term being where the thread ends
+  void replace_thread_calls(
+    unsigned k,
+    goto_programt &body,
+    goto_programt::targett term);
+  void make_scheduler(goto_functiont &main);
+
+  expr2tc element(const expr2tc &array, unsigned k) const;
+  expr2tc element(const expr2tc &array, const expr2tc &idx) const;
+};
+
+#endif
@@ -0,0 +1,552 @@
+#include <goto-programs/lockset_analysis.h>
+#include <irep2/irep2_utils.h>
+#include <util/c_types.h>
+#include <util/prefix.h>
+
+static bool is_lock(const irep_idt &f)
+{
+  return f == "c:@F@pthread_mutex_lock" ||
+         has_prefix(id2string(f), "c:@F@pthread_mutex_lock_");
+}
+
+static bool is_unlock(const irep_idt &f)
+{
+  return f == "c:@F@pthread_mutex_unlock" ||
+         has_prefix(id2string(f), "c:@F@pthread_mutex_unlock_");
+}
+
+/// Waiting on a condition variable gives the mutex back before returning
+static bool is_cond_wait(const irep_idt &f)
+{
+  return f == "c:@F@pthread_cond_wait" ||
+         has_prefix(id2string(f), "c:@F@pthread_cond_wait_");
+}
+
+static bool is_create(const irep_idt &f)
+{
+  return f == "c:@F@pthread_create";
+}
+
+static expr2tc strip_casts(const expr2tc &e)
+{
+  expr2tc res = e;
+  while(is_typecast2t(res))
+    res = to_typecast2t(res).from;
+  return res;
+}
+
+/// The function named by \p arg, the start routine argument of a
+/// pthread_create call, if it is a constant
+static irep_idt start_routine(const expr2tc &arg)
+{
+  expr2tc e = strip_casts(arg);
+  if(is_address_of2t(e))
+    e = to_address_of2t(e).ptr_obj;
+
+  if(!is_symbol2t(e) || !is_code_type(e->type))
+    return irep_idt();
+
+  return to_symbol2t(e).thename;
+}
+
+/// Object the pointer \p arg refers to, if the same one at all times: a
+/// global, or a member or constant element of one
+static expr2tc lock_object(const expr2tc &arg, const namespacet &ns)
+{
+  expr2tc e = strip_casts(arg);
+  if(!is_address_of2t(e))
+    return expr2tc();
+
+  expr2tc obj = to_address_of2t(e).ptr_obj;
+  expr2tc base = obj;
+  while(is_member2t(base) || is_index2t(base))
+  {
+    if(is_member2t(base))
+      base = to_member2t(base).source_value;
+    else if(is_constant_int2t(to_index2t(base).index))
+      base = to_index2t(base).source_value;
+    else
+      return expr2tc();
+  }
+
+  if(!is_symbol2t(base))
+    return expr2tc();
+
+  const symbolt *s = ns.lookup(to_symbol2t(base).thename);
+  if(s == nullptr || !s->static_lifetime)
+    return expr2tc();
+
+  return obj;
+}
+
+/// Collects the symbols read or written by \p e. Taking the address of an
+/// object accesses neither it nor, for members and elements, its container.
+static void
+accessed(const expr2tc &e, std::unordered_set<irep_idt, irep_id_hash> &dest)
+{
+  if(is_nil_expr(e))
+    return;
+
+  if(is_symbol2t(e))
+  {
+    dest.insert(to_symbol2t(e).thename);
+    return;
+  }
+
+  if(is_address_of2t(e))
+  {
+    expr2tc obj = to_address_of2t(e).ptr_obj;
+    while(is_member2t(obj) || is_index2t(obj))
+    {
+      if(is_index2t(obj))
+      {
+        accessed(to_index2t(obj).index, dest);
+        obj = to_index2t(obj).source_value;
+      }
+      else
+        obj = to_member2t(obj).source_value;
+    }
+
+    if(!is_symbol2t(obj))
+      accessed(obj, dest);
+    return;
+  }
+
+  e->foreach_operand([&dest](const expr2tc &op) { accessed(op, dest); });
+}
+
+/// Collects the symbols whose address is taken in \p e
+static void find_address_taken(
+  const expr2tc &e,
+  std::unordered_set<irep_idt, irep_id_hash> &dest)
+{
+  if(is_nil_expr(e))
+    return;
+
+  if(is_address_of2t(e))
+  {
+    expr2tc obj = to_address_of2t(e).ptr_obj;
+    while(is_member2t(obj) || is_index2t(obj))
+      obj = is_member2t(obj) ? to_member2t(obj).source_value
+                             : to_index2t(obj).source_value;
+    if(is_symbol2t(obj))
+      dest.insert(to_symbol2t(obj).thename);
+  }
+
+  e->foreach_operand(
+    [&dest](const expr2tc &op) { find_address_taken(op, dest); });
+}
+
+static bool in_loop(const goto_programt &body, goto_programt::const_targett it)
+{
+  std::unordered_map<const goto_programt::instructiont *, size_t> pos;
+  forall_goto_program_instructions(i, body)
+    pos.emplace(&*i, pos.size());
+
+  size_t p = pos.at(&*it);
+  forall_goto_program_instructions(i, body)
+  {
+    if(!i->is_goto())
+      continue;
+
+    for(const auto &t : i->targets)
+      if(pos.at(&*t) <= p && p <= pos.at(&*i))
+        return true;
+  }
+
+  return false;
+}
+
+static const expr2tc &atomic_lock()
+{
+  static const expr2tc lock =
+    symbol2tc(get_empty_type(), "lockset_analysis::atomic");
+  return lock;
+}
+
+bool lockset_analysist::statet::merge(const statet &other)
+{
+  if(!other.reached)
+    return false;
+
+  if(!reached)
+  {
+    *this = other;
+    return true;
+  }
+
+  bool changed = false;
+  if(other.threaded && !threaded)
+  {
+    threaded = true;
+    changed = true;
+  }
+
+  if(other.atomic < atomic)
+  {
+    atomic = other.atomic;
+    changed = true;
+  }
+
+  for(auto it = locks.begin(); it != locks.end();)
+  {
+    if(other.locks.count(*it))
+    {
+      ++it;
+      continue;
+    }
+
+    it = locks.erase(it);
+    changed = true;
+  }
+
+  return changed;
+}
+
+void lockset_analysist::operator()(const goto_functionst &_goto_functions)
+{
+  goto_functions = &_goto_functions;
+  build_call_graph();
+  find_roots();
+
+  id_sett work;
+  for(const auto &e : entry)
+    work.insert(e.first);
+
+  while(!work.empty())
+  {
+    irep_idt f = *work.begin();
+    work.erase(work.begin());
+    for(const auto &g : analyze(f))
+      work.insert(g);
+  }
+
+  // The thread library's own code is never reached by the above, whatever it
+  // accesses is left out
+  id_sett unknown;
+  forall_goto_functions(f_it, *goto_functions)
+  {
+    if(entry.count(f_it->first))
+      continue;
+
+    forall_goto_program_instructions(i, f_it->second.body)
+    {
+      accessed(i->code, unknown);
+      accessed(i->guard, unknown);
+    }
+  }
+
+  for(const auto &a : accesses)
+  {
+    if(address_taken.count(a.first) || unknown.count(a.first))
+      continue;
+
+    const accesst &acc = a.second;
+    if(
+      !acc.threaded || !acc.locks.empty() ||
+      (acc.roots.size() == 1 && single_instance(*acc.roots.begin())))
+      race_free.insert(a.first);
+  }
+}
+
+void lockset_analysist::build_call_graph()
+{
+  id_sett indirect_callers;
+  forall_goto_functions(f_it, *goto_functions)
+  {
+    const irep_idt &f = f_it->first;
+    forall_goto_program_instructions(i, f_it->second.body)
+    {
+      find_address_taken(i->code, address_taken);
+      find_address_taken(i->guard, address_taken);
+
+      if(!i->is_function_call())
+        continue;
+
+      const code_function_call2t &c = to_code_function_call2t(i->code);
+      if(!is_symbol2t(c.function))
+      {
+        indirect_callers.insert(f);
+        continue;
+      }
+
+      const irep_idt &g = to_symbol2t(c.function).thename;
+      if(is_unlock(g))
+        may_unlock.insert(f);
+      else if(is_create(g))
+      {
+        may_spawn.insert(f);
+        irep_idt start =
+          c.operands.size() > 2 ? start_routine(c.operands[2]) : irep_idt();
+        if(start.empty())
+          unknown_threads = true;
+        else
+          create_sites[start].push_back({f, i});
+      }
+      else if(!is_lock(g) && !is_cond_wait(g))
+      {
+        callees[f].insert(g);
+        call_sites[g].push_back({f, i});
+      }
+    }
+  }
+
+  // Calls through a pointer may reach any function whose address is taken
+  for(const auto &f : indirect_callers)
+    for(const auto &g : address_taken)
+      if(goto_functions->function_map.count(g))
+        callees[f].insert(g);
+
+  bool changed = true;
+  while(changed)
+  {
+    changed = false;
+    for(const auto &c : callees)
+      for(const auto &g : c.second)
+      {
+        if(may_unlock.count(g) && may_unlock.insert(c.first).second)
+          changed = true;
+        if(may_spawn.count(g) && may_spawn.insert(c.first).second)
+          changed = true;
+      }
+  }
+}
+
+void lockset_analysist::find_roots()
+{
+  std::vector<irep_idt> roots = {goto_functions->main_id()};
+  for(const auto &c : create_sites)
+    roots.push_back(c.first);
+
+  if(unknown_threads)
+    for(const auto &g : address_taken)
+      if(goto_functions->function_map.count(g))
+        roots.push_back(g);
+
+  for(const auto &root : roots)
+  {
+    auto f_it = goto_functions->function_map.find(root);
+    if(f_it == goto_functions->function_map.end())
+      continue;
+
+    statet s;
+    s.reached = true;
+    s.threaded = root != goto_functions->main_id();
+    entry[root].merge(s);
+
+    std::vector<irep_idt> work = {root};
+    while(!work.empty())
+    {
+      irep_idt f = work.back();
+      work.pop_back();
+      if(!roots_of[f].insert(root).second)
+        continue;
+
+      auto c = callees.find(f);
+      if(c != callees.end())
+        work.insert(work.end(), c->second.begin(), c->second.end());
+    }
+  }
+}
+
+bool lockset_analysist::runs_once(const irep_idt &f, unsigned depth) const
+{
+  if(f == goto_functions->main_id())
+    return true;
+
+  if(depth > 16 || address_taken.count(f) || create_sites.count(f))
+    return false;
+
+  auto sites = call_sites.find(f);
+  if(sites == call_sites.end() || sites->second.size() != 1)
+    return false;
+
+  const call_sitet &site = sites->second.front();
+  const goto_programt &body =
+    goto_functions->function_map.at(site.caller).body;
+  return !in_loop(body, site.it) && runs_once(site.caller, depth + 1);
+}
+
+bool lockset_analysist::single_instance(const irep_idt &root) const
+{
+  if(root == goto_functions->main_id())
+    return true;
+
+  if(unknown_threads)
+    return false;
+
+  auto sites = create_sites.find(root);
+  if(sites == create_sites.end() || sites->second.size() != 1)
+    return false;
+
+  const call_sitet &site = sites->second.front();
+  const goto_programt &body =
+    goto_functions->function_map.at(site.caller).body;
+  return !in_loop(body, site.it) && runs_once(site.caller, 0);
+}
+
+lockset_analysist::id_sett lockset_analysist::analyze(const irep_idt &f)
+{
+  id_sett changed;
+  const goto_programt &body = goto_functions->function_map.at(f).body;
+  if(body.instructions.empty())
+    return changed;
+
+  std::vector<goto_programt::const_targett> insns;
+  std::unordered_map<const goto_programt::instructiont *, size_t> index;
+  forall_goto_program_instructions(i, body)
+  {
+    index.emplace(&*i, insns.size());
+    insns.push_back(i);
+  }
+
+  std::vector<statet> states(insns.size());
+  states[0].merge(entry[f]);
+
+  // Visit in program order, so loop bodies settle before what follows them
+  std::set<size_t> work = {0};
+  while(!work.empty())
+  {
+    size_t n = *work.begin();
+    work.erase(work.begin());
+
+    const goto_programt::instructiont &i = *insns[n];
+    statet s = states[n];
+    record(f, i.code, s);
+    record(f, i.guard, s);
+
+    if(i.is_atomic_begin())
+      s.atomic++;
+    else if(i.is_atomic_end() && s.atomic > 0)
+      s.atomic--;
+    else if(i.is_function_call())
+      call(i, s, changed);
+
+    auto successor = [&states, &work, &s](size_t m) {
+      if(states[m].merge(s))
+        work.insert(m);
+    };
+
+    if(i.is_goto())
+    {
+      for(const auto &t : i.targets)
+        successor(index.at(&*t));
+      if(is_true(i.guard))
+        continue;
+    }
+    else if(i.is_end_function())
+      continue;
+
+    if(n + 1 < insns.size())
+      successor(n + 1);
+  }
+
+  return changed;
+}
+
+void lockset_analysist::record(
+  const irep_idt &f,
+  const expr2tc &e,
+  const statet &s)
+{
+  id_sett syms;
+  accessed(e, syms);
+
+  for(const auto &id : syms)
+  {
+    const symbolt *sym = ns.lookup(id);
+    if(sym == nullptr || !sym->static_lifetime || sym->type.id() == "code")
+      continue;
+
+    accesst &a = accesses[id];
+    if(!s.threaded)
+      continue;
+
+    std::set<expr2tc> held = s.locks;
+    if(s.atomic > 0)
+      held.insert(atomic_lock());
+
+    if(!a.threaded)
+    {
+      a.threaded = true;
+      a.locks = held;
+    }
+    else
+    {
+      for(auto it = a.locks.begin(); it != a.locks.end();)
+        it = held.count(*it) ? std::next(it) : a.locks.erase(it);
+    }
+
+    const id_sett &roots = roots_of[f];
+    a.roots.insert(roots.begin(), roots.end());
+  }
+}
+
+void lockset_analysist::call(
+  const goto_programt::instructiont &i,
+  statet &s,
+  id_sett &changed)
+{
+  const code_function_call2t &c = to_code_function_call2t(i.code);
+  id_sett targets;
+
+  if(is_symbol2t(c.function))
+  {
+    const irep_idt &g = to_symbol2t(c.function).thename;
+    expr2tc lock =
+      c.operands.empty() ? expr2tc() : lock_object(c.operands[0], ns);
+
+    if(is_lock(g))
+    {
+      if(!is_nil_expr(lock))
+        s.locks.insert(lock);
+      return;
+    }
+
+    if(is_unlock(g))
+    {
+      if(is_nil_expr(lock))
+        s.locks.clear();
+      else
+        s.locks.erase(lock);
+      return;
+    }
+
+    if(is_create(g))
+    {
+      s.threaded = true;
+      return;
+    }
+
+    if(is_cond_wait(g))
+      return;
+
+    targets.insert(g);
+  }
+  else
+  {
+    for(const auto &g : address_taken)
+      if(goto_functions->function_map.count(g))
+        targets.insert(g);
+  }
+
+  for(const auto &g : targets)
+  {
+    auto f_it = goto_functions->function_map.find(g);
+    if(
+      f_it == goto_functions->function_map.end() ||
+      !f_it->second.body_available)
+      continue;
+
+    if(entry[g].merge(s))
+      changed.insert(g);
+  }
+
+  for(const auto &g : targets)
+  {
+    if(may_unlock.count(g))
+      s.locks.clear();
+    if(may_spawn.count(g))
+      s.threaded = true;
+  }
+}
@@ -0,0 +1,109 @@
+#ifndef CPROVER_GOTO_PROGRAMS_LOCKSET_ANALYSIS_H
+#define CPROVER_GOTO_PROGRAMS_LOCKSET_ANALYSIS_H
+
+#include <goto-programs/goto_functions.h>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <util/namespace.h>
+
+/**
+ * @brief Finds the globals no two threads can access at the same time,
+ * because a single thread ever accesses them, or because every access
+ * holds a common mutex (the lockset discipline of Eraser).
+ *
+ * Threads are the entry point and the start routines named at
+ * pthread_create call sites. A start routine stands for a single thread
+ * only if it is created at one call site, outside of any loop, in code that
+ * itself runs once. The mutexes held are propagated along the control flow
+ * of each function and into its callees, intersecting where paths meet; an
+ * atomic block counts as holding a mutex of its own. Accesses the entry
+ * point makes before creating any thread are ignored. Globals whose address
+ * is taken may be accessed through pointers, so they are never race-free.
+ */
+class lockset_analysist
+{
+public:
+  explicit lockset_analysist(const namespacet &_ns) : ns(_ns)
+  {
+  }
+
+  void operator()(const goto_functionst &goto_functions);
+
+  /** Whether no two threads can access the global \p id concurrently */
+  bool is_race_free(const irep_idt &id) const
+  {
+    return race_free.count(id) != 0;
+  }
+
+  const std::unordered_set<irep_idt, irep_id_hash> &get_race_free() const
+  {
+    return race_free;
+  }
+
+protected:
+  typedef std::unordered_set<irep_idt, irep_id_hash> id_sett;
+
+  const namespacet &ns;
+  id_sett race_free;
+
+  struct statet
+  {
+    bool reached = false;
+    /// Whether other threads may have been created
+    bool threaded = false;
+    /// Depth of nested atomic blocks
+    unsigned atomic = 0;
+    /// Mutexes held, as the objects their address refers to
+    std::set<expr2tc> locks;
+
+    bool merge(const statet &other);
+  };
+
+  struct call_sitet
+  {
+    irep_idt caller;
+    goto_programt::const_targett it;
+  };
+
+  struct accesst
+  {
+    /// Threads making the accesses
+    id_sett roots;
+    /// Whether any access is made once other threads may exist
+    bool threaded = false;
+    /// Mutexes held at all such accesses
+    std::set<expr2tc> locks;
+  };
+
+  const goto_functionst *goto_functions = nullptr;
+  id_sett address_taken;
+  std::unordered_map<irep_idt, id_sett, irep_id_hash> callees;
+  std::unordered_map<irep_idt, std::vector<call_sitet>, irep_id_hash>
+    call_sites;
+  /// pthread_create call sites, by start routine
+  std::unordered_map<irep_idt, std::vector<call_sitet>, irep_id_hash>
+    create_sites;
+  /// Whether some pthread_create call names no particular start routine
+  bool unknown_threads = false;
+  id_sett may_unlock, may_spawn;
+  std::unordered_map<irep_idt, id_sett, irep_id_hash> roots_of;
+  std::unordered_map<irep_idt, statet, irep_id_hash> entry;
+  std::unordered_map<irep_idt, accesst, irep_id_hash> accesses;
+
+  void build_call_graph();
+  void find_roots();
+  bool runs_once(const irep_idt &f, unsigned depth) const;
+  bool single_instance(const irep_idt &root) const;
+
+  /// Propagates the locksets through \p f, returning the callees whose
+  /// entry state changed
+  id_sett analyze(const irep_idt &f);
+  void record(const irep_idt &f, const expr2tc &e, const statet &s);
+  void call(
+    const goto_programt::instructiont &i,
+    statet &s,
+    id_sett &changed);
+};
+
+#endif
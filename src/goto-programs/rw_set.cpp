@@ -61,6 +61,7 @@ void rw_sett::read_write_rec(
 
     entryt &entry = entries[object];
     entry.object = object;
+    entry.symbol = symbol_expr.get_identifier();
     entry.r = entry.r || r;
     entry.w = entry.w || w;
     entry.guard = migrate_expr_back(guard.as_expr());
@@ -13,6 +13,8 @@ public:
   struct entryt
   {
     irep_idt object;
+    /// Symbol #object is a part of
+    irep_idt symbol;
     bool r, w;
     exprt guard;
 
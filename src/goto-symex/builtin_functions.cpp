@@ -718,7 +718,7 @@ void goto_symext::intrinsic_get_thread_state(
 
   // Thread state is simply whether the thread is ended or not.
   unsigned int flags =
-    (art.get_cur_state().threads_state[tid].thread_ended) ? 1 : 0;
+    (art.get_cur_state().thread_state(tid).thread_ended) ? 1 : 0;
 
   // Reuse threadid
   expr2tc flag_expr =
@@ -788,6 +788,141 @@ void goto_symext::intrinsic_kill_monitor(reachability_treet &art)
   ex_state.kill_monitor_thread();
 }
 
+expr2tc goto_symext::mutex_lock_field(const expr2tc &ptr)
+{
+  if(!is_pointer_type(ptr))
+    return expr2tc();
+
+  type2tc type = ns.follow(to_pointer_type(ptr->type).subtype);
+  if(!is_struct_type(type))
+    return expr2tc();
+
+  const struct_type2t &mutex = to_struct_type(type);
+  auto it = std::find(
+    mutex.member_names.begin(), mutex.member_names.end(), "__lock");
+  if(it == mutex.member_names.end())
+    return expr2tc();
+
+  const type2tc &field_type =
+    mutex.members[it - mutex.member_names.begin()];
+  return member2tc(field_type, dereference2tc(type, ptr), *it);
+}
+
+bool goto_symext::run_pthread_intrinsic(
+  const code_function_call2t &call,
+  reachability_treet &art,
+  const std::string &symname)
+{
+  // The lock and unlock models of pthread_lib.c, in each of the flavours
+  // the frontend renames pthread_mutex_lock and pthread_mutex_unlock to
+  std::string variant;
+  bool lock;
+  if(has_prefix(symname, "c:@F@pthread_mutex_lock"))
+  {
+    variant = symname.substr(strlen("c:@F@pthread_mutex_lock"));
+    lock = true;
+  }
+  else if(has_prefix(symname, "c:@F@pthread_mutex_unlock"))
+  {
+    variant = symname.substr(strlen("c:@F@pthread_mutex_unlock"));
+    lock = false;
+  }
+  else
+    return false;
+
+  if(variant.empty())
+    variant = options.get_bool_option("deadlock-check") ? "_check"
+              : options.get_bool_option("lock-order-check") ? "_nocheck"
+                                                            : "_noassert";
+
+  if(variant != "_check" && variant != "_nocheck" && variant != "_noassert")
+    return false;
+
+  if(call.operands.size() != 1)
+    return false;
+
+  expr2tc field = mutex_lock_field(call.operands[0]);
+  if(is_nil_expr(field))
+    return false;
+
+  const symbolt *blocked = ns.lookup("c:@__ESBMC_blocked_threads_count");
+  const symbolt *running = ns.lookup("c:@__ESBMC_num_threads_running");
+  bool check = lock && variant == "_check";
+  if(check && (blocked == nullptr || running == nullptr))
+    return false;
+
+  execution_statet &ex_state = art.get_cur_state();
+  expr2tc &pending = ex_state.pending_locks[ex_state.get_active_state_number()];
+
+  if(cur_state->guard.is_false())
+  {
+    pending = expr2tc();
+    cur_state->source.pc++;
+    return true;
+  }
+
+  expr2tc zero = gen_zero(field->type);
+  expr2tc one = gen_one(field->type);
+
+  if(!lock)
+  {
+    if(variant != "_noassert")
+    {
+      expr2tc held = notequal2tc(field, zero);
+      dereference(held, dereferencet::READ);
+      claim(held, "must hold lock upon unlock");
+    }
+
+    symex_assign(code_assign2tc(field, zero), true);
+  }
+  else if(!check)
+  {
+    expr2tc is_free = equality2tc(field, zero);
+    dereference(is_free, dereferencet::READ);
+    assume(is_free);
+    symex_assign(code_assign2tc(field, one), true);
+  }
+  else if(is_nil_expr(pending))
+  {
+    // Take the mutex if it's free, otherwise count this thread as blocked and
+    // check that some other thread can still run. Either way, allow a context
+    // switch before this thread goes on; it'll only go on if it got the mutex.
+    expr2tc unlocked = equality2tc(field, zero);
+    dereference(unlocked, dereferencet::READ);
+    cur_state->rename(unlocked);
+
+    symex_assign(
+      code_assign2tc(field, if2tc(field->type, unlocked, one, field)), true);
+
+    expr2tc count = symbol2tc(migrate_type(blocked->type), blocked->id);
+    expr2tc num_running = symbol2tc(migrate_type(running->type), running->id);
+    expr2tc incr = add2tc(count->type, count, gen_one(count->type));
+    symex_assign(
+      code_assign2tc(count, if2tc(count->type, unlocked, count, incr)), true);
+
+    claim(
+      or2tc(
+        unlocked, notequal2tc(count, typecast2tc(count->type, num_running))),
+      "Deadlocked state in pthread_mutex_lock");
+
+    pending = unlocked;
+    ex_state.force_cswitch();
+    // Stay on this call, the rest happens when this thread runs again
+    return true;
+  }
+  else
+  {
+    assume(pending);
+    pending = expr2tc();
+  }
+
+  if(!is_nil_expr(call.ret))
+    symex_assign(code_assign2tc(call.ret, gen_zero(call.ret->type)), true);
+
+  cur_state->source.pc++;
+  return true;
+}
+
 void goto_symext::symex_va_arg(const expr2tc &lhs, const sideeffect2t &code)
 {
   // Get symbol
@@ -63,9 +63,9 @@ execution_statet::execution_statet(
     goto_program,
     0);
 
-  threads_state.push_back(state);
+  threads_state.push_back(std::make_shared<goto_symex_statet>(state));
   preserved_paths.emplace_back();
-  cur_state = &threads_state.front();
+  cur_state = threads_state.front().get();
   cur_state->global_guard.make_true();
   cur_state->global_guard.add(get_guard_identifier());
 
@@ -81,6 +81,7 @@ execution_statet::execution_statet(
   }
 
   thread_start_data.emplace_back();
+  pending_locks.emplace_back();
 
   // Initial mpor tracking.
   thread_last_reads.emplace_back();
@@ -111,18 +112,6 @@ execution_statet::execution_statet(const execution_statet &ex)
     global_value_set(ex.global_value_set)
 {
   *this = ex;
-
-  // Regenerate threads state using new objects state_level2 ref
-  threads_state.clear();
-  std::vector<goto_symex_statet>::const_iterator it;
-  for(it = ex.threads_state.begin(); it != ex.threads_state.end(); it++)
-  {
-    goto_symex_statet state(*it, *state_level2, global_value_set);
-    threads_state.push_back(state);
-  }
-
-  // Reassign which state is currently being worked on.
-  cur_state = &threads_state[active_thread];
 }
 
 execution_statet &execution_statet::operator=(const execution_statet &ex)
@@ -134,7 +123,10 @@ execution_statet &execution_statet::operator=(const execution_statet &ex)
   preserved_paths = ex.preserved_paths;
   atomic_numbers = ex.atomic_numbers;
   DFS_traversed = ex.DFS_traversed;
+  dpor_backtrack = ex.dpor_backtrack;
+  dpor_clock = ex.dpor_clock;
   thread_start_data = ex.thread_start_data;
+  pending_locks = ex.pending_locks;
   last_active_thread = ex.last_active_thread;
   last_insn = ex.last_insn;
   active_thread = ex.active_thread;
@@ -165,14 +157,20 @@ execution_statet &execution_statet::operator=(const execution_statet &ex)
   mpor_says_no = ex.mpor_says_no;
   cswitch_forced = ex.cswitch_forced;
 
+  // All thread states stay shared with ex until either side updates them,
+  // even the active one: a clone is switched to its next thread straight
+  // away, and that copies only the thread about to run. Until then cur_state
+  // is only read.
+  cur_state = threads_state[active_thread].get();
+
   // Vastly irritatingly, we have to iterate through existing level2t objects
   // updating their ex_state references. There isn't an elegant way of updating
   // them, it seems, while keeping the symex stuff ignorant of ex_state.
   // Oooooo, so this is where auto types would be useful...
   for(auto &it : threads_state)
   {
-    for(goto_symex_statet::call_stackt::iterator it2 = it.call_stack.begin();
-        it2 != it.call_stack.end();
+    for(goto_symex_statet::call_stackt::iterator it2 = it->call_stack.begin();
+        it2 != it->call_stack.end();
         it2++)
     {
       for(auto &it3 : it2->goto_state_map)
@@ -320,7 +318,7 @@ void execution_statet::claim(const expr2tc &expr, const std::string &msg)
 
 void execution_statet::symex_goto(const expr2tc &old_guard)
 {
-  pre_goto_guard = threads_state[active_thread].guard;
+  pre_goto_guard = cur_state->guard;
 
   goto_symext::symex_goto(old_guard);
 
@@ -350,12 +348,24 @@ unsigned int &execution_statet::get_nondet_counter()
 
 goto_symex_statet &execution_statet::get_active_state()
 {
-  return threads_state.at(active_thread);
+  return *threads_state.at(active_thread);
 }
 
 const goto_symex_statet &execution_statet::get_active_state() const
 {
-  return threads_state.at(active_thread);
+  return *threads_state.at(active_thread);
+}
+
+goto_symex_statet &execution_statet::mutable_thread_state(unsigned int tid)
+{
+  std::shared_ptr<goto_symex_statet> &state = threads_state.at(tid);
+  if(
+    state.use_count() > 1 || &state->level2 != state_level2.get() ||
+    &state->value_set != &global_value_set)
+    state = std::make_shared<goto_symex_statet>(
+      *state, *state_level2, global_value_set);
+
+  return *state;
 }
 
 unsigned int execution_statet::get_active_atomic_number()
@@ -389,7 +399,7 @@ void execution_statet::switch_to_thread(unsigned int i)
 {
   last_active_thread = active_thread;
   active_thread = i;
-  cur_state = &threads_state[active_thread];
+  cur_state = &mutable_thread_state(active_thread);
 }
 
 bool execution_statet::dfs_explore_thread(unsigned int tid)
@@ -397,10 +407,10 @@ bool execution_statet::dfs_explore_thread(unsigned int tid)
   if(DFS_traversed.at(tid))
     return false;
 
-  if(threads_state.at(tid).call_stack.empty())
+  if(threads_state.at(tid)->call_stack.empty())
     return false;
 
-  if(threads_state.at(tid).thread_ended)
+  if(threads_state.at(tid)->thread_ended)
     return false;
 
   DFS_traversed.at(tid) = true;
@@ -447,6 +457,7 @@ void execution_statet::update_after_switch_point()
 {
   execute_guard();
   resetDFS_traversed();
+  dpor_backtrack.clear();
 
   // MPOR records the variables accessed in last transition taken; we're
   // starting a new transition, so for the current thread, clear records.
@@ -472,7 +483,7 @@ void execution_statet::preserve_last_paths()
 {
   // If the thread terminated, there are no paths to preserve: this is the final
   // switching away.
-  if(threads_state[last_active_thread].thread_ended)
+  if(threads_state[last_active_thread]->thread_ended)
     return;
 
   // Examine the current execution state and the last insn, deciding which paths
@@ -482,7 +493,7 @@ void execution_statet::preserve_last_paths()
   // need to find the branch that was generated there.
 
   auto &pp = preserved_paths[last_active_thread];
-  auto &ls = threads_state[last_active_thread];
+  auto &ls = mutable_thread_state(last_active_thread);
   assert(pp.size() == 0 && "Unmerged preserved paths in ex_state");
   assert(last_insn != nullptr && "Last insn unset in preserve_last_paths");
 
@@ -567,7 +578,7 @@ void execution_statet::preserve_last_paths()
     // It's unclear how to distinguish this case from an error in this code
     // here.
     // XXX methodise this
-    threads_state[last_active_thread].thread_ended = true;
+    mutable_thread_state(last_active_thread).thread_ended = true;
     atomic_numbers[last_active_thread] = 0;
   }
 }
@@ -680,7 +691,7 @@ void execution_statet::execute_guard()
   if(!pre_goto_guard.is_true())
     parent_guard = pre_goto_guard.as_expr();
   else
-    parent_guard = threads_state[last_active_thread].guard.as_expr();
+    parent_guard = threads_state[last_active_thread]->guard.as_expr();
 
   // If we simplified the global guard expr to false, write that to thread
   // guards, not the symbolic guard name. This is the only way to bail out of
@@ -708,7 +719,7 @@ void execution_statet::execute_guard()
   // acceptable to permit switching).
   if(
     last_active_thread != active_thread &&
-    is_cur_state_guard_false(threads_state[active_thread].guard.as_expr()))
+    is_cur_state_guard_false(threads_state[active_thread]->guard.as_expr()))
     interleaving_unviable = true;
 }
 
@@ -725,7 +736,7 @@ unsigned int execution_statet::add_thread(const goto_programt *prog)
   new_state.source.thread_nr = thread_nr;
   new_state.global_guard.make_true();
   new_state.global_guard.add(get_guard_identifier());
-  threads_state.push_back(new_state);
+  threads_state.push_back(std::make_shared<goto_symex_statet>(new_state));
   preserved_paths.emplace_back();
   atomic_numbers.push_back(0);
 
@@ -739,9 +750,7 @@ unsigned int execution_statet::add_thread(const goto_programt *prog)
   }
 
   thread_start_data.emplace_back();
-
-  // We invalidated all threads_state refs, so reset cur_state ptr.
-  cur_state = &threads_state[active_thread];
+  pending_locks.emplace_back();
 
   // Update MPOR tracking data with newly initialized thread
   thread_last_reads.emplace_back();
@@ -761,7 +770,7 @@ unsigned int execution_statet::add_thread(const goto_programt *prog)
   // While we've recorded the new thread as starting in the designated program,
   // it might not run immediately, thus must have it's path preserved:
   preserved_paths[thread_nr].push_back(std::make_pair(
-    prog->instructions.begin(), goto_statet(threads_state[thread_nr])));
+    prog->instructions.begin(), goto_statet(*threads_state[thread_nr])));
 
   return threads_state.size() - 1; // thread ID, zero based
 }
@@ -839,6 +848,9 @@ void execution_statet::get_expr_globals(
     {
       return;
     }
+    if(art1->race_free_globals.count(symbol->id))
+      return;
+
     if((symbol->static_lifetime || symbol->type.is_dynamic_set()))
     {
       std::list<unsigned int> threadId_list;
@@ -1041,6 +1053,98 @@ void execution_statet::calculate_mpor_constraints()
   dependancy_chain = new_dep_chain;
 }
 
+bool execution_statet::is_thread_enabled(unsigned int tid) const
+{
+  if(tid >= threads_state.size())
+    return false;
+
+  if(
+    threads_state[tid]->call_stack.empty() ||
+    threads_state[tid]->thread_ended)
+    return false;
+
+  return !(tid_is_set && monitor_tid == tid);
+}
+
+void execution_statet::calculate_dpor_backtrack(
+  const std::list<std::shared_ptr<execution_statet>> &trace)
+{
+  assert(trace.back().get() == this);
+  std::vector<execution_statet *> states;
+  states.reserve(trace.size());
+  for(const auto &it : trace)
+    states.push_back(it.get());
+
+  const unsigned int depth = states.size() - 1;
+  const unsigned int p = active_thread;
+
+  // Start from what happened before the previous transition of this thread,
+  // or before the transition that created it.
+  std::vector<unsigned int> clock;
+  for(unsigned int j = depth; j-- > 0;)
+  {
+    if(states[j]->active_thread == p)
+    {
+      clock = states[j]->dpor_clock;
+      break;
+    }
+
+    if(states[j]->threads_state.size() <= p)
+    {
+      clock = states[j + 1]->dpor_clock;
+      break;
+    }
+  }
+
+  bool race_found = false;
+  for(unsigned int j = depth; j-- > 0;)
+  {
+    const execution_statet &ex = *states[j];
+    const unsigned int q = ex.active_thread;
+    if(q == p)
+      continue;
+
+    // Same test as MPOR, between this transition and the one taken in ex
+    bool dependent = false;
+    for(const auto &it : thread_last_writes[p])
+      if(
+        ex.thread_last_writes[q].count(it) || ex.thread_last_reads[q].count(it))
+        dependent = true;
+    for(const auto &it : thread_last_reads[p])
+      if(ex.thread_last_writes[q].count(it))
+        dependent = true;
+
+    if(!dependent)
+      continue;
+
+    bool happens_before = clock.size() > q && clock[q] > j;
+    if(!happens_before && !race_found && j > 0)
+    {
+      // Latest race: the state before ex must also try to run this thread
+      // first. If it couldn't, fall back to every thread it could run.
+      race_found = true;
+      execution_statet &choice = *states[j - 1];
+      if(choice.is_thread_enabled(p))
+        choice.dpor_backtrack.insert(p);
+      else
+        for(unsigned int t = 0; t < choice.threads_state.size(); t++)
+          if(choice.is_thread_enabled(t))
+            choice.dpor_backtrack.insert(t);
+    }
+
+    // Everything that happened before ex now happens before this transition
+    if(clock.size() < ex.dpor_clock.size())
+      clock.resize(ex.dpor_clock.size(), 0);
+    for(unsigned int t = 0; t < ex.dpor_clock.size(); t++)
+      clock[t] = std::max(clock[t], ex.dpor_clock[t]);
+  }
+
+  if(clock.size() <= p)
+    clock.resize(p + 1, 0);
+  clock[p] = depth + 1;
+  dpor_clock = std::move(clock);
+}
+
 bool execution_statet::has_cswitch_point_occured() const
 {
   // Context switches can occur due to being forced, or by global state access
@@ -1058,50 +1162,52 @@ bool execution_statet::has_cswitch_point_occured() const
 
 bool execution_statet::can_execution_continue() const
 {
-  if(threads_state[active_thread].thread_ended)
+  if(threads_state[active_thread]->thread_ended)
     return false;
 
-  if(threads_state[active_thread].call_stack.empty())
+  if(threads_state[active_thread]->call_stack.empty())
     return false;
 
   return true;
 }
 
-crypto_hash execution_statet::generate_hash() const
+fast_hash execution_statet::generate_hash() const
 {
   auto l2 = std::dynamic_pointer_cast<state_hashing_level2t>(state_level2);
   assert(l2 != nullptr);
 
-  crypto_hash state = l2->generate_l2_state_hash();
-  std::string str = state.to_string();
+  fast_hash::digestt state = l2->generate_l2_state_hash();
 
+  fast_hash h;
+  h.ingest(state.data(), sizeof(state));
   for(const auto &it : threads_state)
   {
-    goto_programt::const_targett pc = it.source.pc;
-    int id = pc->location_number;
-    std::stringstream s;
-    s << id;
-    str += "!" + s.str();
+    goto_programt::const_targett pc = it->source.pc;
+    unsigned int id = pc->location_number;
+    h.ingest(&id, sizeof(id));
   }
-
-  crypto_hash h;
-  h.ingest(str.c_str(), str.size());
   h.fin();
 
   return h;
 }
 
-crypto_hash execution_statet::update_hash_for_assignment(const expr2tc &rhs)
+fast_hash::digestt execution_statet::update_hash_for_assignment(
+  const irep_idt &name,
+  const expr2tc &rhs)
 {
-  crypto_hash h;
-  rhs->hash(h);
+  // The value digest is cached in the expression, only the name is new data
+  const fast_hash::digestt &value = rhs->digest();
+  const std::string &str = name.as_string();
+
+  fast_hash h;
+  h.ingest(value.data(), sizeof(value));
+  h.ingest(str.c_str(), str.size());
   h.fin();
-  return h;
+  return h.hash;
 }
 
 void execution_statet::print_stack_traces(unsigned int indent) const
 {
-  std::vector<goto_symex_statet>::const_iterator it;
   std::string spaces = std::string("");
   unsigned int i;
 
@@ -1109,7 +1215,7 @@ void execution_statet::print_stack_traces(unsigned int indent) const
     spaces += " ";
 
   i = 0;
-  for(it = threads_state.begin(); it != threads_state.end(); it++)
+  for(const auto &it : threads_state)
   {
     std::ostringstream oss;
     oss << spaces << "Thread " << i++ << ":"
@@ -1122,7 +1228,7 @@ void execution_statet::print_stack_traces(unsigned int indent) const
 
 void execution_statet::switch_to_monitor()
 {
-  if(threads_state[monitor_tid].thread_ended)
+  if(threads_state[monitor_tid]->thread_ended)
   {
     if(!mon_thread_warning)
     {
@@ -1149,8 +1255,8 @@ void execution_statet::switch_to_monitor()
     // an extremely bad plan.
     last_active_thread = active_thread;
     active_thread = monitor_tid;
-    cur_state = &threads_state[active_thread];
-    cur_state->guard = threads_state[last_active_thread].guard;
+    cur_state = &mutable_thread_state(active_thread);
+    cur_state->guard = threads_state[last_active_thread]->guard;
   }
   else
   {
@@ -1162,7 +1268,7 @@ void execution_statet::switch_away_from_monitor()
 {
   // Occurs when we rerun the automata to discover whether or not the property
   // has been violated or not.
-  if(threads_state[monitor_tid].thread_ended)
+  if(threads_state[monitor_tid]->thread_ended)
     return;
 
   assert(tid_is_set && "Must set monitor thread before switching from mon\n");
@@ -1176,9 +1282,9 @@ void execution_statet::switch_away_from_monitor()
   // an extremely bad plan.
   last_active_thread = active_thread;
   active_thread = monitor_from_tid;
-  cur_state = &threads_state[active_thread];
+  cur_state = &mutable_thread_state(active_thread);
 
-  cur_state->guard = threads_state[monitor_tid].guard;
+  cur_state->guard = threads_state[monitor_tid]->guard;
 
   mon_from_tid = false;
 }
@@ -1189,7 +1295,7 @@ void execution_statet::kill_monitor_thread()
     monitor_tid != active_thread &&
     "You cannot kill monitor thread _from_ the monitor thread\n");
 
-  threads_state[monitor_tid].thread_ended = true;
+  mutable_thread_state(monitor_tid).thread_ended = true;
 }
 
 execution_statet::ex_state_level2t::ex_state_level2t(execution_statet &ref)
@@ -1293,38 +1399,26 @@ void execution_statet::state_hashing_level2t::make_assignment(
   const expr2tc &const_value,
   const expr2tc &assigned_value)
 {
-  //  crypto_hash hash;
-
   renaming::level2t::make_assignment(lhs_sym, const_value, assigned_value);
 
   // If there's no body to the assignment, don't hash.
   if(!is_nil_expr(assigned_value))
   {
     // XXX - consider whether to use l1 names instead. Recursion, reentrancy.
-    crypto_hash hash = owner->update_hash_for_assignment(assigned_value);
-    std::string orig_name = to_symbol2t(lhs_sym).thename.as_string();
-    current_hashes[orig_name] = hash;
+    const irep_idt &orig_name = to_symbol2t(lhs_sym).thename;
+    fast_hash::digestt key =
+      owner->update_hash_for_assignment(orig_name, assigned_value);
+
+    // Swap the key of the overwritten assignment for the new one
+    fast_hash::digestt &slot = current_hashes[orig_name];
+    state_hash[0] ^= slot[0] ^ key[0];
+    state_hash[1] ^= slot[1] ^ key[1];
+    slot = key;
   }
 }
 
-crypto_hash
+fast_hash::digestt
 execution_statet::state_hashing_level2t::generate_l2_state_hash() const
 {
-  unsigned int total;
-  size_t hash_sz = sizeof(crypto_hash::hash);
-
-  uint8_t *data =
-    (uint8_t *)alloca(current_hashes.size() * hash_sz * sizeof(uint8_t));
-
-  total = 0;
-  for(const auto &current_hashe : current_hashes)
-  {
-    memcpy(&data[total * hash_sz], current_hashe.second.hash, hash_sz);
-    total++;
-  }
-
-  crypto_hash c;
-  c.ingest(data, total * hash_sz);
-  c.fin();
-  return c;
+  return state_hash;
 }
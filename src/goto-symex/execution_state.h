@@ -109,7 +109,10 @@ public:
   /**
    *  State-hashing level2t.
    *  When using this level2t, any assignment made is caught, and the symbolic
-   *  names are hashed. This is the primary handler for state hashing.
+   *  names are hashed. This is the primary handler for state hashing. The
+   *  hash of all assignments is maintained Zobrist-style: it is the xor of one
+   *  key per variable, and each assignment swaps the key of the variable it
+   *  overwrites, so it never has to be recomputed from scratch.
    */
   class state_hashing_level2t : public ex_state_level2t
   {
@@ -121,9 +124,11 @@ public:
       expr2tc &lhs_symbol,
       const expr2tc &const_value,
       const expr2tc &assigned_value) override;
-    crypto_hash generate_l2_state_hash() const;
-    typedef std::map<irep_idt, crypto_hash> current_state_hashest;
+    fast_hash::digestt generate_l2_state_hash() const;
+    typedef std::unordered_map<irep_idt, fast_hash::digestt, dstring_hash>
+      current_state_hashest;
     current_state_hashest current_hashes;
+    fast_hash::digestt state_hash = {0, 0};
   };
 
   // Macros
@@ -147,6 +152,17 @@ public:
       DFS_traversed.at(i) = false;
   }
 
+  /** State of thread \p tid, possibly shared with other ex_states */
+  const goto_symex_statet &thread_state(unsigned int tid) const
+  {
+    return *threads_state.at(tid);
+  }
+
+  /** State of thread \p tid, for updating. Copied first if other ex_states
+   *  share it, or if it still refers to the L2 renaming and value set of the
+   *  ex_state it was cloned from. */
+  goto_symex_statet &mutable_thread_state(unsigned int tid);
+
   /** Fetch the thread ID of the current active thread */
   unsigned int get_active_state_number()
   {
@@ -409,6 +425,22 @@ public:
    */
   void calculate_mpor_constraints();
 
+  /**
+   *  Dynamic partial order reduction, after the transition in this state, the
+   *  last one in \p trace, has been taken. Finds the latest transition before
+   *  it that accesses the same data from another thread without happening
+   *  before it, and adds a thread to the backtrack set of the state that
+   *  chose that transition so that the two are also explored the other way
+   *  round. Also records the vector clock of this transition.
+   *  @param trace The execution states from the root to this one.
+   */
+  void calculate_dpor_backtrack(
+    const std::list<std::shared_ptr<execution_statet>> &trace);
+
+  /** Whether thread tid could be switched to from this state, ignoring what
+   *  was explored already. */
+  bool is_thread_enabled(unsigned int tid) const;
+
   /** Accessor method for mpor_schedulable. Ensures its access is within bounds
    *  and is read-only. */
   bool is_transition_blocked_by_mpor() const
@@ -440,20 +472,22 @@ public:
 
   /**
    *  Generate hash of entire execution state.
-   *  This takes all current symbolic assignments to variables contained in the
-   *  l2 renaming object, and their precomputed hashes, concatonates them with
-   *  the current program counter of each thread, and hashes that. This results
-   *  in a full hash of the current execution state.
+   *  This takes the running hash of all current symbolic assignments kept by
+   *  the l2 renaming object, combines it with the current program counter of
+   *  each thread, and hashes that. This results in a full hash of the current
+   *  execution state.
    *  @return Hash of entire current execution state.
    */
-  crypto_hash generate_hash() const;
+  fast_hash generate_hash() const;
 
   /**
-   *  Generate hash of an expression.
-   *  @param rhs Expression to hash.
-   *  @return Hash of passed in expression.
+   *  Generate the Zobrist key of an assignment to a variable.
+   *  @param name Name of the assigned variable.
+   *  @param rhs Expression assigned to it.
+   *  @return Key of the assignment, to be xor'ed into the state hash.
    */
-  crypto_hash update_hash_for_assignment(const expr2tc &rhs);
+  fast_hash::digestt
+  update_hash_for_assignment(const irep_idt &name, const expr2tc &rhs);
 
   /**
    *  Print stack trace of each thread to stdout.
@@ -486,8 +520,11 @@ public:
   /** Pointer to reachability_treet that owns this ex_state */
   reachability_treet *owning_rt;
   /** Stack of thread states. The index into this vector is the thread ID of
-   *  the goto_symex_statet at that location */
-  std::vector<goto_symex_statet> threads_state;
+   *  the goto_symex_statet at that location. A clone shares all of them with
+   *  the ex_state it was cloned from, until either updates them: read them
+   *  through thread_state() and update them through mutable_thread_state().
+   */
+  std::vector<std::shared_ptr<goto_symex_statet>> threads_state;
   /** Preserved paths. After switching out of a thread, only the paths active
    *  at the time the switch occurred are allowed to live, and are stored
    *  here. Format is: for each thread, a list of paths, which are made up
@@ -504,11 +541,23 @@ public:
    *  Every time a context switch is taken, the bool in this vector is set to
    *  true at the corresponding thread IDs index. */
   std::vector<bool> DFS_traversed;
+  /** DPOR backtrack set: the threads that must be switched to from this
+   *  state. Empty until the first switch is decided. */
+  std::set<unsigned int> dpor_backtrack;
+  /** DPOR vector clock of the transition taken in this state: for each
+   *  thread, one more than the depth of its latest transition that happens
+   *  before this one. */
+  std::vector<unsigned int> dpor_clock;
   /** Storage for threading libraries thread start data. See version history
    *  of when this was introduced to fully understand why; essentially this
    *  is a workaround to prevent too much nondeterminism entering into the
    *  thread starting process. */
   std::vector<expr2tc> thread_start_data;
+  /** For each thread blocked in pthread_mutex_lock under --deadlock-check
+   *  with --pthread-intrinsics, whether the mutex was free when it tried to
+   *  take it. Nil while the thread is not waiting for the context switch
+   *  that follows. */
+  std::vector<expr2tc> pending_locks;
   /** Last active thread's ID. */
   unsigned int last_active_thread;
   /** Last executed insn -- sometimes necessary for analysis. */
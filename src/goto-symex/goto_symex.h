@@ -457,6 +457,22 @@ protected:
     const code_function_call2t &func_call,
     reachability_treet &art);
 
+  /**
+   *  Run a pthread mutex operation natively, rather than through its model
+   *  in the C library. Only used with --pthread-intrinsics.
+   *  @param call Function call being performed.
+   *  @param art Reachability tree we're operating on.
+   *  @param symname Name of the function called.
+   *  @return False if this is not a mutex operation we handle, in which case
+   *          the call is symex'd as usual.
+   */
+  bool run_pthread_intrinsic(
+    const code_function_call2t &call,
+    reachability_treet &art,
+    const std::string &symname);
+  /** The lock field of the pthread_mutex_t \p ptr points at, or nil. */
+  expr2tc mutex_lock_field(const expr2tc &ptr);
+
   /** Walk back up stack frame looking for exception handler. */
   bool symex_throw();
 
@@ -882,6 +898,12 @@ protected:
   /** Flag as to whether we're doing a k-induction inductive step.
    *  Corresponds to the option --inductive-step */
   bool inductive_step;
+  /** Flag as to whether pthread mutexes are locked and unlocked natively.
+   *  Corresponds to the option --pthread-intrinsics */
+  bool pthread_intrinsics;
+  /** Case splits of past dereferences, shared by all copies of this object.
+   *  Null unless the option --dereference-cache is given */
+  std::shared_ptr<dereference_cachet> dereference_cache;
   /** Set of dereference state records; this field is used as a mailbox between
    *  the dereference code and the caller, who will inspect the contents after
    *  a call to dereference (in INTERNAL mode) completes. */
@@ -919,6 +941,12 @@ protected:
   void
   dump_internal_state(const std::list<struct internal_item> &data) override;
   bool is_live_variable(const expr2tc &sym) override;
+
+  bool get_offset_bounds(const expr2tc &target, BigInt &lower, BigInt &upper)
+    override;
+
+  /** Bounds on the offsets of the targets last fetched by get_value_set */
+  std::map<expr2tc, std::pair<BigInt, BigInt>> offset_bounds;
 };
 
 #endif
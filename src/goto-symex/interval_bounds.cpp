@@ -0,0 +1,104 @@
+#include <goto-symex/execution_state.h>
+#include <goto-symex/interval_bounds.h>
+#include <goto-symex/reachability_tree.h>
+
+/** Collects the symbols whose address is taken below expr */
+static void collect_address_taken(
+  const expr2tc &expr,
+  std::unordered_set<irep_idt, irep_id_hash> &dest)
+{
+  if(is_nil_expr(expr))
+    return;
+
+  if(is_address_of2t(expr))
+  {
+    expr2tc obj = to_address_of2t(expr).ptr_obj;
+    while(is_member2t(obj) || is_index2t(obj))
+      obj = is_member2t(obj) ? to_member2t(obj).source_value
+                             : to_index2t(obj).source_value;
+    if(is_symbol2t(obj))
+      dest.insert(to_symbol2t(obj).thename);
+  }
+
+  expr->foreach_operand(
+    [&dest](const expr2tc &e) { collect_address_taken(e, dest); });
+}
+
+interval_boundst::interval_boundst(
+  const goto_functionst &goto_functions,
+  const namespacet &ns,
+  const optionst &options,
+  const reachability_treet &_art)
+  : art(_art)
+{
+  // Symex drops the checks these bounds rule out, so they must hold on every
+  // execution: asserts aren't assumed, widening never under-approximates and
+  // arithmetic wraps around
+  optionst sound = options;
+  sound.set_option("interval-analysis-assume-asserts", false);
+  sound.set_option("interval-analysis-extrapolate-under-approximate", false);
+  sound.set_option("interval-analysis-wrapped", true);
+  interval_domaint::set_options(sound);
+  intervals(goto_functions, ns);
+
+  forall_goto_functions(f_it, goto_functions)
+  {
+    forall_goto_program_instructions(it, f_it->second.body)
+    {
+      collect_address_taken(it->code, address_taken);
+      collect_address_taken(it->guard, address_taken);
+    }
+  }
+}
+
+bool interval_boundst::only_locals(const expr2tc &expr) const
+{
+  if(is_nil_expr(expr))
+    return true;
+
+  if(is_dereference2t(expr))
+    return false;
+
+  if(is_symbol2t(expr))
+  {
+    const irep_idt &id = to_symbol2t(expr).thename;
+    const symbolt *sym = art.ns.lookup(id);
+    return sym != nullptr && !sym->static_lifetime && !address_taken.count(id);
+  }
+
+  bool res = true;
+  expr->foreach_operand(
+    [this, &res](const expr2tc &e) { res = res && only_locals(e); });
+  return res;
+}
+
+bool interval_boundst::get_bounds(
+  const expr2tc &expr,
+  BigInt &lower,
+  BigInt &upper) const
+{
+  if(!is_bv_type(expr) || !only_locals(expr))
+    return false;
+
+  const goto_symex_statet &state = art.get_cur_state().get_active_state();
+  integer_intervalt interval;
+  try
+  {
+    const interval_domaint &d = intervals[state.source.pc];
+    if(d.is_bottom())
+      return false;
+    interval = d.get_interval<integer_intervalt>(expr);
+  }
+  catch(const char *)
+  {
+    // No state for this instruction: the analysis never reached it
+    return false;
+  }
+
+  if(!interval.lower_set || !interval.upper_set || interval.is_bottom())
+    return false;
+
+  lower = interval.get_lower();
+  upper = interval.get_upper();
+  return true;
+}
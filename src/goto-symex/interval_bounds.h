@@ -0,0 +1,50 @@
+#ifndef ESBMC_GOTO_SYMEX_INTERVAL_BOUNDS_H
+#define ESBMC_GOTO_SYMEX_INTERVAL_BOUNDS_H
+
+#include <goto-programs/abstract-interpretation/ai.h>
+#include <goto-programs/abstract-interpretation/interval_domain.h>
+#include <pointer-analysis/value_set.h>
+#include <unordered_set>
+#include <util/options.h>
+
+class reachability_treet;
+
+/**
+ * @brief Bounds integers by the intervals the interval analysis finds for
+ * the instruction being executed.
+ *
+ * The value sets ask for bounds on the integers that pointer arithmetic adds
+ * to pointers, so that the offsets those pointers get are bounded rather than
+ * unknown. Dereferences then skip the fields and the bounds checks such an
+ * offset can't reach.
+ *
+ * Globals are never bounded, as other threads may write them between the
+ * point the analysis looks at and the one symex executes. Neither are the
+ * locals whose address is taken, which the analysis doesn't see change when
+ * written through a pointer, by a function without a body or another thread.
+ * The analysis runs with the settings that over-approximate, whatever the
+ * interval-analysis options say.
+ */
+class interval_boundst : public value_sett::integer_boundst
+{
+public:
+  interval_boundst(
+    const goto_functionst &goto_functions,
+    const namespacet &ns,
+    const optionst &options,
+    const reachability_treet &art);
+
+  bool get_bounds(const expr2tc &expr, BigInt &lower, BigInt &upper)
+    const override;
+
+protected:
+  const reachability_treet &art;
+  ait<interval_domaint> intervals;
+  /// Symbols whose address is taken somewhere in the program
+  std::unordered_set<irep_idt, irep_id_hash> address_taken;
+
+  /** Whether all symbols in expr are locals whose address is never taken */
+  bool only_locals(const expr2tc &expr) const;
+};
+
+#endif
@@ -7,10 +7,11 @@
 #undef small // mingw workaround
 #endif
 
+#include <goto-programs/lockset_analysis.h>
 #include <goto-symex/goto_symex.h>
 #include <goto-symex/reachability_tree.h>
 #include <util/config.h>
-#include <util/crypto_hash.h>
+#include <util/fast_hash.h>
 #include <util/expr_util.h>
 #include <util/i2string.h>
 #include <util/message.h>
@@ -41,8 +42,28 @@ reachability_treet::reachability_treet(
   interactive_ileaves = options.get_bool_option("interactive-ileaves");
   schedule = options.get_bool_option("schedule");
   por = !options.get_bool_option("no-por");
+  dpor = options.get_bool_option("dpor") && !schedule;
+  if(dpor)
+    por = false;
   main_thread_ended = false;
   target_template = std::move(target);
+  num_workers = 1;
+  worker_id = 0;
+  split_depth = 0;
+  split_count = 0;
+  split_skipped = false;
+  split_truncated = false;
+
+  if(options.get_bool_option("lockset-analysis"))
+  {
+    lockset_analysist lockset(ns);
+    lockset(goto_functions);
+    race_free_globals = lockset.get_race_free();
+  }
+
+  if(options.get_bool_option("interval-analysis-offsets"))
+    offset_bounds =
+      std::make_unique<interval_boundst>(goto_functions, ns, options, *this);
 }
 
 void reachability_treet::setup_for_new_explore()
@@ -52,6 +73,9 @@ void reachability_treet::setup_for_new_explore()
   execution_states.clear();
 
   has_complete_formula = false;
+  split_count = 0;
+  split_skipped = false;
+  split_truncated = false;
 
   execution_statet *s;
   if(schedule)
@@ -76,6 +100,7 @@ void reachability_treet::setup_for_new_explore()
     schedule_target = nullptr;
   }
 
+  s->global_value_set.integer_bounds = offset_bounds.get();
   execution_states.emplace_back(s);
   cur_state_it = execution_states.begin();
   targ->push_ctx(); // Start with a depth of 1.
@@ -105,9 +130,8 @@ bool reachability_treet::check_for_hash_collision() const
 {
   const execution_statet &ex_state = get_cur_state();
 
-  crypto_hash hash;
-  hash = ex_state.generate_hash();
-  if(hit_hashes.find(hash) != hit_hashes.end())
+  fast_hash hash = ex_state.generate_hash();
+  if(hit_hashes.find(hash.hash) != hit_hashes.end())
     return true;
 
   return false;
@@ -123,9 +147,8 @@ void reachability_treet::update_hash_collision_set()
 {
   execution_statet &ex_state = get_cur_state();
 
-  crypto_hash hash;
-  hash = ex_state.generate_hash();
-  hit_hashes.insert(hash);
+  fast_hash hash = ex_state.generate_hash();
+  hit_hashes.insert(hash.hash);
 }
 
 void reachability_treet::create_next_state()
@@ -136,6 +159,7 @@ void reachability_treet::create_next_state()
   {
     auto new_state = ex_state.clone();
     execution_states.push_back(new_state);
+    split_skipped = false;
 
     /* Make it active, make it follow on from previous state... */
     if(new_state->get_active_state_number() != next_thread_id)
@@ -175,15 +199,34 @@ reachability_treet::decide_ileave_direction(execution_statet &ex_state)
     if(!check_thread_viable(tid, true))
       continue;
 
+    // Once the first switch is taken, DPOR decides what else to explore
+    if(
+      dpor && !ex_state.dpor_backtrack.empty() &&
+      !ex_state.dpor_backtrack.count(tid))
+      continue;
+
     if(!ex_state.dfs_explore_thread(tid))
       continue;
 
+    // Skip the subtrees dealt out to other workers. The current state is the
+    // last one, so the new state would be at depth execution_states.size().
+    if(
+      num_workers > 1 && execution_states.size() == split_depth &&
+      split_count++ % num_workers != worker_id)
+    {
+      split_skipped = true;
+      continue;
+    }
+
 #if 0
     //apply static partial-order reduction
     if (por && !ex_state.is_thread_mpor_schedulable(tid))
       continue;
 #endif
 
+    if(dpor)
+      ex_state.dpor_backtrack.insert(tid);
+
     break;
   }
 
@@ -221,11 +264,12 @@ void reachability_treet::switch_to_next_execution_state()
       if(config.options.get_bool_option("print-stack-traces"))
         print_ileave_trace();
       has_complete_formula = true;
+      split_truncated = split_skipped;
     }
   }
 }
 
-bool reachability_treet::reset_to_unexplored_state()
+bool reachability_treet::reset_to_unexplored_state(bool clear_claims)
 {
   // After executing up to a point where all threads have ended and returning
   // that equation to the caller, free and remove fully explored execution
@@ -247,7 +291,7 @@ bool reachability_treet::reset_to_unexplored_state()
   if(execution_states.size() > 0)
     cur_state_it++;
 
-  if(execution_states.size() != 0)
+  if(execution_states.size() != 0 && clear_claims)
   {
     // When backtracking, erase all the assertions from the equation before
     // continuing forwards. They've all already been checked, in the trace we
@@ -489,14 +533,14 @@ bool reachability_treet::check_thread_viable(unsigned int tid, bool quiet) const
     return false;
   }
 
-  if(ex.threads_state.at(tid).call_stack.empty())
+  if(ex.thread_state(tid).call_stack.empty())
   {
     if(!quiet)
       log_status("Thread unschedulable due to empty call stack");
     return false;
   }
 
-  if(ex.threads_state.at(tid).thread_ended)
+  if(ex.thread_state(tid).thread_ended)
   {
     if(!quiet)
       log_status("That thread has ended");
@@ -526,52 +570,92 @@ reachability_treet::get_next_formula()
 {
   assert(execution_states.size() > 0 && "Must setup RT before exploring");
 
-  while(!is_has_complete_formula())
+  for(;;)
   {
-    while((!get_cur_state().has_cswitch_point_occured() ||
-           get_cur_state().check_if_ileaves_blocked()) &&
-          get_cur_state().can_execution_continue())
-      get_cur_state().symex_step(*this);
-
-    if(state_hashing)
+    while(!is_has_complete_formula())
     {
-      if(check_for_hash_collision())
+      while((!get_cur_state().has_cswitch_point_occured() ||
+             get_cur_state().check_if_ileaves_blocked()) &&
+            get_cur_state().can_execution_continue())
+        get_cur_state().symex_step(*this);
+
+      if(state_hashing)
       {
-        post_hash_collision_cleanup();
-        break;
+        if(check_for_hash_collision())
+        {
+          post_hash_collision_cleanup();
+          break;
+        }
+
+        update_hash_collision_set();
       }
 
-      update_hash_collision_set();
-    }
+      if(por)
+      {
+        get_cur_state().calculate_mpor_constraints();
+        if(get_cur_state().is_transition_blocked_by_mpor())
+          break;
+      }
 
-    if(por)
-    {
-      get_cur_state().calculate_mpor_constraints();
-      if(get_cur_state().is_transition_blocked_by_mpor())
+      if(dpor)
+        get_cur_state().calculate_dpor_backtrack(execution_states);
+
+      next_thread_id = decide_ileave_direction(get_cur_state());
+
+      if(get_cur_state().interleaving_unviable)
         break;
+      create_next_state();
+
+      switch_to_next_execution_state();
     }
 
-    next_thread_id = decide_ileave_direction(get_cur_state());
+    has_complete_formula = false;
 
-    if(get_cur_state().interleaving_unviable)
+    if(owns_current_trace())
       break;
-    create_next_state();
 
-    switch_to_next_execution_state();
+    // Another worker checks this trace, or its continuations. Its claims are
+    // left in place, as this worker did not check them.
+    split_truncated = false;
+    if(!reset_to_unexplored_state(false))
+      return nullptr;
   }
 
   (*cur_state_it)->add_memory_leak_checks();
 
-  has_complete_formula = false;
-
   return get_cur_state().get_symex_result();
 }
 
 bool reachability_treet::setup_next_formula()
 {
+  if(execution_states.empty())
+    return false;
+
   return reset_to_unexplored_state();
 }
 
+bool reachability_treet::owns_current_trace() const
+{
+  if(num_workers == 1 || execution_states.size() > split_depth)
+    return true;
+
+  return worker_id == 0 && !split_truncated;
+}
+
+void reachability_treet::set_worker(unsigned int worker, unsigned int workers)
+{
+  assert(worker < workers);
+  assert(!state_hashing && "Workers would disagree on the pruned states");
+  num_workers = workers;
+  worker_id = worker;
+
+  // Deep enough that there are a few subtrees per worker when at least two
+  // threads can run at each context switch.
+  split_depth = 2;
+  while((1u << (split_depth - 2)) < workers)
+    split_depth++;
+}
+
 std::shared_ptr<goto_symext::symex_resultt>
 reachability_treet::generate_schedule_formula()
 {
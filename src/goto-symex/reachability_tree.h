@@ -5,12 +5,13 @@
 #include <goto-programs/goto_program.h>
 #include <goto-symex/execution_state.h>
 #include <goto-symex/goto_symex.h>
+#include <goto-symex/interval_bounds.h>
 #include <goto-symex/renaming.h>
 #include <goto-symex/symex_target_equation.h>
 
 #include <unordered_map>
 #include <unordered_set>
-#include <util/crypto_hash.h>
+#include <util/fast_hash.h>
 #include <util/message.h>
 #include <util/options.h>
 
@@ -92,9 +93,11 @@ public:
    *  Follows the algorithm described in reachability_treet, and walk back up
    *  the stack of current execution_states to find a context-switch that
    *  hasn't yet been explored.
+   *  @param clear_claims Whether the claims of the states walked back to were
+   *         checked in the trace we leave, and need not be checked again.
    *  @return True if there are more states to be explored
    */
-  bool reset_to_unexplored_state();
+  bool reset_to_unexplored_state(bool clear_claims = true);
 
   /**
    *  Are there more execution_statet s to explore.
@@ -232,6 +235,25 @@ public:
    */
   bool setup_next_formula();
 
+  /**
+   *  Whether the trace just completed is this worker's to check. Traces
+   *  through a state at the split depth belong to whoever owns that subtree,
+   *  and the shorter ones, which every worker meets, to the first worker.
+   *  @return True if the current trace should be solved here
+   */
+  bool owns_current_trace() const;
+
+  /**
+   *  Share the exploration with other processes.
+   *  Every process explores the same tree, but the subtrees rooted at a given
+   *  depth are dealt out among them, and a process skips the subtrees that
+   *  are not its own. All processes explore the states above that depth, so
+   *  they agree on how the subtrees were dealt out.
+   *  @param worker Index of this process, from zero.
+   *  @param workers Number of processes sharing the exploration.
+   */
+  void set_worker(unsigned int worker, unsigned int workers);
+
   /**
    *  Class recording a reachability checkpoint.
    *  Currently likely broken; but this originally redorced a particular trace
@@ -350,8 +372,23 @@ protected:
   unsigned int next_thread_id;
   /** Whether partial-order-reduction is enabled */
   bool por;
+  /** Whether dynamic partial-order-reduction is enabled. Replaces por. */
+  bool dpor;
+  /** Number of processes sharing the exploration, see set_worker */
+  unsigned int num_workers;
+  /** Index of this process among them */
+  unsigned int worker_id;
+  /** Depth of the states whose subtrees are dealt out to the workers */
+  unsigned int split_depth;
+  /** Number of such subtrees met so far */
+  unsigned int split_count;
+  /** Whether a subtree of the last state was left to another worker */
+  bool split_skipped;
+  /** Whether the current trace stops short of the subtrees of other workers,
+   *  which they explore themselves */
+  bool split_truncated;
   /** Set of state hashes we've discovered */
-  std::set<crypto_hash> hit_hashes;
+  std::unordered_set<fast_hash::digestt, fast_hash::digest_hash> hit_hashes;
   /** Flag as to whether we're picking interleaving directions explicitly.
    *  Corresponds to the --interactive-ileaves option. */
   bool interactive_ileaves;
@@ -363,6 +400,12 @@ protected:
   std::unordered_map<expr2tc, std::list<unsigned int>, irep2_hash> vars_map;
   /* associative container that contains global writes in */
   std::unordered_set<expr2tc, irep2_hash> is_global;
+  /* Globals no two threads access concurrently, which need no context
+   * switches. Filled with --lockset-analysis. */
+  std::unordered_set<irep_idt, irep_id_hash> race_free_globals;
+  /* Bounds on the integers added to pointers, given to the value sets of
+   * new execution states. Set with --interval-analysis-offsets. */
+  std::unique_ptr<interval_boundst> offset_bounds;
 
   friend class execution_statet;
   friend void build_goto_symex_classes();
@@ -0,0 +1,399 @@
+#include <goto-symex/ssa_preprocess.h>
+#include <irep2/irep2_utils.h>
+#include <util/config.h>
+#include <util/time_stopping.h>
+
+/// Whether \p e widens a narrower integer without changing its value
+static bool is_extension(const expr2tc &e)
+{
+  if(!is_typecast2t(e) || !is_bv_type(e))
+    return false;
+
+  const expr2tc &from = to_typecast2t(e).from;
+  if(!is_bv_type(from) || from->type->get_width() >= e->type->get_width())
+    return false;
+
+  // Sign extending into an unsigned type wraps negative values around
+  return is_unsignedbv_type(from) || is_signedbv_type(e);
+}
+
+/// Width of the narrowest bit-vector that represents \p v
+static unsigned min_width(const BigInt &v, bool is_signed)
+{
+  if(!v.is_negative())
+    return (v.is_zero() ? 1 : v.floorPow2() + 1) + is_signed;
+
+  BigInt m = -v - 1;
+  return (m.is_zero() ? 0 : m.floorPow2() + 1) + 1;
+}
+
+static bool is_relation(const expr2tc &e)
+{
+  switch(e->expr_id)
+  {
+  case expr2t::equality_id:
+  case expr2t::notequal_id:
+  case expr2t::lessthan_id:
+  case expr2t::lessthanequal_id:
+  case expr2t::greaterthan_id:
+  case expr2t::greaterthanequal_id:
+    return true;
+  default:
+    return false;
+  }
+}
+
+ssa_preprocesst::ssa_preprocesst(const optionst &options)
+  : ssa_step_algorithm(true),
+    eliminate_unconstrained(options.get_bool_option("result-only"))
+{
+}
+
+bool ssa_preprocesst::run(symex_target_equationt::SSA_stepst &steps)
+{
+  fine_timet algorithm_start = current_time();
+
+  // The same pass sees one equation per interleaving, which share nothing
+  subst.clear();
+  shared_rhs.clear();
+  narrow.clear();
+  substituted.clear();
+  defined.clear();
+  uses.clear();
+  pinned.clear();
+  eliminated.clear();
+  num_substituted = num_shared = num_narrowed = num_unconstrained = 0;
+
+  for(auto &step : steps)
+    if(!step.ignore)
+      run_on_step(step);
+
+  if(eliminate_unconstrained)
+  {
+    for(const auto &step : steps)
+      if(!step.ignore && (step.is_assignment() || step.is_renumber()))
+        defined.insert(step.lhs);
+
+    for(const auto &step : steps)
+    {
+      if(step.ignore)
+        continue;
+
+      // Renumbering is left alone, so nothing it mentions may change
+      count_uses(step.guard, step.is_renumber());
+      if(step.is_assignment() && !is_dead_copy(step))
+        count_uses(step.rhs, false);
+      else if(step.is_assume() || step.is_assert())
+        count_uses(step.cond, false);
+      else if(step.is_output())
+        for(const expr2tc &arg : step.output_args)
+          count_uses(arg, false);
+      else if(step.is_renumber())
+      {
+        count_uses(step.lhs, true);
+        count_uses(step.rhs, true);
+      }
+    }
+
+    for(auto &step : steps)
+    {
+      if(step.ignore || step.is_renumber())
+        continue;
+
+      step.guard = eliminate(step.guard);
+      if(step.is_assignment() && !is_dead_copy(step))
+      {
+        step.rhs = eliminate(step.rhs);
+        step.cond = equality2tc(step.lhs, step.rhs);
+      }
+      else if(step.is_assume() || step.is_assert())
+        step.cond = eliminate(step.cond);
+      else if(step.is_output())
+        for(expr2tc &arg : step.output_args)
+          arg = eliminate(arg);
+    }
+  }
+
+  fine_timet algorithm_stop = current_time();
+  log_status(
+    "SSA preprocessing time: {}s ({} substituted, {} shared, {} narrowed, {} "
+    "unconstrained)",
+    time2string(algorithm_stop - algorithm_start),
+    num_substituted,
+    num_shared,
+    num_narrowed,
+    num_unconstrained);
+  return true;
+}
+
+void ssa_preprocesst::run_on_assignment(
+  symex_target_equationt::SSA_stept &step)
+{
+  assert(is_symbol2t(step.lhs));
+  step.guard = substitute(step.guard);
+
+  const expr2tc &lhs = step.lhs;
+  expr2tc rhs = substitute(step.rhs);
+  if(lhs->type == rhs->type)
+  {
+    if(is_constant_expr(rhs) || is_symbol2t(rhs))
+    {
+      subst.emplace(lhs, rhs);
+      ++num_substituted;
+    }
+    else
+    {
+      auto [it, inserted] = shared_rhs.emplace(rhs, lhs);
+      if(!inserted)
+      {
+        // Assigned before: this becomes a copy, and is substituted as such
+        rhs = it->second;
+        subst.emplace(lhs, rhs);
+        ++num_shared;
+      }
+      else if(is_extension(rhs))
+        narrow.emplace(lhs, rhs);
+    }
+  }
+
+  step.rhs = rhs;
+  step.cond = equality2tc(lhs, rhs);
+}
+
+void ssa_preprocesst::run_on_assume(symex_target_equationt::SSA_stept &step)
+{
+  step.guard = substitute(step.guard);
+  step.cond = substitute(step.cond);
+}
+
+void ssa_preprocesst::run_on_assert(symex_target_equationt::SSA_stept &step)
+{
+  step.guard = substitute(step.guard);
+  step.cond = substitute(step.cond);
+}
+
+void ssa_preprocesst::run_on_output(symex_target_equationt::SSA_stept &step)
+{
+  step.guard = substitute(step.guard);
+  for(expr2tc &arg : step.output_args)
+    arg = substitute(arg);
+}
+
+expr2tc ssa_preprocesst::substitute(const expr2tc &e)
+{
+  if(is_nil_expr(e) || is_constant_number(e))
+    return e;
+
+  if(is_symbol2t(e))
+  {
+    auto it = subst.find(e);
+    return it == subst.end() ? e : it->second;
+  }
+
+  // The operand names an object, its value is irrelevant
+  if(is_address_of2t(e))
+    return e;
+
+  auto it = substituted.find(e);
+  if(it != substituted.end())
+    return it->second;
+
+  // Only detach the expression if an operand actually changes
+  bool changed = false;
+  e->foreach_operand([this, &changed](const expr2tc &op) {
+    changed |= substitute(op).get() != op.get();
+  });
+
+  expr2tc res = e;
+  if(changed)
+  {
+    res->Foreach_operand([this](expr2tc &op) { op = substitute(op); });
+    simplify(res);
+  }
+
+  if(is_relation(res))
+    res = narrow_relation(res);
+
+  substituted.emplace(e, res);
+  return res;
+}
+
+expr2tc ssa_preprocesst::narrow_relation(const expr2tc &e)
+{
+  const relation_data &rel = static_cast<const relation_data &>(*e);
+  if(!is_bv_type(rel.side_1) || rel.side_1->type != rel.side_2->type)
+    return e;
+
+  // Each side is either a constant or the extension of a narrower value
+  expr2tc sides[2] = {rel.side_1, rel.side_2};
+  expr2tc exts[2];
+  bool is_signed = false;
+  for(unsigned i = 0; i < 2; i++)
+  {
+    if(is_constant_int2t(sides[i]))
+    {
+      is_signed |= to_constant_int2t(sides[i]).value.is_negative();
+      continue;
+    }
+
+    exts[i] = sides[i];
+    if(is_symbol2t(sides[i]))
+    {
+      auto it = narrow.find(sides[i]);
+      if(it == narrow.end())
+        return e;
+      exts[i] = it->second;
+    }
+
+    if(!is_extension(exts[i]))
+      return e;
+    is_signed |= is_signedbv_type(to_typecast2t(exts[i]).from);
+  }
+
+  if(is_nil_expr(exts[0]) && is_nil_expr(exts[1]))
+    return e;
+
+  // Unsigned values need one more bit when compared as signed ones
+  unsigned width = 0;
+  for(unsigned i = 0; i < 2; i++)
+  {
+    unsigned w;
+    if(is_nil_expr(exts[i]))
+      w = min_width(to_constant_int2t(sides[i]).value, is_signed);
+    else
+    {
+      const expr2tc &from = to_typecast2t(exts[i]).from;
+      w = from->type->get_width() + (is_signed && is_unsignedbv_type(from));
+    }
+    width = std::max(width, w);
+  }
+
+  if(width >= rel.side_1->type->get_width())
+    return e;
+
+  type2tc t = is_signed ? type2tc(signedbv_type2tc(width))
+                        : type2tc(unsignedbv_type2tc(width));
+
+  expr2tc res = e;
+  relation_data &new_rel = static_cast<relation_data &>(*res.get());
+  expr2tc *new_sides[2] = {&new_rel.side_1, &new_rel.side_2};
+  for(unsigned i = 0; i < 2; i++)
+  {
+    if(is_nil_expr(exts[i]))
+    {
+      *new_sides[i] = constant_int2tc(t, to_constant_int2t(sides[i]).value);
+      continue;
+    }
+
+    const typecast2t &cast = to_typecast2t(exts[i]);
+    *new_sides[i] = cast.from->type == t
+                      ? cast.from
+                      : typecast2tc(t, cast.from, cast.rounding_mode);
+  }
+
+  ++num_narrowed;
+  return res;
+}
+
+void ssa_preprocesst::count_uses(const expr2tc &e, bool pin)
+{
+  if(is_nil_expr(e))
+    return;
+
+  // Subterms are only visited once, unless they turn out to be pinned later
+  bool visit = uses[e]++ == 0;
+  if(pin && pinned.insert(e).second)
+    visit = true;
+  if(!visit)
+    return;
+
+  // Overflow checks are about the operation below them, which must stay
+  if(is_overflow2t(e))
+    pinned.insert(to_overflow2t(e).operand);
+  else if(is_overflow_neg2t(e))
+    pinned.insert(to_overflow_neg2t(e).operand);
+
+  // Nothing below an address_of is rewritten
+  bool pin_operands = pin || is_address_of2t(e);
+  e->foreach_operand([this, pin_operands](const expr2tc &op) {
+    count_uses(op, pin_operands);
+  });
+}
+
+bool ssa_preprocesst::is_unconstrained(const expr2tc &e) const
+{
+  if(!is_symbol2t(e) || !is_bv_type(e) || defined.count(e) || pinned.count(e))
+    return false;
+
+  const symbol2t &sym = to_symbol2t(e);
+  if(
+    config.no_slice_names.count(sym.thename.as_string()) ||
+    config.no_slice_ids.count(sym.get_symbol_name()))
+    return false;
+
+  auto it = uses.find(e);
+  return it != uses.end() && it->second == 1;
+}
+
+expr2tc ssa_preprocesst::eliminate(const expr2tc &e)
+{
+  if(
+    is_nil_expr(e) || is_symbol2t(e) || is_constant_number(e) ||
+    is_address_of2t(e))
+    return e;
+
+  auto it = eliminated.find(e);
+  if(it != eliminated.end())
+    return it->second;
+
+  bool changed = false;
+  e->foreach_operand([this, &changed](const expr2tc &op) {
+    changed |= eliminate(op).get() != op.get();
+  });
+
+  expr2tc res = e;
+  if(changed)
+    res->Foreach_operand([this](expr2tc &op) { op = eliminate(op); });
+
+  // An operation that is a bijection in an input only used here takes every
+  // value that input does, so the input can stand for the whole term
+  expr2tc input;
+  if(is_bv_type(res) && !pinned.count(e))
+  {
+    auto pick = [this, &res](const expr2tc &op) {
+      return op->type == res->type && is_unconstrained(op);
+    };
+
+    if(is_add2t(res) || is_sub2t(res))
+    {
+      const arith_2ops &op = static_cast<const arith_2ops &>(*res);
+      input = pick(op.side_1) ? op.side_1 : pick(op.side_2) ? op.side_2 : input;
+    }
+    else if(is_bitxor2t(res))
+    {
+      const bitxor2t &op = to_bitxor2t(res);
+      input = pick(op.side_1) ? op.side_1 : pick(op.side_2) ? op.side_2 : input;
+    }
+    else if(is_neg2t(res) && pick(to_neg2t(res).value))
+      input = to_neg2t(res).value;
+    else if(is_bitnot2t(res) && pick(to_bitnot2t(res).value))
+      input = to_bitnot2t(res).value;
+  }
+
+  if(!is_nil_expr(input))
+  {
+    // The input now occurs wherever the term did
+    uses[input] = uses[e];
+    res = input;
+    ++num_unconstrained;
+  }
+
+  eliminated.emplace(e, res);
+  return res;
+}
+
+bool ssa_preprocesst::is_dead_copy(
+  const symex_target_equationt::SSA_stept &step) const
+{
+  return step.is_assignment() && subst.count(step.lhs);
+}
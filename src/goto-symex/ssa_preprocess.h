@@ -0,0 +1,94 @@
+#ifndef ESBMC_GOTO_SYMEX_SSA_PREPROCESS_H
+#define ESBMC_GOTO_SYMEX_SSA_PREPROCESS_H
+
+#include <goto-symex/symex_target_equation.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <util/algorithms.h>
+#include <util/options.h>
+
+/**
+ * @brief Word-level rewriting of the whole SSA equation before it is
+ * converted.
+ *
+ * Conversion looks at one step at a time, so facts established by one step
+ * never simplify another. This pass runs once over every step that survived
+ * slicing, in program order, and:
+ *
+ *  - substitutes symbols assigned a constant or another symbol into every
+ *    later step, simplifying what that exposes;
+ *  - shares the right-hand side of assignments: a later assignment of an
+ *    identical value becomes a copy of the first one, and is substituted in
+ *    turn;
+ *  - compares values that are extensions of narrower ones at the narrowest
+ *    width that still holds both operands;
+ *  - replaces terms that an unconstrained input makes unconstrained (x + e,
+ *    where x occurs nowhere else) by that input.
+ *
+ * Steps are rewritten but never removed, so the counterexample still shows
+ * every assignment. The last rewrite gives inputs the value of the term they
+ * replaced, though, which no trace, witness or test case could show
+ * consistently, so it only runs with --result-only.
+ */
+class ssa_preprocesst : public ssa_step_algorithm
+{
+public:
+  explicit ssa_preprocesst(const optionst &options);
+
+  bool run(symex_target_equationt::SSA_stepst &) override;
+
+  BigInt ignored() const override
+  {
+    return 0;
+  }
+
+protected:
+  void run_on_assignment(symex_target_equationt::SSA_stept &) override;
+  void run_on_assume(symex_target_equationt::SSA_stept &) override;
+  void run_on_assert(symex_target_equationt::SSA_stept &) override;
+  void run_on_output(symex_target_equationt::SSA_stept &) override;
+
+  typedef std::unordered_map<expr2tc, expr2tc, irep2_hash> expr_mapt;
+
+  /// Whether unconstrained terms may be replaced by their inputs
+  const bool eliminate_unconstrained;
+
+  /// Symbols and the value that replaces them
+  expr_mapt subst;
+  /// First symbol assigned each right-hand side
+  expr_mapt shared_rhs;
+  /// Symbols assigned the extension of a narrower value, and that extension
+  expr_mapt narrow;
+  /// Results of substitute(), by original expression
+  expr_mapt substituted;
+
+  /// Symbols assigned anywhere in the equation
+  std::unordered_set<expr2tc, irep2_hash> defined;
+  /// Number of references to each expression, counting shared subterms once
+  std::unordered_map<expr2tc, unsigned, irep2_hash> uses;
+  /// Expressions that must keep their shape, e.g. operands of overflow2t
+  std::unordered_set<expr2tc, irep2_hash> pinned;
+  /// Results of eliminate(), by original expression
+  expr_mapt eliminated;
+
+  unsigned long num_substituted = 0;
+  unsigned long num_shared = 0;
+  unsigned long num_narrowed = 0;
+  unsigned long num_unconstrained = 0;
+
+  /// Applies #subst and narrows comparisons below \p e
+  expr2tc substitute(const expr2tc &e);
+  expr2tc narrow_relation(const expr2tc &e);
+
+  /// Counts the references to every subterm of \p e into #uses
+  void count_uses(const expr2tc &e, bool pin);
+  /// Replaces unconstrained terms below \p e by their inputs
+  expr2tc eliminate(const expr2tc &e);
+  bool is_unconstrained(const expr2tc &e) const;
+
+  /// Whether \p step is a copy whose left-hand side has been substituted
+  /// away, and so no longer constrains anything
+  bool is_dead_copy(const symex_target_equationt::SSA_stept &step) const;
+};
+
+#endif
@@ -44,7 +44,12 @@ goto_symext::goto_symext(
     k_induction(options.is_kind()),
     base_case(options.get_bool_option("base-case")),
     forward_condition(options.get_bool_option("forward-condition")),
-    inductive_step(options.get_bool_option("inductive-step"))
+    inductive_step(options.get_bool_option("inductive-step")),
+    pthread_intrinsics(options.get_bool_option("pthread-intrinsics")),
+    dereference_cache(
+      options.get_bool_option("dereference-cache")
+        ? std::make_shared<dereference_cachet>()
+        : nullptr)
 {
   const std::string &set = options.get_option("unwindset");
   unsigned int length = set.length();
@@ -105,6 +110,8 @@ goto_symext &goto_symext::operator=(const goto_symext &sym)
   base_case = sym.base_case;
   forward_condition = sym.forward_condition;
   inductive_step = sym.inductive_step;
+  pthread_intrinsics = sym.pthread_intrinsics;
+  dereference_cache = sym.dereference_cache;
   first_loop = sym.first_loop;
 
   valid_ptr_arr_name = sym.valid_ptr_arr_name;
@@ -50,7 +50,19 @@ void symex_dereference_statet::get_value_set(
   value_setst::valuest &value_set)
 {
   // Here we obtain the set of objects via value set analysis.
-  state.value_set.get_value_set(expr, value_set);
+  value_sett::object_mapt object_map;
+  state.value_set.get_value_set(expr, object_map);
+
+  offset_bounds.clear();
+  for(auto it = object_map.begin(); it != object_map.end(); it++)
+  {
+    expr2tc target = state.value_set.to_expr(it);
+    if(!it->second.offset_is_set && it->second.offset_bounded)
+      offset_bounds.emplace(
+        target,
+        std::make_pair(it->second.offset_lower, it->second.offset_upper));
+    value_set.push_back(target);
+  }
 
   // add value set objects during the symbolic execution.
   if(
@@ -111,6 +123,20 @@ void symex_dereference_statet::get_value_set(
   }
 }
 
+bool symex_dereference_statet::get_offset_bounds(
+  const expr2tc &target,
+  BigInt &lower,
+  BigInt &upper)
+{
+  auto it = offset_bounds.find(target);
+  if(it == offset_bounds.end())
+    return false;
+
+  lower = it->second.first;
+  upper = it->second.second;
+  return true;
+}
+
 void symex_dereference_statet::rename(expr2tc &expr)
 {
   goto_symex.cur_state->rename(expr);
@@ -142,7 +168,7 @@ bool symex_dereference_statet::is_live_variable(const expr2tc &symbol)
   // Symbol is renamed to at least level 1, fetch the relevant thread data
   const execution_statet &ex_state = goto_symex.art1->get_cur_state();
   const goto_symex_statet &state =
-    ex_state.threads_state[to_symbol2t(sym).thread_num];
+    ex_state.thread_state(to_symbol2t(sym).thread_num);
 
   // Level one names represent the storage for a variable, and this symbol
   // may have entered pointer tracking at any time the variable had its address
@@ -170,6 +196,7 @@ void goto_symext::dereference(expr2tc &expr, dereferencet::modet mode)
   symex_dereference_statet symex_dereference_state(*this, *cur_state);
 
   dereferencet dereference(ns, new_context, options, symex_dereference_state);
+  dereference.set_cache(dereference_cache.get());
 
   // needs to be renamed to level 1
   assert(!cur_state->call_stack.empty());
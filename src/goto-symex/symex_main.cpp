@@ -272,6 +272,9 @@ void goto_symext::symex_step(reachability_treet &art)
         run_intrinsic(call, art, id.as_string());
         return;
       }
+
+      if(pthread_intrinsics && run_pthread_intrinsic(call, art, id.as_string()))
+        return;
     }
 
     // Don't run a function call if the guard is false.
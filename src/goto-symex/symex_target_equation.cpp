@@ -507,11 +507,11 @@ tvt runtime_encoded_equationt::ask_solver_question(const expr2tc &question)
   // results are true, false, both.
   push_ctx();
   conv.assert_ast(q);
-  smt_convt::resultt res1 = conv.dec_solve();
+  smt_convt::resultt res1 = conv.refined_dec_solve();
   pop_ctx();
   push_ctx();
   conv.assert_ast(conv.invert_ast(q));
-  smt_convt::resultt res2 = conv.dec_solve();
+  smt_convt::resultt res2 = conv.refined_dec_solve();
   pop_ctx();
 
   // So; which result?
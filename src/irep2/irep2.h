@@ -30,6 +30,7 @@
 #include <util/compiler_defs.h>
 #include <util/crypto_hash.h>
 #include <util/dstring.h>
+#include <util/fast_hash.h>
 #include <util/irep.h>
 #include <vector>
 
@@ -257,6 +258,8 @@ public:
     detach();
     T *tmp = std::shared_ptr<T>::get();
     tmp->crc_val = 0;
+    tmp->digest_val = {0, 0};
+    tmp->interned = false;
     return tmp;
   }
 
@@ -289,6 +292,7 @@ public:
 
   using std::shared_ptr<T>::operator bool;
   using std::shared_ptr<T>::reset;
+  using std::shared_ptr<T>::use_count;
 
   friend void swap(irep_container &a, irep_container &b)
   {
@@ -340,6 +344,10 @@ public:
     if(!a || !b)
       return false;
 
+    // Two distinct nodes of the hash-consing table are never equal
+    if(a->interned && b->interned)
+      return false;
+
     return *a == *b; // different pointees could still compare equal
   }
 
@@ -454,7 +462,8 @@ protected:
   type2t(type_ids id);
 
   /** Copy constructor */
-  type2t(const type2t &ref) = default;
+  type2t(const type2t &ref);
+  type2t &operator=(const type2t &ref);
 
   virtual void foreach_subtype_impl_const(const_subtype_delegate &t) const = 0;
   virtual void foreach_subtype_impl(subtype_delegate &t) = 0;
@@ -576,6 +585,21 @@ public:
    */
   virtual void hash(crypto_hash &hash) const;
 
+  /** Produce a 128-bit digest of the current object.
+   *  Computed on first use from the fields of this type and the digests of
+   *  its subtypes, then cached like the crc. As subtypes contribute their
+   *  cached digest, only the nodes that changed are rehashed.
+   *  @see digest_fields
+   *  @return Digest of the current type.
+   */
+  const fast_hash::digestt &digest() const;
+
+  /** Feed the fields of this type into a digest. Subtypes contribute their
+   *  own digest rather than their contents.
+   *  @param hash Object to accumulate digest data into.
+   */
+  virtual void digest_fields(fast_hash &hash) const;
+
   /** Clone method. Self explanatory.
    *  @return New container, containing a duplicate of this object.
    */
@@ -601,6 +625,13 @@ public:
   type_ids type_id;
 
   mutable size_t crc_val;
+
+  /** Cached result of digest(), all zeroes until computed. */
+  mutable fast_hash::digestt digest_val;
+
+  /** Whether this is the canonical node of the hash-consing table. Copies
+   *  never inherit it. */
+  bool interned;
 };
 
 /** Fetch identifying name for a type.
@@ -761,6 +792,22 @@ public:
    */
   virtual void hash(crypto_hash &hash) const;
 
+  /** Calculate a 128-bit digest of the current expr.
+   *  Like crc, but wide enough to stand for the expression in hash sets of
+   *  whole states. Computed from the fields of this expr and the cached
+   *  digests of its type and operands, so rehashing after a change only
+   *  visits the modified nodes.
+   *  @see digest_fields
+   *  @return Digest of this expr
+   */
+  const fast_hash::digestt &digest() const;
+
+  /** Feed the fields of this expr into a digest. Operands and types
+   *  contribute their own digest rather than their contents.
+   *  @param hash Object to accumulate digest data into.
+   */
+  virtual void digest_fields(fast_hash &hash) const;
+
   /** Fetch a sub-operand.
    *  These can come out of any field that is an expr2tc, or contains them.
    *  No particular numbering order is promised.
@@ -856,8 +903,60 @@ public:
   type2tc type;
 
   mutable size_t crc_val;
+
+  /** Cached result of digest(), all zeroes until computed. */
+  mutable fast_hash::digestt digest_val;
+
+  /** Whether this is the canonical node of the hash-consing table. Copies
+   *  never inherit it. */
+  bool interned;
 };
 
+/** Opt-in hash-consing of irep2 terms.
+ *  While enabled, every expr2t and type2t built through the something2tc
+ *  factory functions is interned in a global unique table: structurally equal
+ *  terms are represented by one shared node, built bottom-up so that
+ *  duplicated subterms are stored once too. Equality between two interned
+ *  nodes is then a pointer comparison and their crc is computed only once.
+ *
+ *  The table holds a reference to each canonical node, thus the copy-on-write
+ *  detach of irep_container always clones an interned node before it gets
+ *  modified; the clone is not interned. The table is sharded and each shard
+ *  is protected by its own mutex, so terms may be built concurrently.
+ */
+namespace irep2_hash_cons
+{
+extern bool enabled;
+
+void enable();
+/** Disable interning and drop the table. Nodes already shared stay valid. */
+void disable();
+
+expr2tc do_intern(expr2tc &&e);
+type2tc do_intern(type2tc &&t);
+
+inline expr2tc intern(expr2tc &&e)
+{
+  if(!enabled || !e)
+    return std::move(e);
+  return do_intern(std::move(e));
+}
+
+inline type2tc intern(type2tc &&t)
+{
+  if(!enabled || !t)
+    return std::move(t);
+  return do_intern(std::move(t));
+}
+
+/** Release the canonical nodes nobody but the table refers to anymore.
+ *  @return Number of nodes released. */
+size_t collect();
+
+/** Log the size of the table and its hit rate. */
+void print_stats();
+} // namespace irep2_hash_cons
+
 inline bool is_nil_expr(const expr2tc &exp)
 {
   return exp.get() == nullptr;
@@ -1152,6 +1251,7 @@ public:
   int lt(const base2t &ref) const override;
   size_t do_crc() const override;
   void hash(crypto_hash &hash) const override;
+  void digest_fields(fast_hash &hash) const override;
 
 protected:
   // Fetch the type information about the field we are concerned with out
@@ -1169,6 +1269,7 @@ protected:
   int lt_rec(const base2t &ref) const;
   void do_crc_rec() const;
   void hash_rec(crypto_hash &hash) const;
+  void digest_rec(fast_hash &hash) const;
 
   // These methods are specific to expressions rather than types, and are
   // placed here to avoid un-necessary recursion in expr_methods2.
@@ -1245,6 +1346,11 @@ protected:
     (void)hash;
   }
 
+  void digest_rec(fast_hash &hash) const
+  {
+    (void)hash;
+  }
+
   const expr2tc *
   get_sub_expr_rec(unsigned int cur_idx, unsigned int desired) const
   {
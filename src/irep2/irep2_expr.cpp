@@ -122,12 +122,16 @@ static_assert(
 /*************************** Base expr2t definitions **************************/
 
 expr2t::expr2t(const type2tc &_type, expr_ids id)
-  : expr_id(id), type(_type), crc_val(0)
+  : expr_id(id), type(_type), crc_val(0), digest_val{0, 0}, interned(false)
 {
 }
 
 expr2t::expr2t(const expr2t &ref)
-  : expr_id(ref.expr_id), type(ref.type), crc_val(ref.crc_val)
+  : expr_id(ref.expr_id),
+    type(ref.type),
+    crc_val(ref.crc_val),
+    digest_val(ref.digest_val),
+    interned(false)
 {
 }
 
@@ -205,6 +209,30 @@ void expr2t::hash(crypto_hash &hash) const
   type->hash(hash);
 }
 
+const fast_hash::digestt &expr2t::digest() const
+{
+  if(digest_val[0] != 0 || digest_val[1] != 0)
+    return digest_val;
+
+  // The expr id field is skipped by the field walk, record it here
+  fast_hash hash;
+  uint8_t eid = expr_id;
+  hash.ingest(&eid, sizeof(eid));
+  digest_fields(hash);
+  hash.fin();
+
+  // All zeroes marks an uncomputed digest
+  if(hash.hash[0] == 0 && hash.hash[1] == 0)
+    hash.hash[0] = 1;
+  digest_val = hash.hash;
+  return digest_val;
+}
+
+void expr2t::digest_fields(fast_hash &hash) const
+{
+  hash.ingest(type->digest().data(), sizeof(fast_hash::digestt));
+}
+
 std::string get_expr_id(const expr2t &expr)
 {
   return std::string(expr_names[expr.expr_id]);
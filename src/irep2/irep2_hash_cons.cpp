@@ -0,0 +1,204 @@
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <unordered_set>
+#include <utility>
+#include <irep2/irep2_expr.h>
+#include <irep2/irep2_type.h>
+#include <util/message.h>
+
+namespace irep2_hash_cons
+{
+bool enabled = false;
+
+namespace
+{
+template <class T>
+bool is_interned(const irep_container<T> &c)
+{
+  return c && c->interned;
+}
+
+template <class container>
+struct container_hash
+{
+  size_t operator()(const container &c) const
+  {
+    return c.crc();
+  }
+};
+
+/** Unique table of canonical nodes. Terms are distributed over the shards by
+ *  their crc, each shard being guarded by its own lock. */
+template <class T>
+class unique_tablet
+{
+public:
+  typedef irep_container<T> container;
+  static constexpr size_t num_shards = 64;
+
+  container intern(container &&c)
+  {
+    size_t h = c.crc();
+    shard &s = shards[(h ^ (h >> 17)) % num_shards];
+    std::lock_guard guard(s.lock);
+    auto it = s.table.find(c);
+    if(it != s.table.end())
+    {
+      hits.fetch_add(1, std::memory_order_relaxed);
+      return *it;
+    }
+
+    misses.fetch_add(1, std::memory_order_relaxed);
+    // Nobody else holds this fresh node yet, so flagging it is safe
+    const_cast<T *>(std::as_const(c).get())->interned = true;
+    return *s.table.insert(std::move(c)).first;
+  }
+
+  size_t collect()
+  {
+    size_t released = 0;
+    for(shard &s : shards)
+    {
+      std::lock_guard guard(s.lock);
+      for(auto it = s.table.begin(); it != s.table.end();)
+      {
+        if(it->use_count() == 1)
+        {
+          it = s.table.erase(it);
+          ++released;
+        }
+        else
+          ++it;
+      }
+    }
+    return released;
+  }
+
+  void clear()
+  {
+    for(shard &s : shards)
+    {
+      std::lock_guard guard(s.lock);
+      // The nodes may outlive the table, they must not claim to be canonical
+      for(const container &c : s.table)
+        const_cast<T *>(c.get())->interned = false;
+      s.table.clear();
+    }
+  }
+
+  size_t size()
+  {
+    size_t total = 0;
+    for(shard &s : shards)
+    {
+      std::lock_guard guard(s.lock);
+      total += s.table.size();
+    }
+    return total;
+  }
+
+  std::atomic_size_t hits = 0;
+  std::atomic_size_t misses = 0;
+
+private:
+  struct shard
+  {
+    std::mutex lock;
+    std::unordered_set<container, container_hash<container>> table;
+  };
+
+  std::array<shard, num_shards> shards;
+};
+
+unique_tablet<expr2t> &expr_table()
+{
+  static unique_tablet<expr2t> table;
+  return table;
+}
+
+unique_tablet<type2t> &type_table()
+{
+  static unique_tablet<type2t> table;
+  return table;
+}
+} // namespace
+
+void enable()
+{
+  enabled = true;
+}
+
+void disable()
+{
+  enabled = false;
+  expr_table().clear();
+  type_table().clear();
+}
+
+type2tc do_intern(type2tc &&t)
+{
+  if(is_interned(t))
+    return std::move(t);
+
+  // Canonicalise the subtypes first: equality of the candidate against the
+  // nodes already in the table then boils down to pointer comparisons.
+  if(t.use_count() == 1)
+    t.get()->Foreach_subtype([](type2tc &sub) {
+      if(sub && !is_interned(sub))
+        sub = do_intern(std::move(sub));
+    });
+
+  return type_table().intern(std::move(t));
+}
+
+expr2tc do_intern(expr2tc &&e)
+{
+  if(is_interned(e))
+    return std::move(e);
+
+  if(e.use_count() == 1)
+  {
+    expr2t *ptr = e.get();
+    if(ptr->type && !is_interned(ptr->type))
+      ptr->type = do_intern(std::move(ptr->type));
+
+    ptr->Foreach_operand([](expr2tc &op) {
+      if(op && !is_interned(op))
+        op = do_intern(std::move(op));
+    });
+  }
+
+  return expr_table().intern(std::move(e));
+}
+
+size_t collect()
+{
+  // Releasing a parent drops the last reference to its operands, repeat
+  // until a fixpoint is reached.
+  size_t total = 0, released;
+  do
+  {
+    released = expr_table().collect() + type_table().collect();
+    total += released;
+  } while(released != 0);
+  return total;
+}
+
+void print_stats()
+{
+  auto rate = [](size_t hits, size_t misses) {
+    size_t total = hits + misses;
+    return total ? (100.0 * hits) / total : 0.0;
+  };
+
+  unique_tablet<expr2t> &et = expr_table();
+  unique_tablet<type2t> &tt = type_table();
+  log_status(
+    "Hash-consing: {} exprs ({:.1f}% hits), {} types ({:.1f}% hits)",
+    et.size(),
+    rate(et.hits, et.misses),
+    tt.size(),
+    rate(tt.hits, tt.misses));
+}
+} // namespace irep2_hash_cons
@@ -201,6 +201,18 @@ void esbmct::irep_methods2<derived, baseclass, traits, enable, fields>::hash(
   hash_rec(hash); // _includes_ type_id / expr_id
 }
 
+template <
+  class derived,
+  class baseclass,
+  typename traits,
+  typename enable,
+  typename fields>
+void esbmct::irep_methods2<derived, baseclass, traits, enable, fields>::
+  digest_fields(fast_hash &hash) const
+{
+  digest_rec(hash);
+}
+
 // The, *actual* recursive defs
 
 template <
@@ -309,6 +321,22 @@ void esbmct::irep_methods2<derived, baseclass, traits, enable, fields>::
   superclass::hash_rec(hash);
 }
 
+template <
+  class derived,
+  class baseclass,
+  typename traits,
+  typename enable,
+  typename fields>
+void esbmct::irep_methods2<derived, baseclass, traits, enable, fields>::
+  digest_rec(fast_hash &hash) const
+{
+  const derived *derived_this = static_cast<const derived *>(this);
+  auto m_ptr = membr_ptr::value;
+  do_type_digest(derived_this->*m_ptr, hash);
+
+  superclass::digest_rec(hash);
+}
+
 template <
   class derived,
   class baseclass,
@@ -174,3 +174,33 @@ void do_type_hash(const type2t::type_ids &, crypto_hash &);
 size_t do_type_crc(const expr2t::expr_ids &i);
 
 void do_type_hash(const expr2t::expr_ids &, crypto_hash &);
+
+void do_type_digest(const bool &thebool, fast_hash &hash);
+
+void do_type_digest(const unsigned int &theval, fast_hash &hash);
+
+void do_type_digest(const sideeffect_data::allockind &theval, fast_hash &hash);
+
+void do_type_digest(const symbol_data::renaming_level &theval, fast_hash &hash);
+
+void do_type_digest(const BigInt &theint, fast_hash &hash);
+
+void do_type_digest(const fixedbvt &theval, fast_hash &hash);
+
+void do_type_digest(const ieee_floatt &theval, fast_hash &hash);
+
+void do_type_digest(const std::vector<expr2tc> &theval, fast_hash &hash);
+
+void do_type_digest(const std::vector<type2tc> &theval, fast_hash &hash);
+
+void do_type_digest(const std::vector<irep_idt> &theval, fast_hash &hash);
+
+void do_type_digest(const expr2tc &theval, fast_hash &hash);
+
+void do_type_digest(const type2tc &theval, fast_hash &hash);
+
+void do_type_digest(const irep_idt &theval, fast_hash &hash);
+
+void do_type_digest(const type2t::type_ids &, fast_hash &);
+
+void do_type_digest(const expr2t::expr_ids &, fast_hash &);
@@ -47,10 +47,29 @@ std::string get_type_id(const type2t &type)
   return std::string(type_names[type.type_id]);
 }
 
-type2t::type2t(type_ids id) : type_id(id), crc_val(0)
+type2t::type2t(type_ids id)
+  : type_id(id), crc_val(0), digest_val{0, 0}, interned(false)
 {
 }
 
+type2t::type2t(const type2t &ref)
+  : irep2t(ref),
+    type_id(ref.type_id),
+    crc_val(ref.crc_val),
+    digest_val(ref.digest_val),
+    interned(false)
+{
+}
+
+type2t &type2t::operator=(const type2t &ref)
+{
+  type_id = ref.type_id;
+  crc_val = ref.crc_val;
+  digest_val = ref.digest_val;
+  interned = false;
+  return *this;
+}
+
 bool type2t::operator==(const type2t &ref) const
 {
   return cmpchecked(ref);
@@ -126,6 +145,30 @@ void type2t::hash(crypto_hash &hash) const
   hash.ingest(&tid, sizeof(tid));
 }
 
+const fast_hash::digestt &type2t::digest() const
+{
+  if(digest_val[0] != 0 || digest_val[1] != 0)
+    return digest_val;
+
+  // The type id field is skipped by the field walk, record it here
+  fast_hash hash;
+  uint8_t tid = type_id;
+  hash.ingest(&tid, sizeof(tid));
+  digest_fields(hash);
+  hash.fin();
+
+  // All zeroes marks an uncomputed digest
+  if(hash.hash[0] == 0 && hash.hash[1] == 0)
+    hash.hash[0] = 1;
+  digest_val = hash.hash;
+  return digest_val;
+}
+
+void type2t::digest_fields(fast_hash &hash) const
+{
+  (void)hash;
+}
+
 unsigned int bool_type2t::get_width() const
 {
   // For the purpose of the byte representating memory model
@@ -309,8 +309,8 @@ public:
   template <typename... Args>                                                  \
   inline type2tc basename##_type2tc(Args &&...args)                            \
   {                                                                            \
-    return type2tc(std::static_pointer_cast<type2t>(                           \
-      std::make_shared<basename##_type2t>(std::forward<Args>(args)...)));      \
+    return irep2_hash_cons::intern(type2tc(std::static_pointer_cast<type2t>(   \
+      std::make_shared<basename##_type2t>(std::forward<Args>(args)...))));     \
   }                                                                            \
   typedef esbmct::                                                             \
     type_methods2<basename##_type2t, superclass, superclass::traits>           \
@@ -608,3 +608,113 @@ void do_type_hash(const expr2t::expr_ids &, crypto_hash &)
 {
   // Dummy field crc
 }
+
+void do_type_digest(const bool &thebool, fast_hash &hash)
+{
+  uint8_t tval = thebool ? 1 : 0;
+  hash.ingest(&tval, sizeof(tval));
+}
+
+void do_type_digest(const unsigned int &theval, fast_hash &hash)
+{
+  hash.ingest(&theval, sizeof(theval));
+}
+
+void do_type_digest(const sideeffect_data::allockind &theval, fast_hash &hash)
+{
+  hash.ingest(&theval, sizeof(theval));
+}
+
+void do_type_digest(const symbol_data::renaming_level &theval, fast_hash &hash)
+{
+  hash.ingest(&theval, sizeof(theval));
+}
+
+void do_type_digest(const BigInt &theint, fast_hash &hash)
+{
+  uint8_t positive = theint.is_positive();
+  hash.ingest(&positive, sizeof(positive));
+
+  // Machine-sized magnitudes are the common case, avoid the dump for them
+  if(theint.is_uint64())
+  {
+    uint64_t val = theint.to_uint64();
+    hash.ingest(&val, sizeof(val));
+    return;
+  }
+
+  std::array<unsigned char, 256> buffer;
+  if(theint.dump(buffer.data(), buffer.size()))
+    hash.ingest(buffer.data(), buffer.size());
+  // As for crypto hashes, larger values are left out of the digest
+}
+
+void do_type_digest(const fixedbvt &theval, fast_hash &hash)
+{
+  hash.ingest(&theval.spec.width, sizeof(theval.spec.width));
+  hash.ingest(&theval.spec.integer_bits, sizeof(theval.spec.integer_bits));
+  do_type_digest(theval.get_value(), hash);
+}
+
+void do_type_digest(const ieee_floatt &theval, fast_hash &hash)
+{
+  do_type_digest(theval.pack(), hash);
+}
+
+void do_type_digest(const std::vector<expr2tc> &theval, fast_hash &hash)
+{
+  size_t size = theval.size();
+  hash.ingest(&size, sizeof(size));
+  for(auto const &it : theval)
+    do_type_digest(it, hash);
+}
+
+void do_type_digest(const std::vector<type2tc> &theval, fast_hash &hash)
+{
+  size_t size = theval.size();
+  hash.ingest(&size, sizeof(size));
+  for(auto const &it : theval)
+    do_type_digest(it, hash);
+}
+
+void do_type_digest(const std::vector<irep_idt> &theval, fast_hash &hash)
+{
+  size_t size = theval.size();
+  hash.ingest(&size, sizeof(size));
+  for(auto const &it : theval)
+    do_type_digest(it, hash);
+}
+
+void do_type_digest(const expr2tc &theval, fast_hash &hash)
+{
+  static const fast_hash::digestt nil_digest = {0, 0};
+  const fast_hash::digestt &d =
+    theval.get() != nullptr ? theval->digest() : nil_digest;
+  hash.ingest(d.data(), sizeof(d));
+}
+
+void do_type_digest(const type2tc &theval, fast_hash &hash)
+{
+  static const fast_hash::digestt nil_digest = {0, 0};
+  const fast_hash::digestt &d =
+    theval.get() != nullptr ? theval->digest() : nil_digest;
+  hash.ingest(d.data(), sizeof(d));
+}
+
+void do_type_digest(const irep_idt &theval, fast_hash &hash)
+{
+  const std::string &str = theval.as_string();
+  size_t size = str.size();
+  hash.ingest(&size, sizeof(size));
+  hash.ingest(str.c_str(), size);
+}
+
+void do_type_digest(const type2t::type_ids &, fast_hash &)
+{
+  // Dummy field digest
+}
+
+void do_type_digest(const expr2t::expr_ids &, fast_hash &)
+{
+  // Dummy field digest
+}
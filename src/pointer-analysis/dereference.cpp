@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cassert>
 #include <langapi/language_util.h>
 #include <pointer-analysis/dereference.h>
@@ -479,6 +480,22 @@ expr2tc dereferencet::dereference(
 
   dereference_callback.get_value_set(src, points_to_set);
 
+  if(cache != nullptr && !is_internal(mode) && recording == nullptr)
+    return cached_case_split(
+      src, points_to_set, type, guard, mode, lexical_offset);
+
+  return build_case_split(
+    src, points_to_set, type, guard, mode, lexical_offset);
+}
+
+expr2tc dereferencet::build_case_split(
+  const expr2tc &src,
+  const value_setst::valuest &points_to_set,
+  const type2tc &type,
+  const guardt &guard,
+  modet mode,
+  const expr2tc &lexical_offset)
+{
   // now build big case split
   // only "good" objects
 
@@ -542,6 +559,92 @@ expr2tc dereferencet::dereference(
   return value;
 }
 
+static void
+replace_failed_symbols(expr2tc &expr, const std::map<expr2tc, expr2tc> &fresh)
+{
+  if(is_nil_expr(expr))
+    return;
+
+  auto it = fresh.find(expr);
+  if(it != fresh.end())
+  {
+    expr = it->second;
+    return;
+  }
+
+  expr->Foreach_operand(
+    [&fresh](expr2tc &e) { replace_failed_symbols(e, fresh); });
+}
+
+expr2tc dereferencet::cached_case_split(
+  const expr2tc &src,
+  const value_setst::valuest &points_to_set,
+  const type2tc &type,
+  const guardt &guard,
+  modet mode,
+  const expr2tc &lexical_offset)
+{
+  dereference_cachet::keyt key;
+  key.points_to.assign(points_to_set.begin(), points_to_set.end());
+  for(const expr2tc &target : points_to_set)
+  {
+    // An empty range stands for no bounds
+    BigInt lower(1), upper(0);
+    dereference_callback.get_offset_bounds(target, lower, upper);
+    key.offset_bounds.emplace_back(lower, upper);
+  }
+  key.src = src;
+  key.type = type;
+  key.mode = (unsigned(mode.op) << 1) | mode.unaligned;
+  key.lexical_offset = lexical_offset;
+
+  // A split that asked about the liveness of some variable only stands for
+  // as long as the answer doesn't change.
+  auto it = cache->entries.find(key);
+  bool hit = it != cache->entries.end();
+  if(hit)
+  {
+    for(const auto &[sym, live] : it->second.liveness)
+      hit &= dereference_callback.is_live_variable(sym) == live;
+  }
+
+  if(!hit)
+  {
+    // Build the split under a trivial guard, recording its side effects
+    dereference_cachet::entryt entry;
+    recording = &entry;
+    entry.value = build_case_split(
+      src, points_to_set, type, guardt(), mode, lexical_offset);
+    recording = nullptr;
+    it =
+      cache->entries.insert_or_assign(std::move(key), std::move(entry)).first;
+  }
+
+  const dereference_cachet::entryt &entry = it->second;
+
+  // Failed symbols are free values of their own, so a reused split gets new
+  // ones. Those made just now are still fresh.
+  std::map<expr2tc, expr2tc> fresh;
+  if(hit)
+  {
+    for(const expr2tc &sym : entry.failed_symbols)
+      fresh.emplace(sym, make_failed_symbol(sym->type));
+  }
+
+  for(const dereference_cachet::failuret &f : entry.failures)
+  {
+    expr2tc cond = f.guard.as_expr();
+    replace_failed_symbols(cond, fresh);
+    guardt tmp_guard(guard);
+    tmp_guard.add(cond);
+    dereference_failure(f.error_class, f.error_name, tmp_guard);
+  }
+
+  expr2tc value = entry.value;
+  replace_failed_symbols(value, fresh);
+  return value;
+}
+
 expr2tc dereferencet::make_failed_symbol(const type2tc &out_type)
 {
   type2tc the_type = out_type;
@@ -565,6 +668,10 @@ expr2tc dereferencet::make_failed_symbol(const type2tc &out_type)
   // appears in the symbol table.
   expr2tc value;
   migrate_expr(symbol_expr(*s), value);
+
+  if(recording != nullptr)
+    recording->failed_symbols.push_back(value);
+
   return value;
 }
 
@@ -625,6 +732,7 @@ expr2tc dereferencet::build_reference_to(
 {
   expr2tc value;
   pointer_guard = gen_false_expr();
+  bounded_offset = expr2tc();
 
   if(is_unknown2t(what) || is_invalid2t(what))
   {
@@ -708,6 +816,14 @@ expr2tc dereferencet::build_reference_to(
     }
     final_offset =
       pointer_offset2tc(get_int_type(config.ansi_c.address_width), deref_expr);
+
+    // The value set may bound the offset into this particular object
+    if(dereference_callback.get_offset_bounds(
+         what, bounded_lower, bounded_upper))
+    {
+      bounded_offset = final_offset;
+      bounded_alignment = alignment;
+    }
   }
 
   type2tc offset_type = bitsize_type2();
@@ -724,6 +840,13 @@ expr2tc dereferencet::build_reference_to(
   if(!is_nil_expr(lexical_offset))
     final_offset = add2tc(final_offset->type, final_offset, lexical_offset);
 
+  // An offset bounded to a single value is as good as a constant one
+  BigInt lower, upper;
+  if(
+    !is_constant_int2t(final_offset) &&
+    offset_bounds(final_offset, lower, upper) && lower == upper)
+    final_offset = constant_int2tc(final_offset->type, lower);
+
   // If we're in internal mode, collect all of our data into one struct, insert
   // it into the list of internal data, and then bail. The caller does not want
   // to have a reference built at all.
@@ -1094,6 +1217,13 @@ void dereferencet::construct_from_array(
   expr2tc mod = modulus2tc(offset->type, offset, subtype_sz_expr);
   simplify(mod);
 
+  // Known bounds may pin the access down to one place within the elements
+  BigInt lower, upper;
+  if(
+    !is_constant_int2t(mod) && offset_bounds(mod, lower, upper) &&
+    lower == upper)
+    mod = constant_int2tc(mod->type, lower);
+
   if(is_structure_type(arr_subtype))
   {
     value = index2tc(arr_subtype, value, div);
@@ -1379,6 +1509,9 @@ void dereferencet::construct_from_dyn_struct_offset(
   // if-then-else chain based on those guards.
   std::list<std::pair<expr2tc, expr2tc>> extract_list;
 
+  BigInt lower, upper;
+  bool bounded = offset_bounds(offset, lower, upper);
+
   unsigned int i = 0;
   for(auto const &it : struct_type.members)
   {
@@ -1387,6 +1520,13 @@ void dereferencet::construct_from_dyn_struct_offset(
     // Compute some kind of guard
     BigInt field_size = type_byte_size_bits(it);
 
+    // Skip the fields that the offset can't reach
+    if(bounded && (upper < offs || lower >= offs + field_size))
+    {
+      i++;
+      continue;
+    }
+
     // Round up to word size
     expr2tc field_offset = constant_int2tc(offset->type, offs);
     expr2tc field_top = constant_int2tc(offset->type, offs + field_size);
@@ -1868,11 +2008,197 @@ void dereferencet::construct_struct_ref_from_dyn_offs_rec(
 
 /**************************** Dereference utilities ***************************/
 
+/** Whether all values from lower to upper are representable in type */
+static bool
+fits_type(const type2tc &type, const BigInt &lower, const BigInt &upper)
+{
+  if(!is_bv_type(type))
+    return false;
+
+  unsigned int width = type->get_width();
+  if(is_signedbv_type(type))
+  {
+    BigInt max = power(2, width - 1);
+    return lower >= -max && upper < max;
+  }
+
+  return lower >= 0 && upper < power(2, width);
+}
+
+bool dereferencet::offset_bounds(
+  const expr2tc &offset,
+  BigInt &lower,
+  BigInt &upper) const
+{
+  if(is_constant_int2t(offset))
+  {
+    lower = upper = to_constant_int2t(offset).value;
+    return true;
+  }
+
+  if(!is_nil_expr(bounded_offset) && offset == bounded_offset)
+  {
+    lower = bounded_lower;
+    upper = bounded_upper;
+    return true;
+  }
+
+  if(is_typecast2t(offset))
+  {
+    // Only follow casts that keep the value
+    const expr2tc &from = to_typecast2t(offset).from;
+    return is_bv_type(from) && offset_bounds(from, lower, upper) &&
+           fits_type(offset->type, lower, upper);
+  }
+
+  if(is_add2t(offset) || is_sub2t(offset) || is_mul2t(offset))
+  {
+    const arith_2ops &arith = dynamic_cast<const arith_2ops &>(*offset);
+    BigInt l1, u1, l2, u2;
+    if(
+      !offset_bounds(arith.side_1, l1, u1) ||
+      !offset_bounds(arith.side_2, l2, u2))
+      return false;
+
+    if(is_add2t(offset))
+    {
+      lower = l1 + l2;
+      upper = u1 + u2;
+    }
+    else if(is_sub2t(offset))
+    {
+      lower = l1 - u2;
+      upper = u1 - l2;
+    }
+    else
+    {
+      const BigInt products[] = {l1 * l2, l1 * u2, u1 * l2, u1 * u2};
+      lower = *std::min_element(std::begin(products), std::end(products));
+      upper = *std::max_element(std::begin(products), std::end(products));
+    }
+
+    // Don't follow arithmetic that may wrap around
+    return fits_type(offset->type, lower, upper);
+  }
+
+  if(is_div2t(offset) || is_modulus2t(offset))
+  {
+    const arith_2ops &arith = dynamic_cast<const arith_2ops &>(*offset);
+    if(!is_constant_int2t(arith.side_2))
+      return false;
+
+    const BigInt &m = to_constant_int2t(arith.side_2).value;
+    BigInt l, u;
+    if(m <= 0 || !offset_bounds(arith.side_1, l, u) || l < 0)
+      return false;
+
+    if(is_div2t(offset))
+    {
+      lower = l / m;
+      upper = u / m;
+      return true;
+    }
+
+    BigInt residue;
+    if(l / m == u / m)
+    {
+      lower = l % m;
+      upper = u % m;
+    }
+    else if(offset_residue(arith.side_1, m, residue))
+      lower = upper = residue;
+    else
+    {
+      lower = 0;
+      upper = m - 1;
+    }
+    return true;
+  }
+
+  return false;
+}
+
+bool dereferencet::offset_residue(
+  const expr2tc &offset,
+  const BigInt &m,
+  BigInt &residue) const
+{
+  // Only reason about expressions that don't wrap around
+  BigInt lower, upper;
+  if(!offset_bounds(offset, lower, upper))
+    return false;
+
+  if(lower == upper)
+  {
+    residue = ((lower % m) + m) % m;
+    return true;
+  }
+
+  if(offset == bounded_offset)
+  {
+    // The offset is a multiple of its alignment
+    if(bounded_alignment == 0 || BigInt(bounded_alignment) % m != 0)
+      return false;
+    residue = 0;
+    return true;
+  }
+
+  if(is_typecast2t(offset))
+    return offset_residue(to_typecast2t(offset).from, m, residue);
+
+  if(is_add2t(offset) || is_sub2t(offset))
+  {
+    const arith_2ops &arith = dynamic_cast<const arith_2ops &>(*offset);
+    BigInt r1, r2;
+    if(
+      !offset_residue(arith.side_1, m, r1) ||
+      !offset_residue(arith.side_2, m, r2))
+      return false;
+
+    residue = is_add2t(offset) ? (r1 + r2) % m : (r1 - r2 + m) % m;
+    return true;
+  }
+
+  if(is_mul2t(offset))
+  {
+    const mul2t &mul = to_mul2t(offset);
+    const expr2tc &k_expr = is_constant_int2t(mul.side_2) ? mul.side_2
+                                                          : mul.side_1;
+    const expr2tc &x = is_constant_int2t(mul.side_2) ? mul.side_1
+                                                     : mul.side_2;
+    if(!is_constant_int2t(k_expr))
+      return false;
+
+    BigInt k = to_constant_int2t(k_expr).value;
+    BigInt r;
+    if(k > 0 && m % k == 0 && offset_residue(x, m / k, r))
+    {
+      // x = q * m/k + r, so x * k = q * m + r * k
+      residue = r * k;
+      return true;
+    }
+    if(offset_residue(x, m, r))
+    {
+      residue = (((r * k) % m) + m) % m;
+      return true;
+    }
+  }
+
+  return false;
+}
+
 void dereferencet::dereference_failure(
   const std::string &error_class,
   const std::string &error_name,
   const guardt &guard)
 {
+  // Assertions met while building a cached split are replayed on each use
+  if(recording != nullptr)
+  {
+    recording->failures.push_back({error_class, error_name, guard});
+    return;
+  }
+
   // This just wraps dereference failure in a no-pointer-check check.
   if(!options.get_bool_option("no-pointer-check") && !block_assertions)
     dereference_callback.dereference_failure(error_class, error_name, guard);
@@ -2158,7 +2484,11 @@ void dereferencet::valid_check(
       // Otherwise, this is a pointer to some kind of lexical variable, with
       // either global or function-local scope. Ask symex to determine if
       // it's live.
-      if(!dereference_callback.is_live_variable(symbol))
+      bool live = dereference_callback.is_live_variable(symbol);
+      if(recording != nullptr)
+        recording->liveness.emplace_back(symbol, live);
+
+      if(!live)
       {
         // Any access where this guard is true -> failure
         dereference_failure(
@@ -2233,6 +2563,15 @@ void dereferencet::bounds_check(
     if(arr_type.size_is_infinite)
       return;
 
+    // Nor are there when the bounds on the offset keep the access inside.
+    BigInt lower, upper;
+    BigInt arr_bits = to_constant_int2t(arr_type.array_size).value *
+                      type_byte_size_bits(arr_type.subtype);
+    if(
+      offset_bounds(offset, lower, upper) && lower >= 0 &&
+      upper + access_size * 8 <= arr_bits)
+      return;
+
     // Secondly, try to calc the size of the array.
     expr2tc subtype_size =
       constant_int2tc(size_type2(), type_byte_size(arr_type.subtype));
@@ -2327,7 +2666,12 @@ void dereferencet::check_data_obj_access(
   expr2tc add = add2tc(access_sz_e->type, offset, access_sz_e);
   expr2tc gt = greaterthan2tc(add, data_sz_e);
 
-  if(!options.get_bool_option("no-bounds-check"))
+  // No need to check accesses that the bounds on the offset keep inside
+  BigInt lower, upper;
+  bool in_bounds = offset_bounds(offset, lower, upper) && lower >= 0 &&
+                   upper + access_sz <= data_sz;
+
+  if(!options.get_bool_option("no-bounds-check") && !in_bounds)
   {
     guardt tmp_guard = guard;
     tmp_guard.add(gt);
@@ -1,8 +1,10 @@
 #ifndef CPROVER_POINTER_ANALYSIS_DEREFERENCE_H
 #define CPROVER_POINTER_ANALYSIS_DEREFERENCE_H
 
+#include <map>
 #include <pointer-analysis/value_sets.h>
 #include <set>
+#include <tuple>
 #include <util/expr.h>
 #include <util/guard.h>
 #include <util/namespace.h>
@@ -132,6 +134,20 @@ public:
   {
   }
 
+  /** Fetch bounds on the offset of a target of the last value set fetched,
+   *  when that offset isn't statically known.
+   *  @param target Object descriptor from the last call to get_value_set.
+   *  @param lower Least offset of the pointer into the object, in bytes.
+   *  @param upper Greatest offset of the pointer into the object, in bytes.
+   *  @return True when lower and upper were set. */
+  virtual bool get_offset_bounds(
+    const expr2tc &target [[maybe_unused]],
+    BigInt &lower [[maybe_unused]],
+    BigInt &upper [[maybe_unused]])
+  {
+    return false;
+  }
+
   struct internal_item
   {
     expr2tc object;
@@ -154,6 +170,62 @@ public:
   virtual bool is_live_variable(const expr2tc &sym) = 0;
 };
 
+/** Case splits built by dereferencet::dereference, kept across dereferences.
+ *  Dereferences are performed on level 1 names, so dereferencing the same
+ *  pointer with an unchanged value set (i.e., in the next loop iteration)
+ *  builds the very same case split. Each entry holds the split as built
+ *  under a trivial guard, with the assertions and liveness queries it made;
+ *  a hit replays those under the new guard and draws fresh failed symbols.
+ */
+class dereference_cachet
+{
+public:
+  struct keyt
+  {
+    std::vector<expr2tc> points_to;
+    /** Bounds on the offset of each target, if any */
+    std::vector<std::pair<BigInt, BigInt>> offset_bounds;
+    expr2tc src;
+    type2tc type;
+    /** The access mode, as op << 1 | unaligned */
+    unsigned mode;
+    expr2tc lexical_offset;
+
+    bool operator<(const keyt &ref) const
+    {
+      return std::tie(
+               points_to, offset_bounds, src, type, mode, lexical_offset) <
+             std::tie(
+               ref.points_to,
+               ref.offset_bounds,
+               ref.src,
+               ref.type,
+               ref.mode,
+               ref.lexical_offset);
+    }
+  };
+
+  struct failuret
+  {
+    std::string error_class;
+    std::string error_name;
+    /** Guard of the assertion, relative to that of the dereference */
+    guardt guard;
+  };
+
+  struct entryt
+  {
+    expr2tc value;
+    std::vector<failuret> failures;
+    /** Variables whose liveness was asked, and the answer given */
+    std::vector<std::pair<expr2tc, bool>> liveness;
+    /** Failed symbols made while building the split */
+    std::vector<expr2tc> failed_symbols;
+  };
+
+  std::map<keyt, entryt> entries;
+};
+
 /** Class containing expression dereference logic.
  *  This class doesn't actually store any state, in that all the side-effects
  *  of what it does are either returned to the caller, or passed through the
@@ -180,7 +252,10 @@ public:
       new_context(_new_context),
       options(_options),
       dereference_callback(_dereference_callback),
-      block_assertions(false)
+      block_assertions(false),
+      cache(nullptr),
+      recording(nullptr),
+      bounded_alignment(0)
   {
     is_big_endian =
       (config.ansi_c.endianess == configt::ansi_ct::IS_BIG_ENDIAN);
@@ -287,6 +362,28 @@ private:
   std::list<dereference_callbackt::internal_item> internal_items;
   /** Flag for discarding all assertions encoded. */
   bool block_assertions;
+  /** Case splits to reuse, if any. */
+  dereference_cachet *cache;
+  /** Cache entry being built, which side effects are recorded into. */
+  dereference_cachet::entryt *recording;
+  /** Offset of the pointer into the object a reference is being built to,
+   *  when the value set bounds it: between bounded_lower and bounded_upper
+   *  bytes, aligned to bounded_alignment bytes. Nil otherwise. */
+  expr2tc bounded_offset;
+  BigInt bounded_lower;
+  BigInt bounded_upper;
+  unsigned int bounded_alignment;
+
+  /** Bound an offset expression, through the bounds on bounded_offset.
+   *  @return True when lower and upper were set. */
+  bool
+  offset_bounds(const expr2tc &offset, BigInt &lower, BigInt &upper) const;
+
+  /** Find the remainder of dividing a non-negative offset expression by m,
+   *  through the alignment of bounded_offset.
+   *  @return True when residue was set. */
+  bool
+  offset_residue(const expr2tc &offset, const BigInt &m, BigInt &residue) const;
 
   /** Interpret an expression that modifies the guard. i.e., an 'if' or a
    *  piece of logic that can be short-circuited.
@@ -358,6 +455,26 @@ private:
    */
   expr2tc make_failed_symbol(const type2tc &out_type);
 
+  /** Build the if-then-else chain over the given points-to set, selecting a
+   *  reference to each object the dereferenced pointer may point at. */
+  expr2tc build_case_split(
+    const expr2tc &src,
+    const value_setst::valuest &points_to_set,
+    const type2tc &type,
+    const guardt &guard,
+    modet mode,
+    const expr2tc &lexical_offset);
+
+  /** As build_case_split, but look the split up in the cache first, and
+   *  store it there when it has to be built. */
+  expr2tc cached_case_split(
+    const expr2tc &src,
+    const value_setst::valuest &points_to_set,
+    const type2tc &type,
+    const guardt &guard,
+    modet mode,
+    const expr2tc &lexical_offset);
+
   /** Try to build a reference to a data object. When we have a data object that
    *  a pointer (might) point at and need an expression to access it, this
    *  performs the require juggling. Some very strange approaches may come out
@@ -535,6 +652,11 @@ public:
   {
     block_assertions = false;
   }
+
+  void set_cache(dereference_cachet *c)
+  {
+    cache = c;
+  }
 };
 
 #endif
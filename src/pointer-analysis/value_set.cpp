@@ -77,6 +77,9 @@ void value_sett::output(std::ostream &out) const
 
         if(o_it->second.offset_is_set)
           result += integer2string(o_it->second.offset) + "";
+        else if(o_it->second.offset_bounded)
+          result += "[" + integer2string(o_it->second.offset_lower) + ", " +
+                    integer2string(o_it->second.offset_upper) + "]";
         else
           result += "*";
 
@@ -657,6 +660,33 @@ void value_sett::get_value_set_rec(
         }
       }
 
+      // Bounds on a the offset added, if any are known
+      BigInt offs_lower, offs_upper;
+      bool offs_bounded = false;
+      if(is_const)
+      {
+        offs_lower = offs_upper = total_offs;
+        offs_bounded = true;
+      }
+      else
+      {
+        // Arithmetic on void pointers and integers counts in bytes
+        BigInt elem_size = 1;
+        try
+        {
+          if(!is_nil_type(subtype) && !is_empty_type(subtype))
+            elem_size = type_byte_size_default(ns.follow(subtype), 0);
+        }
+        catch(const type2t::symbolic_type_excp &e)
+        {
+          elem_size = 0;
+        }
+
+        if(elem_size != 0)
+          offs_bounded = get_offset_bounds(
+            non_ptr_op, elem_size, is_sub2t(expr), offs_lower, offs_upper);
+      }
+
       // For each object, update its offset data according to the integer
       // offset to this expr. Potential outcomes are keeping it nondet, making
       // it nondet, or calculating a new static offset.
@@ -713,6 +743,9 @@ void value_sett::get_value_set_rec(
             std::min(nat_align, object.offset_alignment);
         }
 
+        add_offset_bounds(
+          object, it.second, offs_bounded, offs_lower, offs_upper);
+
         // Once updated, store object reference into destination map.
         insert(dest, it.first, object);
       }
@@ -879,6 +912,13 @@ void value_sett::get_reference_set_rec(const expr2tc &expr, object_mapt &dest)
 
           o.offset_alignment = std::min(index_align, old_align);
           o.offset_is_set = false;
+
+          BigInt lower = index_offset, upper = index_offset;
+          bool bounded =
+            has_const_index_offset ||
+            (type_byte_size_default(index.type, 0) != 0 &&
+             get_offset_bounds(index.index, m, false, lower, upper));
+          add_offset_bounds(o, a_it.second, bounded, lower, upper);
         }
 
         insert(dest, object, o);
@@ -925,6 +965,9 @@ void value_sett::get_reference_set_rec(const expr2tc &expr, object_mapt &dest)
         // of this. Also the same for references to indexes?
         if(o.offset_is_set)
           o.offset += offset_in_bytes;
+        else
+          add_offset_bounds(
+            o, it.second, true, offset_in_bytes, offset_in_bytes);
 
         insert(dest, object, o);
       }
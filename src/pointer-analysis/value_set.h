@@ -52,6 +52,7 @@ public:
   /** Primary constructor. Does approximately nothing non-standard. */
   explicit value_sett(const namespacet &_ns)
     : location_number(0),
+      integer_bounds(nullptr),
       ns(_ns),
       xchg_name("value_sett::__ESBMC_xchg_ptr"),
       xchg_num(0)
@@ -60,6 +61,7 @@ public:
 
   value_sett(const value_sett &ref)
     : location_number(ref.location_number),
+      integer_bounds(ref.integer_bounds),
       values(ref.values),
       ns(ref.ns),
       xchg_name("value_sett::__ESBMC_xchg_ptr"),
@@ -70,6 +72,7 @@ public:
   value_sett &operator=(const value_sett &ref)
   {
     location_number = ref.location_number;
+    integer_bounds = ref.integer_bounds;
     values = ref.values;
     xchg_name = ref.xchg_name;
     xchg_num = ref.xchg_num;
@@ -83,6 +86,20 @@ public:
   /** A type for a set of expressions */
   typedef std::set<expr2tc> expr_sett;
 
+  /** Source of bounds on the integer expressions that pointer arithmetic
+   *  adds to pointers, such as the results of an interval analysis. */
+  class integer_boundst
+  {
+  public:
+    virtual ~integer_boundst() = default;
+
+    /** Bound the value of an integer expression at the current point of
+     *  execution.
+     *  @return True when lower and upper were set. */
+    virtual bool
+    get_bounds(const expr2tc &expr, BigInt &lower, BigInt &upper) const = 0;
+  };
+
   /** Record for an object reference. Any reference to an object is stored as
    *  an objectt, as a map element in an object_mapt. The actual object that
    *  this refers to is determined by the /key/ of this objectt in the
@@ -138,6 +155,12 @@ public:
      *  to the array element edges.
      *  Units are bytes. Zero means N/A. */
     unsigned int offset_alignment;
+    /** Whether the offset, when not statically known, is known to lie
+     *  between offset_lower and offset_upper. Units are bytes. Only ever set
+     *  when the value set has integer_bounds. */
+    bool offset_bounded = false;
+    BigInt offset_lower;
+    BigInt offset_upper;
     bool offset_is_zero() const
     {
       return offset_is_set && offset.is_zero();
@@ -370,6 +393,7 @@ public:
       // guarenteed by them.
       unsigned long old_align = offset2align(expr_obj, old.offset);
       unsigned long new_align = offset2align(expr_obj, object.offset);
+      merge_offset_bounds(old, object);
       old.offset_is_set = false;
       old.offset_alignment = std::min(old_align, new_align);
       return true;
@@ -378,12 +402,13 @@ public:
     if(!old.offset_is_set)
     {
       unsigned int oldalign = old.offset_alignment;
+      bool bounds_changed = merge_offset_bounds(old, object);
       if(!object.offset_is_set)
       {
         // Both object offsets not set; update alignment to minimum of the two
         old.offset_alignment =
           std::min(old.offset_alignment, object.offset_alignment);
-        return !(old.offset_alignment == oldalign);
+        return bounds_changed || !(old.offset_alignment == oldalign);
       }
 
       // Old offset unset; new offset set. Compute the alignment of the
@@ -391,16 +416,106 @@ public:
       // alignment.
       unsigned int new_alignment = offset2align(expr_obj, object.offset);
       old.offset_alignment = std::min(old.offset_alignment, new_alignment);
-      return !(old.offset_alignment == oldalign);
+      return bounds_changed || !(old.offset_alignment == oldalign);
     }
 
     // Old offset alignment is set; new isn't.
     unsigned int old_align = offset2align(expr_obj, old.offset);
+    merge_offset_bounds(old, object);
     old.offset_alignment = std::min(old_align, object.offset_alignment);
     old.offset_is_set = false;
     return true;
   }
 
+  /** Bound the offset of old so that it also covers that of object, ahead
+   *  of the two records being merged into one with an unknown offset.
+   *  @return True when the bounds of old changed. */
+  bool merge_offset_bounds(objectt &old, const objectt &object) const
+  {
+    auto lower = [](const objectt &o) {
+      return o.offset_is_set ? o.offset : o.offset_lower;
+    };
+    auto upper = [](const objectt &o) {
+      return o.offset_is_set ? o.offset : o.offset_upper;
+    };
+
+    bool was_bounded = !old.offset_is_set && old.offset_bounded;
+    if(
+      integer_bounds == nullptr ||
+      !(old.offset_is_set || old.offset_bounded) ||
+      !(object.offset_is_set || object.offset_bounded))
+    {
+      old.offset_bounded = false;
+      return was_bounded;
+    }
+
+    BigInt new_lower = std::min(lower(old), lower(object));
+    BigInt new_upper = std::max(upper(old), upper(object));
+    bool changed = !was_bounded || new_lower != old.offset_lower ||
+                   new_upper != old.offset_upper;
+    old.offset_bounded = true;
+    old.offset_lower = new_lower;
+    old.offset_upper = new_upper;
+    return changed;
+  }
+
+  /** Bound the offset of a record after some amount between lower and upper
+   *  bytes was added to its offset.
+   *  @param after The record after the addition.
+   *  @param before The record before the addition.
+   *  @param bounded Whether the amount added is bounded at all. */
+  void add_offset_bounds(
+    objectt &after,
+    const objectt &before,
+    bool bounded,
+    const BigInt &lower,
+    const BigInt &upper) const
+  {
+    after.offset_bounded = false;
+    if(after.offset_is_set || !bounded || integer_bounds == nullptr)
+      return;
+
+    if(before.offset_is_set)
+    {
+      after.offset_lower = before.offset + lower;
+      after.offset_upper = before.offset + upper;
+    }
+    else if(before.offset_bounded)
+    {
+      after.offset_lower = before.offset_lower + lower;
+      after.offset_upper = before.offset_upper + upper;
+    }
+    else
+      return;
+
+    after.offset_bounded = true;
+  }
+
+  /** Bound an integer expression that is added to a pointer, scaled by the
+   *  size of the pointed-to elements, through integer_bounds if any. */
+  bool get_offset_bounds(
+    const expr2tc &expr,
+    const BigInt &elem_size,
+    bool negate,
+    BigInt &lower,
+    BigInt &upper) const
+  {
+    if(
+      integer_bounds == nullptr ||
+      !integer_bounds->get_bounds(expr, lower, upper))
+      return false;
+
+    lower *= elem_size;
+    upper *= elem_size;
+    if(negate)
+    {
+      BigInt tmp = lower;
+      lower = -upper;
+      upper = -tmp;
+    }
+    return true;
+  }
+
   bool
   insert(object_mapt &dest, const expr2tc &expr, const objectt &object) const
   {
@@ -653,6 +768,9 @@ public:
   //********************************** Members ***********************************
   /** Some crazy static analysis tool. */
   unsigned location_number;
+  /** Bounds on the integers added to pointers, to bound the offsets that
+   *  aren't statically known. Optional. */
+  const integer_boundst *integer_bounds;
   /** Object to assign numbers to objects -- i.e., the numbers in the map of
    *  a @ref object_mapt. Static and bad. */
   static object_numberingt object_numbering;
@@ -1,539 +1,408 @@
-#include <set>
-#include <bitblast_conv.h>
+#include <solvers/sat/bitblast_conv.h>
+#include <util/mp_arith.h>
 
 bitblast_convt::bitblast_convt(
-  bool int_encoding,
   const namespacet &_ns,
+  const optionst &options,
   sat_iface *_sat_api)
-  : smt_convt(int_encoding, _ns), sat_api(_sat_api)
+  : smt_convt(_ns, options), sat_api(_sat_api)
 {
+  if(options.get_bool_option("int-encoding"))
+  {
+    log_error("The SAT backend does not support integer encoding mode");
+    abort();
+  }
 }
 
-bitblast_convt::~bitblast_convt()
+void bitblast_convt::assert_ast(smt_astt a)
 {
+  assert(a->sort->id == SMT_SORT_BOOL);
+  sat_api->assert_lit(bits(a)[0]);
 }
 
-void bitblast_convt::assert_ast(smt_astt a)
+smt_astt bitblast_convt::mk_bvadd(smt_astt a, smt_astt b)
 {
-  assert(a->sort->id == SMT_SORT_BOOL);
-  const bitblast_smt_ast *ba = bitblast_ast_downcast(a);
-  sat_api->assert_lit(ba->bv[0]);
-  return;
+  bvt res;
+  literalt carry_out;
+  full_adder(bits(a), bits(b), res, const_literal(false), carry_out);
+  return new_ast(std::move(res), a->sort);
 }
 
-smt_astt bitblast_convt::mk_func_app(
-  smt_sortt ressort,
-  smt_func_kind f,
-  const smt_ast *const *_args,
-  unsigned int numargs)
+smt_astt bitblast_convt::mk_bvsub(smt_astt a, smt_astt b)
 {
-  const bitblast_smt_ast *args[4];
-  bitblast_smt_ast *result = NULL;
-  unsigned int i;
+  bvt res;
+  literalt carry_out;
+  bvt op1 = bits(b);
+  invert(op1);
+  full_adder(bits(a), op1, res, const_literal(true), carry_out);
+  return new_ast(std::move(res), a->sort);
+}
 
-  assert(numargs < 4 && "Too many arguments to bitblast_convt::mk_func_app");
-  for(i = 0; i < numargs; i++)
-    args[i] = bitblast_ast_downcast(_args[i]);
+smt_astt bitblast_convt::mk_bvmul(smt_astt a, smt_astt b)
+{
+  // The low half of the product doesn't depend on the signedness
+  bvt res;
+  unsigned_multiplier(bits(a), bits(b), res);
+  return new_ast(std::move(res), a->sort);
+}
 
-  switch(f)
-  {
-  case SMT_FUNC_EQ:
-  {
-    assert(ressort->id == SMT_SORT_BOOL);
-    result = mk_ast_equality(args[0], args[1], ressort);
-    break;
-  }
-  case SMT_FUNC_NOTEQ:
-  {
-    assert(ressort->id == SMT_SORT_BOOL);
-    result = mk_ast_equality(args[0], args[1], ressort);
-    result->bv[0] = sat_api->lnot(result->bv[0]);
-    break;
-  }
-  case SMT_FUNC_NOT:
-  {
-    literalt res = sat_api->lnot(args[0]->bv[0]);
-    result = new_ast(ressort);
-    result->bv.push_back(res);
-    break;
-  }
-  case SMT_FUNC_OR:
-  {
-    literalt res = sat_api->lor(args[0]->bv[0], args[1]->bv[0]);
-    result = new_ast(ressort);
-    result->bv.push_back(res);
-    break;
-  }
-  case SMT_FUNC_IMPLIES:
-  {
-    result = new_ast(ressort);
-    result->bv.push_back(sat_api->limplies(args[0]->bv[0], args[1]->bv[0]));
-    break;
-  }
-  case SMT_FUNC_ITE:
-  {
-    if(ressort->id == SMT_SORT_ARRAY)
-    {
-      return _args[1]->ite(this, _args[0], _args[2]);
-    }
-    else
-    {
-      assert(args[1]->bv.size() == args[2]->bv.size());
-      result = new_ast(ressort);
-      for(unsigned int i = 0; i < args[1]->bv.size(); i++)
-        result->bv.push_back(
-          sat_api->lselect(args[0]->bv[0], args[1]->bv[i], args[2]->bv[i]));
-    }
-    break;
-  }
-  case SMT_FUNC_AND:
-  {
-    result = new_ast(ressort);
-    result->bv.push_back(sat_api->land(args[0]->bv[0], args[1]->bv[0]));
-    break;
-  }
-  case SMT_FUNC_XOR:
-  {
-    result = new_ast(ressort);
-    result->bv.push_back(sat_api->lxor(args[0]->bv[0], args[1]->bv[0]));
-    break;
-  }
-  case SMT_FUNC_BVADD:
-  {
-    literalt carry_in = const_literal(false);
-    literalt carry_out;
-    result = new_ast(ressort);
-    full_adder(args[0]->bv, args[1]->bv, result->bv, carry_in, carry_out);
-    break;
-  }
-  case SMT_FUNC_BVSUB:
-  {
-    literalt carry_in = const_literal(true);
-    literalt carry_out;
-    result = new_ast(ressort);
-    bvt op1 = args[1]->bv;
-    invert(op1);
-    full_adder(args[0]->bv, op1, result->bv, carry_in, carry_out);
-    break;
-  }
-  case SMT_FUNC_BVUGT:
-  {
-    // Same as LT flipped
-    smt_astt args2[2];
-    args2[0] = _args[1];
-    args2[1] = _args[0];
-    return mk_func_app(ressort, SMT_FUNC_BVULT, args2, 2);
-  }
-  case SMT_FUNC_BVUGTE:
-  {
-    // This is the negative of less-than
-    smt_astt a = mk_func_app(ressort, SMT_FUNC_BVULT, _args, 2);
-    a = mk_func_app(ressort, SMT_FUNC_NOT, &a, 1);
-    return a;
-  }
-  case SMT_FUNC_BVULT:
-  {
-    result = new_ast(ressort);
-    result->bv.push_back(unsigned_less_than(args[0]->bv, args[1]->bv));
-    break;
-  }
-  case SMT_FUNC_BVULTE:
-  {
-    result = new_ast(ressort);
-    result->bv.push_back(lt_or_le(true, args[0]->bv, args[1]->bv, false));
-    break;
-  }
-  case SMT_FUNC_BVSGTE:
-  {
-    // This is the negative of less-than
-    smt_astt a = mk_func_app(ressort, SMT_FUNC_BVSLT, _args, 2);
-    return mk_func_app(ressort, SMT_FUNC_NOT, &a, 1);
-  }
-  case SMT_FUNC_BVSLTE:
-  {
-    result = new_ast(ressort);
-    result->bv.push_back(lt_or_le(true, args[0]->bv, args[1]->bv, true));
-    break;
-  }
-  case SMT_FUNC_BVSGT:
-  {
-    // Same as LT flipped
-    smt_astt args2[2];
-    args2[0] = _args[1];
-    args2[1] = _args[0];
-    return mk_func_app(ressort, SMT_FUNC_BVSLT, args2, 2);
-  }
-  case SMT_FUNC_BVSLT:
-  {
-    result = new_ast(ressort);
-    result->bv.push_back(lt_or_le(false, args[0]->bv, args[1]->bv, true));
-    break;
-  }
-  case SMT_FUNC_BVMUL:
-  {
-    result = new_ast(ressort);
-    const bitblast_smt_sort *sort0 = bitblast_sort_downcast(args[0]->sort);
-    const bitblast_smt_sort *sort1 = bitblast_sort_downcast(args[1]->sort);
-    if(sort0->sign || sort1->sign)
-    {
-      signed_multiplier(args[0]->bv, args[1]->bv, result->bv);
-    }
-    else
-    {
-      unsigned_multiplier(args[0]->bv, args[1]->bv, result->bv);
-    }
-    break;
-  }
-  case SMT_FUNC_CONCAT:
-  {
-    result = new_ast(ressort);
-    result->bv.insert(
-      result->bv.begin(), args[0]->bv.begin(), args[0]->bv.end());
-    result->bv.insert(
-      result->bv.begin(), args[1]->bv.begin(), args[1]->bv.end());
-    break;
-  }
-  case SMT_FUNC_BVAND:
-  {
-    result = new_ast(ressort);
-    bvand(args[0]->bv, args[1]->bv, result->bv);
-    break;
-  }
-  case SMT_FUNC_BVXOR:
-  {
-    result = new_ast(ressort);
-    bvxor(args[0]->bv, args[1]->bv, result->bv);
-    break;
-  }
-  case SMT_FUNC_BVOR:
-  {
-    result = new_ast(ressort);
-    bvor(args[0]->bv, args[1]->bv, result->bv);
-    break;
-  }
-  case SMT_FUNC_BVNOT:
-  {
-    result = new_ast(ressort);
-    bvnot(args[0]->bv, result->bv);
-    break;
-  }
-  case SMT_FUNC_BVASHR:
-  {
-    result = new_ast(ressort);
-    barrel_shift(
-      args[0]->bv, bitblast_convt::shiftt::ARIGHT, args[1]->bv, result->bv);
-    break;
-  }
-  case SMT_FUNC_BVLSHR:
-  {
-    result = new_ast(ressort);
-    barrel_shift(
-      args[0]->bv, bitblast_convt::shiftt::LRIGHT, args[1]->bv, result->bv);
-    break;
-  }
-  case SMT_FUNC_BVSHL:
-  {
-    result = new_ast(ressort);
-    barrel_shift(
-      args[0]->bv, bitblast_convt::shiftt::LEFT, args[1]->bv, result->bv);
-    break;
-  }
-  case SMT_FUNC_BVSDIV:
-  {
-    bvt rem;
-    result = new_ast(ressort);
-    signed_divider(args[0]->bv, args[1]->bv, result->bv, rem);
-    break;
-  }
-  case SMT_FUNC_BVUDIV:
-  {
-    bvt rem;
-    result = new_ast(ressort);
-    unsigned_divider(args[0]->bv, args[1]->bv, result->bv, rem);
-    break;
-  }
-  case SMT_FUNC_BVSMOD:
-  {
-    bvt res;
-    result = new_ast(ressort);
-    signed_divider(args[0]->bv, args[1]->bv, res, result->bv);
-    break;
-  }
-  case SMT_FUNC_BVUMOD:
-  {
-    bvt res;
-    result = new_ast(ressort);
-    unsigned_divider(args[0]->bv, args[1]->bv, res, result->bv);
-    break;
-  }
-  case SMT_FUNC_BVNEG:
-  {
-    result = new_ast(ressort);
-    negate(args[0]->bv, result->bv);
-    break;
-  }
-  default:
-    log_error(
-      "Unimplemented SMT function \"{}\" in bitblast convt",
-      smt_func_name_table[f]);
-    abort();
-  }
+smt_astt bitblast_convt::mk_bvsmod(smt_astt a, smt_astt b)
+{
+  bvt res, rem;
+  signed_divider(bits(a), bits(b), res, rem);
+  return new_ast(std::move(rem), a->sort);
+}
 
-  return result;
+smt_astt bitblast_convt::mk_bvumod(smt_astt a, smt_astt b)
+{
+  bvt res, rem;
+  unsigned_divider(bits(a), bits(b), res, rem);
+  return new_ast(std::move(rem), a->sort);
 }
 
-smt_sort *bitblast_convt::mk_sort(smt_sort_kind k, ...)
+smt_astt bitblast_convt::mk_bvsdiv(smt_astt a, smt_astt b)
 {
-  va_list ap;
-  bitblast_smt_sort *s = NULL, *dom, *range;
-  unsigned long uint;
-  int thebool;
+  bvt res, rem;
+  signed_divider(bits(a), bits(b), res, rem);
+  return new_ast(std::move(res), a->sort);
+}
 
-  va_start(ap, k);
-  switch(k)
-  {
-  case SMT_SORT_INT:
-    log_error("Can't make Int sorts in bitblaster");
-    abort();
-  case SMT_SORT_REAL:
-    log_error("Can't make Real sorts in bitblaster");
-    abort();
-  case SMT_SORT_BV:
-    uint = va_arg(ap, unsigned long);
-    thebool = va_arg(ap, int);
-    s = new bitblast_smt_sort(k, uint, thebool);
-    break;
-  case SMT_SORT_ARRAY:
-    dom = va_arg(ap, bitblast_smt_sort *); // Consider constness?
-    range = va_arg(ap, bitblast_smt_sort *);
-    s = new bitblast_smt_sort(k, range->data_width, dom->data_width);
-    break;
-  case SMT_SORT_BOOL:
-    s = new bitblast_smt_sort(k);
-    break;
-  default:
-    log_error("Unimplemented SMT sort {} in bitblaster conversion", k);
-    abort();
-  }
+smt_astt bitblast_convt::mk_bvudiv(smt_astt a, smt_astt b)
+{
+  bvt res, rem;
+  unsigned_divider(bits(a), bits(b), res, rem);
+  return new_ast(std::move(res), a->sort);
+}
 
-  return s;
+smt_astt bitblast_convt::mk_bvshl(smt_astt a, smt_astt b)
+{
+  bvt res;
+  barrel_shift(bits(a), LEFT, bits(b), res);
+  return new_ast(std::move(res), a->sort);
 }
 
-smt_ast *bitblast_convt::mk_smt_int(const BigInt &intval [[maybe_unused]])
+smt_astt bitblast_convt::mk_bvashr(smt_astt a, smt_astt b)
 {
-  log_error("Can't create integers in bitblast solver");
-  abort();
+  bvt res;
+  barrel_shift(bits(a), ARIGHT, bits(b), res);
+  return new_ast(std::move(res), a->sort);
 }
 
-smt_ast *bitblast_convt::mk_smt_real(const std::string &value [[maybe_unused]])
+smt_astt bitblast_convt::mk_bvlshr(smt_astt a, smt_astt b)
 {
-  log_error("Can't create reals in bitblast solver");
-  abort();
+  bvt res;
+  barrel_shift(bits(a), LRIGHT, bits(b), res);
+  return new_ast(std::move(res), a->sort);
 }
 
-smt_ast *
-bitblast_convt::mk_smt_bvint(const BigInt &intval, bool sign, unsigned int w)
+smt_astt bitblast_convt::mk_bvneg(smt_astt a)
 {
-  smt_sort *s = mk_sort(SMT_SORT_BV, w, sign);
-  bitblast_smt_ast *a = new_ast(s);
-  a->bv.resize(w);
-  int u = intval.to_int64();
-  for(unsigned int i = 0; i < w; i++)
-  {
-    int mask = (1ULL << i);
-    bool val = u & mask;
-    a->bv[i] = const_literal(val);
-  }
+  bvt res;
+  negate(bits(a), res);
+  return new_ast(std::move(res), a->sort);
+}
 
-  return a;
+smt_astt bitblast_convt::mk_bvnot(smt_astt a)
+{
+  bvt res;
+  bvnot(bits(a), res);
+  return new_ast(std::move(res), a->sort);
 }
 
-smt_ast *bitblast_convt::mk_smt_bool(bool boolval)
+smt_astt bitblast_convt::mk_bvnxor(smt_astt a, smt_astt b)
 {
-  literalt l = const_literal(boolval);
+  bvt res;
+  bvxor(bits(a), bits(b), res);
+  invert(res);
+  return new_ast(std::move(res), a->sort);
+}
 
-  smt_sort *s = mk_sort(SMT_SORT_BOOL);
-  bitblast_smt_ast *a = new_ast(s);
-  a->bv.push_back(l);
-  return a;
+smt_astt bitblast_convt::mk_bvnor(smt_astt a, smt_astt b)
+{
+  bvt res;
+  bvor(bits(a), bits(b), res);
+  invert(res);
+  return new_ast(std::move(res), a->sort);
 }
 
-smt_astt bitblast_convt::mk_smt_symbol(const std::string &name, smt_sortt sort)
+smt_astt bitblast_convt::mk_bvnand(smt_astt a, smt_astt b)
 {
-  // Otherwise, we need to build this AST ourselves.
-  bitblast_smt_ast *a = new_ast(sort);
-  smt_astt result = a;
-  const bitblast_smt_sort *s = bitblast_sort_downcast(sort);
-  switch(sort->id)
-  {
-  case SMT_SORT_BOOL:
-  {
-    literalt l = sat_api->new_variable();
-    a->bv.push_back(l);
-    break;
-  }
-  case SMT_SORT_BV:
-  {
-    // Bunch of fresh variables
-    for(unsigned int i = 0; i < s->data_width; i++)
-      a->bv.push_back(sat_api->new_variable());
-    break;
-  }
-  default:
-    log_error(
-      "Unimplemented symbol type {} in bitblast symbol creation", sort->id);
-    abort();
-  }
+  bvt res;
+  bvand(bits(a), bits(b), res);
+  invert(res);
+  return new_ast(std::move(res), a->sort);
+}
 
-  return result;
+smt_astt bitblast_convt::mk_bvxor(smt_astt a, smt_astt b)
+{
+  bvt res;
+  bvxor(bits(a), bits(b), res);
+  return new_ast(std::move(res), a->sort);
 }
 
-smt_sort *bitblast_convt::mk_struct_sort(const type2tc &t [[maybe_unused]])
+smt_astt bitblast_convt::mk_bvor(smt_astt a, smt_astt b)
 {
-  abort();
+  bvt res;
+  bvor(bits(a), bits(b), res);
+  return new_ast(std::move(res), a->sort);
 }
 
-smt_ast *bitblast_convt::mk_extract(
-  smt_astt src,
-  unsigned int high,
-  unsigned int low,
-  smt_sortt s)
+smt_astt bitblast_convt::mk_bvand(smt_astt a, smt_astt b)
 {
-  const bitblast_smt_ast *mast = bitblast_ast_downcast(src);
-  bitblast_smt_ast *result = new_ast(s);
-  for(unsigned int i = low; i <= high; i++)
-    result->bv.push_back(mast->bv[i]);
+  bvt res;
+  bvand(bits(a), bits(b), res);
+  return new_ast(std::move(res), a->sort);
+}
 
-  return result;
+smt_astt bitblast_convt::mk_implies(smt_astt a, smt_astt b)
+{
+  assert(a->sort->id == SMT_SORT_BOOL && b->sort->id == SMT_SORT_BOOL);
+  return new_ast({sat_api->limplies(bits(a)[0], bits(b)[0])}, boolean_sort);
+}
+
+smt_astt bitblast_convt::mk_xor(smt_astt a, smt_astt b)
+{
+  assert(a->sort->id == SMT_SORT_BOOL && b->sort->id == SMT_SORT_BOOL);
+  return new_ast({sat_api->lxor(bits(a)[0], bits(b)[0])}, boolean_sort);
+}
+
+smt_astt bitblast_convt::mk_or(smt_astt a, smt_astt b)
+{
+  assert(a->sort->id == SMT_SORT_BOOL && b->sort->id == SMT_SORT_BOOL);
+  return new_ast({sat_api->lor(bits(a)[0], bits(b)[0])}, boolean_sort);
+}
+
+smt_astt bitblast_convt::mk_and(smt_astt a, smt_astt b)
+{
+  assert(a->sort->id == SMT_SORT_BOOL && b->sort->id == SMT_SORT_BOOL);
+  return new_ast({sat_api->land(bits(a)[0], bits(b)[0])}, boolean_sort);
+}
+
+smt_astt bitblast_convt::mk_not(smt_astt a)
+{
+  assert(a->sort->id == SMT_SORT_BOOL);
+  return new_ast({sat_api->lnot(bits(a)[0])}, boolean_sort);
+}
+
+smt_astt bitblast_convt::mk_bvult(smt_astt a, smt_astt b)
+{
+  return new_ast({unsigned_less_than(bits(a), bits(b))}, boolean_sort);
+}
+
+smt_astt bitblast_convt::mk_bvslt(smt_astt a, smt_astt b)
+{
+  return new_ast({lt_or_le(false, bits(a), bits(b), true)}, boolean_sort);
 }
 
-bitblast_smt_ast *
-bitblast_convt::mk_ast_equality(smt_astt _a, smt_astt _b, smt_sortt ressort)
+smt_astt bitblast_convt::mk_bvugt(smt_astt a, smt_astt b)
 {
-  const bitblast_smt_ast *a = bitblast_ast_downcast(_a);
-  const bitblast_smt_ast *b = bitblast_ast_downcast(_b);
+  // Same as LT flipped
+  return mk_bvult(b, a);
+}
+
+smt_astt bitblast_convt::mk_bvsgt(smt_astt a, smt_astt b)
+{
+  // Same as LT flipped
+  return mk_bvslt(b, a);
+}
+
+smt_astt bitblast_convt::mk_bvule(smt_astt a, smt_astt b)
+{
+  return new_ast({lt_or_le(true, bits(a), bits(b), false)}, boolean_sort);
+}
+
+smt_astt bitblast_convt::mk_bvsle(smt_astt a, smt_astt b)
+{
+  return new_ast({lt_or_le(true, bits(a), bits(b), true)}, boolean_sort);
+}
 
+smt_astt bitblast_convt::mk_bvuge(smt_astt a, smt_astt b)
+{
+  return mk_bvule(b, a);
+}
+
+smt_astt bitblast_convt::mk_bvsge(smt_astt a, smt_astt b)
+{
+  return mk_bvsle(b, a);
+}
+
+smt_astt bitblast_convt::mk_eq(smt_astt a, smt_astt b)
+{
   switch(a->sort->id)
   {
   case SMT_SORT_BOOL:
-  {
-    literalt res = sat_api->lequal(a->bv[0], b->bv[0]);
-    bitblast_smt_ast *n = new_ast(a->sort);
-    n->bv.push_back(res);
-    return n;
-  }
+    return new_ast({sat_api->lequal(bits(a)[0], bits(b)[0])}, boolean_sort);
   case SMT_SORT_BV:
-  {
-    bitblast_smt_ast *n = new_ast(ressort);
-    n->bv.push_back(equal(a->bv, b->bv));
-    return n;
-  }
-  case SMT_SORT_ARRAY:
-  {
-    // XXX - so, if we have different array encodings in the future then this
-    // might get quite funky. Leave it until then, though.
-    log_error("No direct array equality support in bitblast converter");
-    abort();
-  }
+  case SMT_SORT_FIXEDBV:
+  case SMT_SORT_BVFP:
+  case SMT_SORT_BVFP_RM:
+    return new_ast({equal(bits(a), bits(b))}, boolean_sort);
   default:
     log_error("Invalid sort {} for equality in bitblast", a->sort->id);
     abort();
   }
 }
 
-expr2tc bitblast_convt::get_bool(smt_astt a)
+smt_astt bitblast_convt::mk_neq(smt_astt a, smt_astt b)
 {
-  tvt t = l_get(a);
-  if(t.is_true())
-    return gen_true_expr();
-  else if(t.is_false())
-    return gen_false_expr();
-  else
-    return expr2tc();
+  return mk_not(mk_eq(a, b));
 }
 
-tvt bitblast_convt::l_get(smt_astt a)
+smt_sortt bitblast_convt::mk_bool_sort()
 {
-  const bitblast_smt_ast *mast = bitblast_ast_downcast(a);
-  return sat_api->l_get(mast->bv[0]);
+  return new smt_sort(SMT_SORT_BOOL, 1);
 }
 
-expr2tc bitblast_convt::get_bv(const type2tc &t, smt_astt a)
+smt_sortt bitblast_convt::mk_bv_sort(std::size_t width)
 {
-  const bitblast_smt_ast *mast = bitblast_ast_downcast(a);
-  unsigned int sz = t->get_width();
-  assert(sz <= 64 && "Your integers are larger than a uint64_t");
-  assert(mast->bv.size() == sz);
-  uint64_t accuml = 0;
-  for(unsigned int i = 0; i < sz; i++)
-  {
-    uint64_t mask = 1 << i;
-    tvt t = sat_api->l_get(mast->bv[i]);
-    if(t.is_true())
-    {
-      accuml |= mask;
-    }
-    else if(t.is_false())
-    {
-      ; // It's zero
-    }
-    else
-    {
-      ; // It's undefined in this model. So may as well be zero.
-    }
-  }
+  return new smt_sort(SMT_SORT_BV, width);
+}
 
-  return constant_int2tc(t, BigInt(accuml));
+smt_sortt bitblast_convt::mk_fbv_sort(std::size_t width)
+{
+  return new smt_sort(SMT_SORT_FIXEDBV, width);
 }
 
-// ******************************  Bitblast foo *******************************
+smt_sortt bitblast_convt::mk_bvfp_sort(std::size_t ew, std::size_t sw)
+{
+  return new smt_sort(SMT_SORT_BVFP, ew + sw + 1, sw + 1);
+}
 
-bool bitblast_convt::process_clause(const bvt &bv, bvt &dest)
+smt_sortt bitblast_convt::mk_bvfp_rm_sort()
 {
-  dest.clear();
+  return new smt_sort(SMT_SORT_BVFP_RM, 3);
+}
 
-  // empty clause! this is UNSAT
-  if(bv.empty())
-    return false;
+smt_astt bitblast_convt::mk_smt_int(const BigInt &)
+{
+  log_error("Can't create integers in bitblast solver");
+  abort();
+}
 
-  std::set<literalt> s;
+smt_astt bitblast_convt::mk_smt_real(const std::string &)
+{
+  log_error("Can't create reals in bitblast solver");
+  abort();
+}
 
-  dest.reserve(bv.size());
+smt_astt bitblast_convt::mk_smt_bv(const BigInt &theint, smt_sortt s)
+{
+  std::size_t w = s->get_data_width();
+  std::string digits = integer2binary(theint, w);
+  assert(digits.size() == w);
 
-  for(bvt::const_iterator it = bv.begin(); it != bv.end(); it++)
-  {
-    literalt l = *it;
+  bvt bv(w);
+  for(std::size_t i = 0; i < w; i++)
+    bv[i] = const_literal(digits[w - 1 - i] == '1');
 
-    if(l.is_true())
-      return true; // clause satisfied
+  return new_ast(std::move(bv), s);
+}
 
-    if(l.is_false())
-      continue;
+smt_astt bitblast_convt::mk_smt_bool(bool val)
+{
+  return new_ast({const_literal(val)}, boolean_sort);
+}
 
-    // prevent duplicate literals
-    if(s.insert(l).second)
-      dest.push_back(l);
+smt_astt bitblast_convt::mk_smt_symbol(const std::string &name, smt_sortt s)
+{
+  auto it = symtable.find(name);
+  if(it != symtable.end())
+  {
+    assert(it->second.size() == s->get_data_width());
+    return new_ast(it->second, s);
+  }
 
-    if(s.find(sat_api->lnot(l)) != s.end())
-      return true; // clause satisfied
+  bvt bv;
+  switch(s->id)
+  {
+  case SMT_SORT_BOOL:
+    bv.push_back(sat_api->new_variable());
+    break;
+  case SMT_SORT_BV:
+  case SMT_SORT_FIXEDBV:
+  case SMT_SORT_BVFP:
+  case SMT_SORT_BVFP_RM:
+    // Bunch of fresh variables
+    for(std::size_t i = 0; i < s->get_data_width(); i++)
+      bv.push_back(sat_api->new_variable());
+    break;
+  default:
+    log_error("Unimplemented symbol type {} in bitblast symbol creation", s->id);
+    abort();
   }
 
-  return false;
+  symtable.emplace(name, bv);
+  return new_ast(std::move(bv), s);
 }
 
-void bitblast_convt::eliminate_duplicates(const bvt &bv, bvt &dest)
+smt_astt
+bitblast_convt::mk_extract(smt_astt a, unsigned int high, unsigned int low)
 {
-  std::set<literalt> s;
+  const bvt &bv = bits(a);
+  assert(high < bv.size() && low <= high);
+  return new_ast(
+    bvt(bv.begin() + low, bv.begin() + high + 1), mk_bv_sort(high - low + 1));
+}
 
-  dest.reserve(bv.size());
+smt_astt bitblast_convt::mk_sign_ext(smt_astt a, unsigned int topwidth)
+{
+  bvt bv = bits(a);
+  literalt top = bv.back();
+  bv.resize(bv.size() + topwidth, top);
+  smt_sortt s = mk_bv_sort(bv.size());
+  return new_ast(std::move(bv), s);
+}
 
-  for(bvt::const_iterator it = bv.begin(); it != bv.end(); it++)
-  {
-    if(s.insert(*it).second)
-      dest.push_back(*it);
-  }
+smt_astt bitblast_convt::mk_zero_ext(smt_astt a, unsigned int topwidth)
+{
+  bvt bv = bits(a);
+  bv.resize(bv.size() + topwidth, const_literal(false));
+  smt_sortt s = mk_bv_sort(bv.size());
+  return new_ast(std::move(bv), s);
 }
 
+smt_astt bitblast_convt::mk_concat(smt_astt a, smt_astt b)
+{
+  // The first operand holds the top bits
+  bvt bv = bits(b);
+  bv.insert(bv.end(), bits(a).begin(), bits(a).end());
+  smt_sortt s = mk_bv_sort(bv.size());
+  return new_ast(std::move(bv), s);
+}
+
+smt_astt bitblast_convt::mk_ite(smt_astt cond, smt_astt t, smt_astt f)
+{
+  assert(cond->sort->id == SMT_SORT_BOOL);
+  const bvt &tv = bits(t), &fv = bits(f);
+  assert(tv.size() == fv.size());
+
+  literalt c = bits(cond)[0];
+  bvt bv(tv.size());
+  for(std::size_t i = 0; i < tv.size(); i++)
+    bv[i] = sat_api->lselect(c, tv[i], fv[i]);
+
+  return new_ast(std::move(bv), t->sort);
+}
+
+bool bitblast_convt::get_bool(smt_astt a)
+{
+  // Anything the model leaves open may as well be false
+  return sat_api->l_get(bits(a)[0]).is_true();
+}
+
+BigInt bitblast_convt::get_bv(smt_astt a, bool is_signed)
+{
+  const bvt &bv = bits(a);
+  std::string digits(bv.size(), '0');
+  for(std::size_t i = 0; i < bv.size(); i++)
+    if(sat_api->l_get(bv[i]).is_true())
+      digits[bv.size() - 1 - i] = '1';
+
+  return binary2integer(digits, is_signed);
+}
+
+// ******************************  Bitblast foo *******************************
+
 void bitblast_convt::full_adder(
   const bvt &op0,
   const bvt &op1,
@@ -551,18 +420,13 @@ void bitblast_convt::full_adder(
     output.push_back(sat_api->lxor(sat_api->lxor(op0[i], op1[i]), carry_out));
     carry_out = carry(op0[i], op1[i], carry_out);
   }
-
-  return;
 }
 
 literalt bitblast_convt::carry(literalt a, literalt b, literalt c)
 {
-  bvt tmp;
-  tmp.reserve(3);
-  tmp.push_back(sat_api->land(a, b));
-  tmp.push_back(sat_api->land(a, c));
-  tmp.push_back(sat_api->land(b, c));
-  return lor(tmp);
+  // Majority of three; the xor of a and b is shared with the sum bit
+  literalt x = sat_api->lxor(a, b);
+  return sat_api->lor(sat_api->land(a, b), sat_api->land(x, c));
 }
 
 literalt bitblast_convt::unsigned_less_than(const bvt &arg0, const bvt &arg1)
@@ -577,21 +441,15 @@ void bitblast_convt::unsigned_multiplier(
   const bvt &op1,
   bvt &output)
 {
-  output.resize(op0.size());
-
-  for(unsigned int i = 0; i < op0.size(); i++)
-    output[i] = const_literal(false);
+  output.assign(op0.size(), const_literal(false));
 
   for(unsigned int i = 0; i < op0.size(); i++)
   {
     if(op0[i] != const_literal(false))
     {
-      bvt tmpop;
+      bvt tmpop(i, const_literal(false));
       tmpop.reserve(op0.size());
 
-      for(unsigned int idx = 0; idx < i; idx++)
-        tmpop.push_back(const_literal(false));
-
       for(unsigned int idx = i; idx < op0.size(); idx++)
         tmpop.push_back(sat_api->land(op1[idx - i], op0[i]));
 
@@ -603,27 +461,6 @@ void bitblast_convt::unsigned_multiplier(
   }
 }
 
-void bitblast_convt::signed_multiplier(
-  const bvt &op0,
-  const bvt &op1,
-  bvt &output)
-{
-  assert(op0.size() == op1.size() && op0.size() != 0);
-  literalt sign0 = op0[op0.size() - 1];
-  literalt sign1 = op1[op1.size() - 1];
-
-  bvt neg0, neg1;
-  cond_negate(op0, neg0, sign0);
-  cond_negate(op1, neg1, sign1);
-
-  bvt tmp;
-  unsigned_multiplier(neg0, neg1, tmp);
-
-  literalt res_sign = sat_api->lxor(sign0, sign1);
-
-  cond_negate(tmp, output, res_sign);
-}
-
 void bitblast_convt::cond_negate(const bvt &vals, bvt &out, literalt cond)
 {
   bvt inv;
@@ -633,8 +470,6 @@ void bitblast_convt::cond_negate(const bvt &vals, bvt &out, literalt cond)
 
   for(unsigned int i = 0; i < vals.size(); i++)
     out[i] = sat_api->lselect(cond, inv[i], vals[i]);
-
-  return;
 }
 
 void bitblast_convt::negate(const bvt &inp, bvt &oup)
@@ -642,19 +477,15 @@ void bitblast_convt::negate(const bvt &inp, bvt &oup)
   oup.resize(inp.size());
   bvt inv = inp;
   invert(inv);
-
-  literalt dummy;
-  incrementer(inv, const_literal(true), dummy, oup);
-  return;
+  incrementer(inv, const_literal(true), oup);
 }
 
 void bitblast_convt::incrementer(
   const bvt &inp,
   const literalt &carryin,
-  literalt carryout,
   bvt &oup)
 {
-  carryout = carryin;
+  literalt carryout = carryin;
 
   for(unsigned int i = 0; i < inp.size(); i++)
   {
@@ -662,8 +493,6 @@ void bitblast_convt::incrementer(
     oup[i] = sat_api->lxor(inp[i], carryout);
     carryout = new_carry;
   }
-
-  return;
 }
 
 void bitblast_convt::signed_divider(
@@ -674,41 +503,20 @@ void bitblast_convt::signed_divider(
 {
   assert(op0.size() == op1.size());
 
-  bvt _op0;
-  bvt _op1;
-  _op0.resize(op0.size());
-  _op1.resize(op1.size());
-
   literalt sign0 = op0[op0.size() - 1];
   literalt sign1 = op1[op1.size() - 1];
 
-  bvt neg0;
-  bvt neg1;
-  negate(op0, neg0);
-  negate(op1, neg1);
-
-  for(unsigned int i = 0; i < op0.size(); i++)
-    _op0[i] = sat_api->lselect(sign0, neg0[i], op0[i]);
-
-  for(unsigned int i = 0; i < op1.size(); i++)
-    _op1[i] = sat_api->lselect(sign1, neg1[i], op1[i]);
-
-  unsigned_divider(_op0, _op1, res, rem);
-
-  bvt neg_res;
-  bvt neg_rem;
-  negate(res, neg_res);
-  negate(rem, neg_rem);
-
-  literalt result_sign = sat_api->lxor(sign0, sign1);
+  // Divide the magnitudes, then fix up the signs: the quotient is negative
+  // when the operands' signs differ, the remainder takes the dividend's
+  bvt _op0, _op1;
+  cond_negate(op0, _op0, sign0);
+  cond_negate(op1, _op1, sign1);
 
-  for(unsigned int i = 0; i < res.size(); i++)
-    res[i] = sat_api->lselect(result_sign, neg_res[i], res[i]);
+  bvt ures, urem;
+  unsigned_divider(_op0, _op1, ures, urem);
 
-  for(unsigned int i = 0; i < rem.size(); i++)
-    rem[i] = sat_api->lselect(result_sign, neg_rem[i], rem[i]);
-
-  return;
+  cond_negate(ures, res, sat_api->lxor(sign0, sign1));
+  cond_negate(urem, rem, sign0);
 }
 
 void bitblast_convt::unsigned_divider(
@@ -722,7 +530,7 @@ void bitblast_convt::unsigned_divider(
   res.resize(width);
   rem.resize(width);
 
-  literalt is_not_zero = lor(op1);
+  literalt is_not_zero = sat_api->lor(op1);
 
   for(unsigned int i = 0; i < width; i++)
   {
@@ -730,6 +538,10 @@ void bitblast_convt::unsigned_divider(
     rem[i] = sat_api->new_variable();
   }
 
+  // Every constraint below holds for some res and rem, whatever the operands
+  // are; they only define the fresh literals, so they may be asserted
+  // outright.
+
   bvt product;
   unsigned_multiplier_no_overflow(res, op1, product);
 
@@ -747,10 +559,11 @@ void bitblast_convt::unsigned_divider(
   sat_api->assert_lit(
     sat_api->limplies(is_not_zero, lt_or_le(false, rem, op1, false)));
 
-  // "op1 != 0 => res <= op0"
+  // Dividing by zero gives all ones, with the dividend as the remainder
 
-  sat_api->assert_lit(
-    sat_api->limplies(is_not_zero, lt_or_le(true, rem, op0, false)));
+  bvt ones(width, const_literal(true));
+  sat_api->assert_lit(sat_api->lor(is_not_zero, equal(res, ones)));
+  sat_api->assert_lit(sat_api->lor(is_not_zero, equal(rem, op0)));
 }
 
 void bitblast_convt::unsigned_multiplier_no_overflow(
@@ -759,27 +572,16 @@ void bitblast_convt::unsigned_multiplier_no_overflow(
   bvt &res)
 {
   assert(op0.size() == op1.size());
-  bvt _op0 = op0, _op1 = op1;
-
-  if(is_constant(_op1))
-    std::swap(_op0, _op1);
-
-  res.resize(op0.size());
 
-  for(unsigned int i = 0; i < res.size(); i++)
-    res[i] = const_literal(false);
+  res.assign(op0.size(), const_literal(false));
 
   for(unsigned int sum = 0; sum < op0.size(); sum++)
   {
     if(op0[sum] != const_literal(false))
     {
-      bvt tmpop;
-
+      bvt tmpop(sum, const_literal(false));
       tmpop.reserve(res.size());
 
-      for(unsigned int idx = 0; idx < sum; idx++)
-        tmpop.push_back(const_literal(false));
-
       for(unsigned int idx = sum; idx < res.size(); idx++)
         tmpop.push_back(sat_api->land(op1[idx - sum], op0[sum]));
 
@@ -787,58 +589,11 @@ void bitblast_convt::unsigned_multiplier_no_overflow(
       adder_no_overflow(copy, tmpop, res);
 
       for(unsigned int idx = op1.size() - sum; idx < op1.size(); idx++)
-      {
-        literalt tmp = sat_api->land(op1[idx], op0[sum]);
-        tmp.invert();
-        sat_api->assert_lit(tmp);
-      }
+        sat_api->assert_lit(sat_api->lnot(sat_api->land(op1[idx], op0[sum])));
     }
   }
 }
 
-void bitblast_convt::adder_no_overflow(
-  const bvt &op0,
-  const bvt &op1,
-  bvt &res,
-  bool subtract,
-  bool is_signed)
-{
-  assert(op0.size() == op1.size());
-  unsigned int width = op0.size();
-  bvt tmp_op1 = op1;
-  if(subtract)
-    negate(op1, tmp_op1);
-
-  if(is_signed)
-  {
-    literalt old_sign = op0[width - 1];
-    literalt sign_the_same =
-      sat_api->lequal(op0[width - 1], tmp_op1[width - 1]);
-    literalt carry;
-    full_adder(op0, tmp_op1, res, const_literal(subtract), carry);
-    literalt stop_overflow =
-      sat_api->land(sign_the_same, sat_api->lxor(op0[width - 1], old_sign));
-    stop_overflow.invert();
-    sat_api->assert_lit(stop_overflow);
-  }
-  else
-  {
-    literalt carry_out;
-    full_adder(op0, tmp_op1, res, const_literal(subtract), carry_out);
-    if(subtract)
-    {
-      sat_api->assert_lit(carry_out);
-    }
-    else
-    {
-      carry_out.invert();
-      sat_api->assert_lit(carry_out);
-    }
-  }
-
-  return;
-}
-
 void bitblast_convt::adder_no_overflow(const bvt &op0, const bvt &op1, bvt &res)
 {
   res.resize(op0.size());
@@ -852,8 +607,7 @@ void bitblast_convt::adder_no_overflow(const bvt &op0, const bvt &op1, bvt &res)
     carry_out = carry(op0_bit, op1[i], carry_out);
   }
 
-  carry_out.invert();
-  sat_api->assert_lit(carry_out);
+  sat_api->assert_lit(sat_api->lnot(carry_out));
 }
 
 bool bitblast_convt::is_constant(const bvt &bv)
@@ -883,8 +637,7 @@ literalt bitblast_convt::equal(const bvt &op0, const bvt &op1)
   for(unsigned int i = 0; i < op0.size(); i++)
     tmp.push_back(sat_api->lequal(op0[i], op1[i]));
 
-  literalt res = land(tmp);
-  return res;
+  return sat_api->land(tmp);
 }
 
 literalt bitblast_convt::lt_or_le(
@@ -924,22 +677,23 @@ void bitblast_convt::barrel_shift(
   const bvt &dist,
   bvt &out)
 {
-  unsigned long d = 1;
   out = op;
 
-  // FIXME: clip this on oversized shifts?
   for(unsigned int pos = 0; pos < dist.size(); pos++)
   {
     if(dist[pos] != const_literal(false))
     {
+      // Distances from the width upwards all shift everything out
+      unsigned long d = op.size();
+      if(pos < 8 * sizeof(unsigned long) - 1)
+        d = std::min(d, 1UL << pos);
+
       bvt tmp;
       shift(out, s, d, tmp);
 
       for(unsigned int i = 0; i < op.size(); i++)
         out[i] = sat_api->lselect(dist[pos], tmp[i], out[i]);
     }
-
-    d <<= 1;
   }
 }
 
@@ -970,8 +724,6 @@ void bitblast_convt::shift(
 
     out[i] = l;
   }
-
-  return;
 }
 
 void bitblast_convt::bvand(const bvt &bv0, const bvt &bv1, bvt &output)
@@ -982,8 +734,6 @@ void bitblast_convt::bvand(const bvt &bv0, const bvt &bv1, bvt &output)
 
   for(unsigned int i = 0; i < bv0.size(); i++)
     output.push_back(sat_api->land(bv0[i], bv1[i]));
-
-  return;
 }
 
 void bitblast_convt::bvor(const bvt &bv0, const bvt &bv1, bvt &output)
@@ -994,19 +744,16 @@ void bitblast_convt::bvor(const bvt &bv0, const bvt &bv1, bvt &output)
 
   for(unsigned int i = 0; i < bv0.size(); i++)
     output.push_back(sat_api->lor(bv0[i], bv1[i]));
-
-  return;
 }
 
 void bitblast_convt::bvxor(const bvt &bv0, const bvt &bv1, bvt &output)
 {
+  assert(bv0.size() == bv1.size());
   output.clear();
   output.reserve(bv0.size());
 
   for(unsigned int i = 0; i < bv0.size(); i++)
     output.push_back(sat_api->lxor(bv0[i], bv1[i]));
-
-  return;
 }
 
 void bitblast_convt::bvnot(const bvt &bv0, bvt &output)
@@ -1016,92 +763,4 @@ void bitblast_convt::bvnot(const bvt &bv0, bvt &output)
 
   for(unsigned int i = 0; i < bv0.size(); i++)
     output.push_back(sat_api->lnot(bv0[i]));
-
-  return;
-}
-
-literalt bitblast_convt::land(const bvt &bv)
-{
-  if(bv.size() == 0)
-    return const_literal(true);
-  else if(bv.size() == 1)
-    return bv[0];
-  else if(bv.size() == 2)
-    return sat_api->land(bv[0], bv[1]);
-
-  unsigned int trues = 0;
-  for(unsigned int i = 0; i < bv.size(); i++)
-  {
-    if(bv[i] == const_literal(false))
-      return const_literal(false);
-    else if(bv[i] == const_literal(true))
-      trues++;
-  }
-
-  if(trues == bv.size())
-    return const_literal(true);
-
-  bvt new_bv;
-
-  eliminate_duplicates(bv, new_bv);
-
-  literalt lit = sat_api->new_variable();
-
-  for(unsigned int i = 0; i < new_bv.size(); i++)
-  {
-    bvt lits;
-    lits.reserve(2);
-    lits.push_back(pos(new_bv[i]));
-    lits.push_back(neg(lit));
-    sat_api->lcnf(lits);
-  }
-
-  bvt lits;
-  lits.reserve(new_bv.size() + 1);
-
-  for(unsigned int i = 0; i < new_bv.size(); i++)
-    lits.push_back(neg(new_bv[i]));
-
-  lits.push_back(pos(lit));
-  sat_api->lcnf(lits);
-
-  return lit;
-}
-
-literalt bitblast_convt::lor(const bvt &bv)
-{
-  if(bv.size() == 0)
-    return const_literal(false);
-  else if(bv.size() == 1)
-    return bv[0];
-  else if(bv.size() == 2)
-    return sat_api->lor(bv[0], bv[1]);
-
-  for(unsigned int i = 0; i < bv.size(); i++)
-    if(bv[i] == const_literal(true))
-      return const_literal(true);
-
-  bvt new_bv;
-  eliminate_duplicates(bv, new_bv);
-
-  literalt literal = sat_api->new_variable();
-  for(unsigned int i = 0; i < new_bv.size(); i++)
-  {
-    bvt lits;
-    lits.reserve(2);
-    lits.push_back(neg(new_bv[i]));
-    lits.push_back(pos(literal));
-    sat_api->lcnf(lits);
-  }
-
-  bvt lits;
-  lits.reserve(new_bv.size() + 1);
-
-  for(unsigned int i = 0; i < new_bv.size(); i++)
-    lits.push_back(pos(new_bv[i]));
-
-  lits.push_back(neg(literal));
-  sat_api->lcnf(lits);
-
-  return literal;
 }
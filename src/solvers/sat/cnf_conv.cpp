@@ -1,13 +1,10 @@
-#include <cnf_conv.h>
+#include <algorithm>
+#include <solvers/sat/cnf_conv.h>
 
 cnf_convt::cnf_convt(cnf_iface *_cnf_api) : sat_iface(), cnf_api(_cnf_api)
 {
 }
 
-cnf_convt::~cnf_convt()
-{
-}
-
 literalt cnf_convt::lnot(literalt a)
 {
   a.invert();
@@ -22,12 +19,38 @@ literalt cnf_convt::lselect(literalt a, literalt b, literalt c)
     return c;
   if(b == c)
     return b;
+  if(b == lnot(c))
+    return lequal(a, b);
+  if(
+    b.is_constant() || c.is_constant() || a == b || a == lnot(b) || a == c ||
+    a == lnot(c))
+    return lor(land(a, b), land(lnot(a), c));
+
+  // Normalise to a positive condition and a positive then-branch
+  if(a.sign())
+  {
+    a = lnot(a);
+    std::swap(b, c);
+  }
+  bool negated = b.sign();
+  if(negated)
+  {
+    b = lnot(b);
+    c = lnot(c);
+  }
+
+  select_keyt k{a.get(), b.get(), c.get()};
+  auto it = select_cache.find(k);
+  if(it != select_cache.end())
+  {
+    gates_shared++;
+    return it->second.cond_negation(negated);
+  }
 
-  bvt bv;
-  bv.reserve(2);
-  literalt one = land(a, b);
-  literalt two = land(lnot(a), c);
-  return lor(one, two);
+  literalt output = this->new_variable();
+  gate_select(a, b, c, output);
+  select_cache.emplace(k, output);
+  return output.cond_negation(negated);
 }
 
 literalt cnf_convt::lequal(literalt a, literalt b)
@@ -50,26 +73,34 @@ literalt cnf_convt::lxor(literalt a, literalt b)
     return lnot(b);
   if(b == const_literal(true))
     return lnot(a);
+  if(a == b)
+    return const_literal(false);
+  if(a == lnot(b))
+    return const_literal(true);
+
+  // Negations move to the output: only positive pairs are encoded
+  bool negated = a.sign() != b.sign();
+  a.cond_invert(a.sign());
+  b.cond_invert(b.sign());
+  if(b < a)
+    std::swap(a, b);
+
+  auto it = xor_cache.find(key(a, b));
+  if(it != xor_cache.end())
+  {
+    gates_shared++;
+    return it->second.cond_negation(negated);
+  }
 
   literalt output = this->new_variable();
   gate_xor(a, b, output);
-  return output;
+  xor_cache.emplace(key(a, b), output);
+  return output.cond_negation(negated);
 }
 
 literalt cnf_convt::lor(literalt a, literalt b)
 {
-  if(a == const_literal(false))
-    return b;
-  if(b == const_literal(false))
-    return a;
-  if(a == const_literal(true))
-    return const_literal(true);
-  if(b == const_literal(true))
-    return const_literal(true);
-
-  literalt output = this->new_variable();
-  gate_or(a, b, output);
-  return output;
+  return lnot(land(lnot(a), lnot(b)));
 }
 
 literalt cnf_convt::land(literalt a, literalt b)
@@ -84,97 +115,117 @@ literalt cnf_convt::land(literalt a, literalt b)
     return const_literal(false);
   if(a == b)
     return a;
+  if(a == lnot(b))
+    return const_literal(false);
+
+  if(b < a)
+    std::swap(a, b);
+
+  auto it = and_cache.find(key(a, b));
+  if(it != and_cache.end())
+  {
+    gates_shared++;
+    return it->second;
+  }
 
   literalt output = this->new_variable();
   gate_and(a, b, output);
+  and_cache.emplace(key(a, b), output);
   return output;
 }
 
-void cnf_convt::gate_xor(literalt a, literalt b, literalt o)
+literalt cnf_convt::land(const bvt &bv)
 {
-  // a xor b = o <==> (a' + b' + o')
-  //                  (a + b + o' )
-  //                  (a' + b + o)
-  //                  (a + b' + o)
-  bvt lits;
-
-  lits.clear();
-  lits.reserve(3);
-  lits.push_back(neg(a));
-  lits.push_back(neg(b));
-  lits.push_back(neg(o));
-  cnf_api->lcnf(lits);
+  bvt new_bv;
+  new_bv.reserve(bv.size());
+  for(const literalt &l : bv)
+  {
+    if(l == const_literal(false))
+      return const_literal(false);
+    if(l != const_literal(true))
+      new_bv.push_back(l);
+  }
 
-  lits.clear();
-  lits.reserve(3);
-  lits.push_back(pos(a));
-  lits.push_back(pos(b));
-  lits.push_back(neg(o));
-  cnf_api->lcnf(lits);
+  std::sort(new_bv.begin(), new_bv.end());
+  new_bv.erase(std::unique(new_bv.begin(), new_bv.end()), new_bv.end());
+  for(unsigned int i = 1; i < new_bv.size(); i++)
+    if(new_bv[i] == lnot(new_bv[i - 1]))
+      return const_literal(false);
 
-  lits.clear();
-  lits.reserve(3);
-  lits.push_back(neg(a));
-  lits.push_back(pos(b));
-  lits.push_back(pos(o));
-  cnf_api->lcnf(lits);
+  if(new_bv.size() == 0)
+    return const_literal(true);
+  if(new_bv.size() == 1)
+    return new_bv[0];
+  if(new_bv.size() == 2)
+    return land(new_bv[0], new_bv[1]);
 
-  lits.clear();
-  lits.reserve(3);
-  lits.push_back(pos(a));
-  lits.push_back(neg(b));
-  lits.push_back(pos(o));
-  cnf_api->lcnf(lits);
-}
+  auto it = wide_and_cache.find(new_bv);
+  if(it != wide_and_cache.end())
+  {
+    gates_shared++;
+    return it->second;
+  }
 
-void cnf_convt::gate_or(literalt a, literalt b, literalt o)
-{
-  // a+b=c <==> (a' + c)( b' + c)(a + b + c')
+  // One wide gate: o -> l for every input l, and (all inputs) -> o
+  literalt lit = this->new_variable();
   bvt lits;
+  for(const literalt &l : new_bv)
+  {
+    lits = {pos(l), neg(lit)};
+    cnf_api->lcnf(lits);
+  }
 
   lits.clear();
-  lits.reserve(2);
-  lits.push_back(neg(a));
-  lits.push_back(pos(o));
+  for(const literalt &l : new_bv)
+    lits.push_back(neg(l));
+  lits.push_back(pos(lit));
   cnf_api->lcnf(lits);
 
-  lits.clear();
-  lits.reserve(2);
-  lits.push_back(neg(b));
-  lits.push_back(pos(o));
-  cnf_api->lcnf(lits);
+  wide_and_cache.emplace(std::move(new_bv), lit);
+  return lit;
+}
 
-  lits.clear();
-  lits.reserve(3);
-  lits.push_back(pos(a));
-  lits.push_back(pos(b));
-  lits.push_back(neg(o));
-  cnf_api->lcnf(lits);
+literalt cnf_convt::lor(const bvt &bv)
+{
+  bvt inv;
+  inv.reserve(bv.size());
+  for(const literalt &l : bv)
+    inv.push_back(lnot(l));
+  return lnot(land(inv));
+}
+
+void cnf_convt::gate_xor(literalt a, literalt b, literalt o)
+{
+  // a xor b = o <==> (a' + b' + o')
+  //                  (a + b + o' )
+  //                  (a' + b + o)
+  //                  (a + b' + o)
+  cnf_api->lcnf({neg(a), neg(b), neg(o)});
+  cnf_api->lcnf({pos(a), pos(b), neg(o)});
+  cnf_api->lcnf({neg(a), pos(b), pos(o)});
+  cnf_api->lcnf({pos(a), neg(b), pos(o)});
 }
 
 void cnf_convt::gate_and(literalt a, literalt b, literalt o)
 {
   // a*b=c <==> (a + o')( b + o')(a'+b'+o)
-  bvt lits;
-
-  lits.clear();
-  lits.reserve(2);
-  lits.push_back(pos(a));
-  lits.push_back(neg(o));
-  cnf_api->lcnf(lits);
-
-  lits.clear();
-  lits.reserve(2);
-  lits.push_back(pos(b));
-  lits.push_back(neg(o));
-  cnf_api->lcnf(lits);
+  cnf_api->lcnf({pos(a), neg(o)});
+  cnf_api->lcnf({pos(b), neg(o)});
+  cnf_api->lcnf({neg(a), neg(b), pos(o)});
+}
 
-  lits.clear();
-  lits.reserve(3);
-  lits.push_back(neg(a));
-  lits.push_back(neg(b));
-  lits.push_back(pos(o));
-  cnf_api->lcnf(lits);
+void cnf_convt::gate_select(literalt a, literalt b, literalt c, literalt o)
+{
+  // a?b:c = o <==> (a' + b' + o)(a' + b + o')
+  //                (a + c' + o)(a + c + o')
+  // plus the redundant (b' + c' + o)(b + c + o'), which let propagation
+  // see through the select when both branches agree.
+  cnf_api->lcnf({neg(a), neg(b), pos(o)});
+  cnf_api->lcnf({neg(a), pos(b), neg(o)});
+  cnf_api->lcnf({pos(a), neg(c), pos(o)});
+  cnf_api->lcnf({pos(a), pos(c), neg(o)});
+  cnf_api->lcnf({neg(b), neg(c), pos(o)});
+  cnf_api->lcnf({pos(b), pos(c), neg(o)});
 }
 
 void cnf_convt::set_equal(literalt a, literalt b)
@@ -200,14 +251,6 @@ void cnf_convt::set_equal(literalt a, literalt b)
     return;
   }
 
-  bvt bv;
-  bv.resize(2);
-  bv[0] = a;
-  bv[1] = lnot(b);
-  cnf_api->lcnf(bv);
-
-  bv[0] = lnot(a);
-  bv[1] = b;
-  cnf_api->lcnf(bv);
-  return;
+  cnf_api->lcnf({a, lnot(b)});
+  cnf_api->lcnf({lnot(a), b});
 }
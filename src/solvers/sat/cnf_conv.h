@@ -1,30 +1,81 @@
-#ifndef _ESBMC_SOLVERS_SMT_CNF_CONV_H_
-#define _ESBMC_SOLVERS_SMT_CNF_CONV_H_
+#ifndef _ESBMC_SOLVERS_SAT_CNF_CONV_H_
+#define _ESBMC_SOLVERS_SAT_CNF_CONV_H_
 
-#include <solvers/smt/smt_conv.h>
-#include <bitblast_conv.h>
-#include <cnf_iface.h>
+#include <map>
+#include <solvers/sat/cnf_iface.h>
+#include <solvers/sat/sat_iface.h>
+#include <unordered_map>
 
+/** Gate layer of the SAT backend: reduces logical operations on literals to
+ *  clauses via the Tseitin encoding.
+ *
+ *  Gates are structurally hashed, as in an and-inverter graph. Inputs are
+ *  normalised (ordered, and with negations pushed to the output where the
+ *  gate allows it) and each gate is encoded at most once; asking for it again
+ *  returns the literal of the first encoding. Or-gates are and-gates with
+ *  negated inputs and output, so they share one table.
+ *
+ *  Gate clauses only define their fresh output literal, and are satisfiable
+ *  for any value of the inputs. They are therefore added unconditionally and
+ *  the tables are never popped: a gate encoded in a context that is later
+ *  popped remains valid, and is reused, in the contexts that follow. */
 class cnf_convt : public sat_iface
 {
 public:
   cnf_convt(cnf_iface *cnf_api);
-  ~cnf_convt();
+  ~cnf_convt() override = default;
 
   // The API we're implementing: all reducing to cnf(), eventually.
-  virtual literalt lnot(literalt a);
-  virtual literalt lselect(literalt a, literalt b, literalt c);
-  virtual literalt lequal(literalt a, literalt b);
-  virtual literalt limplies(literalt a, literalt b);
-  virtual literalt lxor(literalt a, literalt b);
-  virtual literalt lor(literalt a, literalt b);
-  virtual literalt land(literalt a, literalt b);
-  virtual void gate_xor(literalt a, literalt b, literalt o);
-  virtual void gate_or(literalt a, literalt b, literalt o);
-  virtual void gate_and(literalt a, literalt b, literalt o);
-  virtual void set_equal(literalt a, literalt b);
+  literalt lnot(literalt a) override;
+  literalt lselect(literalt a, literalt b, literalt c) override;
+  literalt lequal(literalt a, literalt b) override;
+  literalt limplies(literalt a, literalt b) override;
+  literalt lxor(literalt a, literalt b) override;
+  literalt lor(literalt a, literalt b) override;
+  literalt land(literalt a, literalt b) override;
+  literalt land(const bvt &bv) override;
+  literalt lor(const bvt &bv) override;
+  void set_equal(literalt a, literalt b) override;
+
+  void gate_xor(literalt a, literalt b, literalt o);
+  void gate_and(literalt a, literalt b, literalt o);
+  void gate_select(literalt a, literalt b, literalt c, literalt o);
 
   cnf_iface *cnf_api;
+
+  /** Number of gates answered from the tables rather than encoded */
+  unsigned long gates_shared = 0;
+
+protected:
+  static uint64_t key(literalt a, literalt b)
+  {
+    return (uint64_t(a.get()) << 32) | b.get();
+  }
+
+  struct select_keyt
+  {
+    unsigned a, b, c;
+
+    bool operator==(const select_keyt &o) const
+    {
+      return a == o.a && b == o.b && c == o.c;
+    }
+  };
+
+  struct select_hasht
+  {
+    size_t operator()(const select_keyt &k) const
+    {
+      uint64_t h = (uint64_t(k.a) << 32) | k.b;
+      h ^= uint64_t(k.c) * 0x9E3779B97F4A7C15ULL;
+      return std::hash<uint64_t>()(h);
+    }
+  };
+
+  std::unordered_map<uint64_t, literalt> and_cache;
+  std::unordered_map<uint64_t, literalt> xor_cache;
+  std::unordered_map<select_keyt, literalt, select_hasht> select_cache;
+  std::map<bvt, literalt> wide_and_cache;
 };
 
-#endif /* _ESBMC_SOLVERS_SMT_CNF_CONV_H_ */
+#endif /* _ESBMC_SOLVERS_SAT_CNF_CONV_H_ */
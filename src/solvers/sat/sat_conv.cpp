@@ -0,0 +1,105 @@
+#include <solvers/sat/sat_conv.h>
+
+smt_convt *create_new_sat_solver(
+  const optionst &options,
+  const namespacet &ns,
+  tuple_iface **tuple_api [[maybe_unused]],
+  array_iface **array_api [[maybe_unused]],
+  fp_convt **fp_api [[maybe_unused]])
+{
+  return new sat_convt(ns, options);
+}
+
+sat_convt::sat_convt(const namespacet &_ns, const optionst &options)
+  : cnf_iface(),
+    cnf_convt(static_cast<cnf_iface *>(this)),
+    bitblast_convt(_ns, options, static_cast<sat_iface *>(this))
+{
+}
+
+void sat_convt::push_ctx()
+{
+  smt_convt::push_ctx();
+  activations.push_back(new_variable());
+}
+
+void sat_convt::pop_ctx()
+{
+  setto(activations.back(), false);
+  activations.pop_back();
+  smt_convt::pop_ctx();
+}
+
+smt_convt::resultt sat_convt::dec_solve()
+{
+  pre_solve();
+
+  bool sat = solver.solve(activations);
+
+  log_debug(
+    "sat",
+    "{} variables, {} clauses, {} gates shared, {} decisions, {} conflicts, "
+    "{} clauses subsumed, {} strengthened",
+    solver.no_variables(),
+    solver.no_clauses(),
+    gates_shared,
+    solver.stats.decisions,
+    solver.stats.conflicts,
+    solver.stats.subsumed,
+    solver.stats.strengthened);
+
+  return sat ? P_SATISFIABLE : P_UNSATISFIABLE;
+}
+
+const std::string sat_convt::solver_text()
+{
+  return "Built-in SAT solver";
+}
+
+void sat_convt::assert_ast(smt_astt a)
+{
+  assert(a->sort->id == SMT_SORT_BOOL);
+  literalt l = bits(a)[0];
+
+  // Assertions only hold within the context they were made in
+  if(activations.empty())
+    lcnf({l});
+  else
+    lcnf({l, lnot(activations.back())});
+}
+
+tvt sat_convt::l_get(const literalt &a)
+{
+  return solver.l_get(a);
+}
+
+literalt sat_convt::new_variable()
+{
+  return literalt(solver.new_variable(), false);
+}
+
+void sat_convt::assert_lit(const literalt &l)
+{
+  lcnf({l});
+}
+
+void sat_convt::lcnf(const bvt &bv)
+{
+  // Constants are resolved here, the solver never sees them
+  bvt new_bv;
+  new_bv.reserve(bv.size());
+  for(const literalt &l : bv)
+  {
+    if(l.is_true())
+      return;
+    if(!l.is_false())
+      new_bv.push_back(l);
+  }
+
+  solver.add_clause(new_bv);
+}
+
+void sat_convt::setto(literalt a, bool val)
+{
+  lcnf({a.cond_negation(!val)});
+}
@@ -0,0 +1,43 @@
+#ifndef _ESBMC_SOLVERS_SAT_SAT_CONV_H_
+#define _ESBMC_SOLVERS_SAT_SAT_CONV_H_
+
+#include <solvers/sat/bitblast_conv.h>
+#include <solvers/sat/cnf_conv.h>
+#include <solvers/sat/sat_solver.h>
+
+/** The bit-blasting SAT backend: bitblast_convt flattens to literals,
+ *  cnf_convt to clauses, and those go to the in-tree sat_solvert.
+ *
+ *  Contexts are handled with activation literals. Each push creates a fresh
+ *  literal, assertions made in the context become clauses guarded by it, and
+ *  solving assumes the literals of all open contexts. A pop asserts the
+ *  negation of its literal, which retires the guarded clauses for good; the
+ *  solver's preprocessing then deletes them. Nothing else needs undoing:
+ *  gates and symbols are shared by all contexts. */
+class sat_convt : public cnf_iface, public cnf_convt, public bitblast_convt
+{
+public:
+  sat_convt(const namespacet &_ns, const optionst &options);
+  ~sat_convt() override = default;
+
+  void push_ctx() override;
+  void pop_ctx() override;
+  resultt dec_solve() override;
+  const std::string solver_text() override;
+  void assert_ast(smt_astt a) override;
+
+  using bitblast_convt::l_get;
+  tvt l_get(const literalt &a) override;
+  literalt new_variable() override;
+  void assert_lit(const literalt &l) override;
+  void lcnf(const bvt &bv) override;
+  void setto(literalt a, bool val) override;
+
+  // Members
+  sat_solvert solver;
+
+  /** Activation literal of each open context, outermost first */
+  bvt activations;
+};
+
+#endif /* _ESBMC_SOLVERS_SAT_SAT_CONV_H_ */
@@ -1,6 +1,9 @@
 #ifndef _ESBMC_SOLVERS_SAT_SAT_IFACE_H_
 #define _ESBMC_SOLVERS_SAT_SAT_IFACE_H_
 
+#include <solvers/prop/literal.h>
+#include <util/threeval.h>
+
 // An interface for defining a SAT interface within ESBMC, as used by the
 // SAT bitblaster. I anticipate that nothing else actually needs to use this
 // interface, except perhaps sat solvers that have non-cnf inputs.
@@ -8,6 +11,8 @@
 class sat_iface
 {
 public:
+  virtual ~sat_iface() = default;
+
   virtual void lcnf(const bvt &bv) = 0;
   virtual literalt lnot(literalt a) = 0;
   virtual literalt lselect(literalt a, literalt b, literalt c) = 0;
@@ -16,6 +21,8 @@ public:
   virtual literalt lxor(literalt a, literalt b) = 0;
   virtual literalt land(literalt a, literalt b) = 0;
   virtual literalt lor(literalt a, literalt b) = 0;
+  virtual literalt land(const bvt &bv) = 0;
+  virtual literalt lor(const bvt &bv) = 0;
   virtual void set_equal(literalt a, literalt b) = 0;
   virtual void assert_lit(const literalt &a) = 0;
   virtual tvt l_get(const literalt &a) = 0;
@@ -0,0 +1,749 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <solvers/sat/sat_solver.h>
+
+namespace
+{
+const double var_decay = 0.95;
+const double clause_decay = 0.999;
+const int64_t restart_base = 100;
+const double learnt_growth = 1.05;
+
+// Bounds the work of a single subsumption pass, in literal comparisons
+const uint64_t subsume_budget = 20000000;
+
+// Finite subsequences of the Luby sequence: 1, 1, 2, 1, 1, 2, 4, 1, ...
+double luby(double y, int x)
+{
+  int size, seq;
+  for(size = 1, seq = 0; size < x + 1; seq++, size = 2 * size + 1)
+    ;
+
+  while(size - 1 != x)
+  {
+    size = (size - 1) >> 1;
+    seq--;
+    x = x % size;
+  }
+
+  return std::pow(y, seq);
+}
+} // namespace
+
+void sat_solvert::var_ordert::insert(unsigned v)
+{
+  if(v >= indices.size())
+    indices.resize(v + 1, -1);
+  assert(!contains(v));
+
+  indices[v] = heap.size();
+  heap.push_back(v);
+  percolate_up(indices[v]);
+}
+
+unsigned sat_solvert::var_ordert::remove_max()
+{
+  unsigned v = heap[0];
+  heap[0] = heap.back();
+  indices[heap[0]] = 0;
+  indices[v] = -1;
+  heap.pop_back();
+  if(heap.size() > 1)
+    percolate_down(0);
+  return v;
+}
+
+void sat_solvert::var_ordert::percolate_up(int i)
+{
+  unsigned v = heap[i];
+  while(i != 0)
+  {
+    int parent = (i - 1) >> 1;
+    if(!lt(v, heap[parent]))
+      break;
+    heap[i] = heap[parent];
+    indices[heap[i]] = i;
+    i = parent;
+  }
+  heap[i] = v;
+  indices[v] = i;
+}
+
+void sat_solvert::var_ordert::percolate_down(int i)
+{
+  unsigned v = heap[i];
+  int n = heap.size();
+  while(2 * i + 1 < n)
+  {
+    int child = 2 * i + 1;
+    if(child + 1 < n && lt(heap[child + 1], heap[child]))
+      child++;
+    if(!lt(heap[child], v))
+      break;
+    heap[i] = heap[child];
+    indices[heap[i]] = i;
+    i = child;
+  }
+  heap[i] = v;
+  indices[v] = i;
+}
+
+sat_solvert::sat_solvert()
+  : ok(true),
+    order(activity),
+    qhead(0),
+    var_inc(1),
+    cla_inc(1),
+    max_learnts(0),
+    simp_trail(0),
+    simp_clauses(0)
+{
+}
+
+sat_solvert::~sat_solvert()
+{
+  for(clauset *c : clauses)
+    delete c;
+  for(clauset *c : learnts)
+    delete c;
+}
+
+unsigned sat_solvert::new_variable()
+{
+  unsigned v = assigns.size();
+  assert(v < literalt::const_var_no());
+  assigns.push_back(0);
+  level.push_back(0);
+  reason.push_back(nullptr);
+  polarity.push_back(1);
+  seen.push_back(0);
+  activity.push_back(0);
+  watches.emplace_back();
+  watches.emplace_back();
+  order.insert(v);
+  return v;
+}
+
+bool sat_solvert::add_clause(const bvt &bv)
+{
+  assert(decision_level() == 0);
+  if(!ok)
+    return false;
+
+  std::vector<litt> lits;
+  lits.reserve(bv.size());
+  for(const literalt &l : bv)
+  {
+    assert(!l.is_constant() && l.var_no() < no_variables());
+    lits.push_back(l.get());
+  }
+
+  // Drop duplicate and false literals, and clauses that are already true
+  std::sort(lits.begin(), lits.end());
+  size_t j = 0;
+  litt prev = lit_undef;
+  for(litt p : lits)
+  {
+    if(value(p) == 1 || p == (prev ^ 1))
+      return true;
+    if(value(p) != -1 && p != prev)
+      lits[j++] = prev = p;
+  }
+  lits.resize(j);
+
+  if(lits.empty())
+    return ok = false;
+
+  if(lits.size() == 1)
+  {
+    enqueue(lits[0], nullptr);
+    return ok = (propagate() == nullptr);
+  }
+
+  clauset *c = new clauset{false, false, 0, 0, std::move(lits)};
+  clauses.push_back(c);
+  attach(c);
+  return true;
+}
+
+tvt sat_solvert::l_get(literalt a) const
+{
+  if(a.is_constant())
+    return tvt(a.is_true());
+
+  if(a.var_no() >= model.size() || model[a.var_no()] == 0)
+    return tvt(tvt::TV_UNKNOWN);
+
+  bool val = model[a.var_no()] > 0;
+  return tvt(a.sign() ? !val : val);
+}
+
+void sat_solvert::enqueue(litt p, clauset *from)
+{
+  unsigned v = p >> 1;
+  assert(assigns[v] == 0);
+  assigns[v] = (p & 1) ? -1 : 1;
+  level[v] = decision_level();
+  reason[v] = from;
+  trail.push_back(p);
+}
+
+void sat_solvert::attach(clauset *c)
+{
+  assert(c->lits.size() > 1);
+  watches[c->lits[0] ^ 1].push_back({c, c->lits[1]});
+  watches[c->lits[1] ^ 1].push_back({c, c->lits[0]});
+}
+
+bool sat_solvert::locked(const clauset *c) const
+{
+  litt p = c->lits[0];
+  return reason[p >> 1] == c && value(p) == 1;
+}
+
+sat_solvert::clauset *sat_solvert::propagate()
+{
+  clauset *confl = nullptr;
+
+  while(qhead < trail.size())
+  {
+    // Clauses watching the negation of p have just lost a watch
+    litt p = trail[qhead++];
+    litt false_lit = p ^ 1;
+    std::vector<watcht> &ws = watches[p];
+    stats.propagations++;
+
+    size_t i = 0, j = 0;
+    while(i < ws.size())
+    {
+      litt blocker = ws[i].blocker;
+      if(value(blocker) == 1)
+      {
+        ws[j++] = ws[i++];
+        continue;
+      }
+
+      clauset &c = *ws[i].c;
+      litt *lits = c.lits.data();
+      if(lits[0] == false_lit)
+        std::swap(lits[0], lits[1]);
+      assert(lits[1] == false_lit);
+      i++;
+
+      litt first = lits[0];
+      watcht w{&c, first};
+      if(first != blocker && value(first) == 1)
+      {
+        ws[j++] = w;
+        continue;
+      }
+
+      // Look for a new literal to watch
+      bool found = false;
+      for(size_t k = 2; k < c.lits.size(); k++)
+        if(value(lits[k]) != -1)
+        {
+          std::swap(lits[1], lits[k]);
+          watches[lits[1] ^ 1].push_back(w);
+          found = true;
+          break;
+        }
+      if(found)
+        continue;
+
+      // The clause is unit or conflicting
+      ws[j++] = w;
+      if(value(first) == -1)
+      {
+        confl = &c;
+        qhead = trail.size();
+        while(i < ws.size())
+          ws[j++] = ws[i++];
+      }
+      else
+        enqueue(first, &c);
+    }
+    ws.resize(j);
+
+    if(confl != nullptr)
+      break;
+  }
+
+  return confl;
+}
+
+void sat_solvert::analyze(clauset *confl, std::vector<litt> &out, unsigned &bt)
+{
+  int path = 0;
+  litt p = lit_undef;
+  size_t index = trail.size();
+
+  // Leave room for the asserting literal
+  out.push_back(lit_undef);
+
+  do
+  {
+    assert(confl != nullptr);
+    if(confl->learnt)
+      bump_clause(*confl);
+
+    const std::vector<litt> &c = confl->lits;
+    for(size_t j = (p == lit_undef) ? 0 : 1; j < c.size(); j++)
+    {
+      litt q = c[j];
+      unsigned v = q >> 1;
+      if(!seen[v] && level[v] > 0)
+      {
+        bump_var(v);
+        seen[v] = 1;
+        if(level[v] >= decision_level())
+          path++;
+        else
+          out.push_back(q);
+      }
+    }
+
+    // Select the next literal of the current level to look at
+    while(!seen[trail[--index] >> 1])
+      ;
+    p = trail[index];
+    confl = reason[p >> 1];
+    seen[p >> 1] = 0;
+    path--;
+  } while(path > 0);
+  out[0] = p ^ 1;
+
+  // Drop literals implied by the others
+  std::vector<litt> to_clear(out);
+  size_t j = 1;
+  for(size_t i = 1; i < out.size(); i++)
+  {
+    const clauset *r = reason[out[i] >> 1];
+    if(r == nullptr)
+    {
+      out[j++] = out[i];
+      continue;
+    }
+
+    for(size_t k = 1; k < r->lits.size(); k++)
+    {
+      unsigned v = r->lits[k] >> 1;
+      if(!seen[v] && level[v] > 0)
+      {
+        out[j++] = out[i];
+        break;
+      }
+    }
+  }
+  out.resize(j);
+
+  // Backjump to the second highest level in the clause, whose literal
+  // becomes the second watch
+  bt = 0;
+  if(out.size() > 1)
+  {
+    size_t max_i = 1;
+    for(size_t i = 2; i < out.size(); i++)
+      if(level[out[i] >> 1] > level[out[max_i] >> 1])
+        max_i = i;
+    std::swap(out[1], out[max_i]);
+    bt = level[out[1] >> 1];
+  }
+
+  for(litt l : to_clear)
+    seen[l >> 1] = 0;
+}
+
+void sat_solvert::cancel_until(unsigned lvl)
+{
+  if(decision_level() <= lvl)
+    return;
+
+  for(size_t i = trail.size(); i > trail_lim[lvl]; i--)
+  {
+    unsigned v = trail[i - 1] >> 1;
+    assigns[v] = 0;
+    reason[v] = nullptr;
+    polarity[v] = trail[i - 1] & 1;
+    if(!order.contains(v))
+      order.insert(v);
+  }
+
+  qhead = trail_lim[lvl];
+  trail.resize(trail_lim[lvl]);
+  trail_lim.resize(lvl);
+}
+
+sat_solvert::litt sat_solvert::pick_branch()
+{
+  while(!order.empty())
+  {
+    unsigned v = order.remove_max();
+    if(assigns[v] == 0)
+      return (v << 1) | polarity[v];
+  }
+  return lit_undef;
+}
+
+void sat_solvert::bump_var(unsigned v)
+{
+  if((activity[v] += var_inc) > 1e100)
+  {
+    for(double &a : activity)
+      a *= 1e-100;
+    var_inc *= 1e-100;
+  }
+
+  if(order.contains(v))
+    order.increased(v);
+}
+
+void sat_solvert::bump_clause(clauset &c)
+{
+  if((c.activity += cla_inc) > 1e20)
+  {
+    for(clauset *l : learnts)
+      l->activity *= 1e-20;
+    cla_inc *= 1e-20;
+  }
+}
+
+int sat_solvert::search(int64_t nof_conflicts)
+{
+  int64_t conflicts = 0;
+  std::vector<litt> learnt;
+
+  for(;;)
+  {
+    clauset *confl = propagate();
+    if(confl != nullptr)
+    {
+      stats.conflicts++;
+      conflicts++;
+      if(decision_level() == 0)
+      {
+        ok = false;
+        return -1;
+      }
+
+      unsigned bt;
+      learnt.clear();
+      analyze(confl, learnt, bt);
+      cancel_until(bt);
+
+      if(learnt.size() == 1)
+        enqueue(learnt[0], nullptr);
+      else
+      {
+        clauset *c = new clauset{true, false, 0, 0, learnt};
+        learnts.push_back(c);
+        attach(c);
+        bump_clause(*c);
+        enqueue(learnt[0], c);
+      }
+
+      var_inc *= 1 / var_decay;
+      cla_inc *= 1 / clause_decay;
+      continue;
+    }
+
+    if(nof_conflicts >= 0 && conflicts >= nof_conflicts)
+    {
+      cancel_until(0);
+      return 0;
+    }
+
+    if(learnts.size() >= max_learnts + trail.size())
+      reduce_db();
+
+    // Assumptions are decided first, one per decision level
+    litt next = lit_undef;
+    while(decision_level() < assumptions.size())
+    {
+      litt p = assumptions[decision_level()];
+      if(value(p) == 1)
+        trail_lim.push_back(trail.size());
+      else if(value(p) == -1)
+        return -1;
+      else
+      {
+        next = p;
+        break;
+      }
+    }
+
+    if(next == lit_undef)
+    {
+      stats.decisions++;
+      next = pick_branch();
+      if(next == lit_undef)
+        return 1;
+    }
+
+    trail_lim.push_back(trail.size());
+    enqueue(next, nullptr);
+  }
+}
+
+void sat_solvert::reduce_db()
+{
+  // Remove half of the learnt clauses, least active first, keeping binary
+  // clauses and the reasons of current assignments
+  std::sort(
+    learnts.begin(), learnts.end(), [](const clauset *a, const clauset *b) {
+      if((a->lits.size() > 2) != (b->lits.size() > 2))
+        return a->lits.size() > 2;
+      return a->activity < b->activity;
+    });
+
+  double extra_lim = cla_inc / learnts.size();
+  size_t half = learnts.size() / 2;
+  for(size_t i = 0; i < learnts.size(); i++)
+  {
+    clauset *c = learnts[i];
+    if(
+      c->lits.size() > 2 && !locked(c) &&
+      (i < half || c->activity < extra_lim))
+      c->removed = true;
+  }
+
+  purge_watches();
+
+  size_t j = 0;
+  for(clauset *c : learnts)
+  {
+    if(c->removed)
+      delete c;
+    else
+      learnts[j++] = c;
+  }
+  learnts.resize(j);
+}
+
+void sat_solvert::purge_watches()
+{
+  for(std::vector<watcht> &ws : watches)
+    ws.erase(
+      std::remove_if(
+        ws.begin(), ws.end(), [](const watcht &w) { return w.c->removed; }),
+      ws.end());
+}
+
+bool sat_solvert::solve(const bvt &assumps)
+{
+  model.clear();
+  if(!ok)
+    return false;
+
+  assert(decision_level() == 0);
+  preprocess();
+  if(!ok)
+    return false;
+
+  assumptions.clear();
+  for(const literalt &l : assumps)
+  {
+    assert(!l.is_constant() && l.var_no() < no_variables());
+    assumptions.push_back(l.get());
+  }
+
+  max_learnts = std::max(clauses.size() / 3.0, 2000.0);
+
+  int status = 0;
+  for(int restarts = 0; status == 0; restarts++)
+  {
+    stats.restarts++;
+    status = search(luby(2, restarts) * restart_base);
+    max_learnts *= learnt_growth;
+  }
+
+  if(status == 1)
+    model = assigns;
+
+  cancel_until(0);
+  return status == 1;
+}
+
+void sat_solvert::preprocess()
+{
+  if(propagate() != nullptr)
+  {
+    ok = false;
+    return;
+  }
+
+  // Only worth the rebuild when something changed noticeably
+  if(
+    trail.size() == simp_trail &&
+    clauses.size() < simp_clauses + simp_clauses / 10 + 100)
+    return;
+
+  // Level zero assignments are never analysed, so their reasons can go
+  for(litt p : trail)
+    reason[p >> 1] = nullptr;
+
+  for(std::vector<watcht> &ws : watches)
+    ws.clear();
+
+  // Drop satisfied clauses and false literals
+  std::vector<clauset *> units;
+  for(std::vector<clauset *> *db : {&clauses, &learnts})
+    for(clauset *c : *db)
+    {
+      std::vector<litt> &lits = c->lits;
+      size_t j = 0;
+      for(litt p : lits)
+      {
+        if(value(p) == 1)
+        {
+          c->removed = true;
+          break;
+        }
+        if(value(p) == 0)
+          lits[j++] = p;
+      }
+      if(c->removed)
+        continue;
+      lits.resize(j);
+      if(lits.size() < 2)
+        units.push_back(c);
+    }
+
+  subsume(units);
+
+  for(clauset *c : units)
+  {
+    if(c->removed)
+      continue;
+    c->removed = true;
+    if(c->lits.empty())
+      ok = false;
+    else if(value(c->lits[0]) == 0)
+      enqueue(c->lits[0], nullptr);
+    else if(value(c->lits[0]) == -1)
+      ok = false;
+  }
+
+  for(std::vector<clauset *> *db : {&clauses, &learnts})
+  {
+    size_t j = 0;
+    for(clauset *c : *db)
+    {
+      if(c->removed)
+        delete c;
+      else
+      {
+        attach(c);
+        (*db)[j++] = c;
+      }
+    }
+    db->resize(j);
+  }
+
+  if(ok && propagate() != nullptr)
+    ok = false;
+
+  simp_trail = trail.size();
+  simp_clauses = clauses.size();
+}
+
+void sat_solvert::subsume(std::vector<clauset *> &units)
+{
+  // Occurrence lists over variables, of the original clauses only
+  std::vector<std::vector<clauset *>> occurs(no_variables());
+  std::vector<clauset *> queue;
+  for(clauset *c : clauses)
+  {
+    if(c->removed || c->lits.size() < 2)
+      continue;
+
+    c->abst = 0;
+    for(litt p : c->lits)
+    {
+      occurs[p >> 1].push_back(c);
+      c->abst |= uint64_t(1) << ((p >> 1) & 63);
+    }
+    queue.push_back(c);
+  }
+
+  std::stable_sort(
+    queue.begin(), queue.end(), [](const clauset *a, const clauset *b) {
+      return a->lits.size() < b->lits.size();
+    });
+
+  uint64_t work = 0;
+  for(size_t q = 0; q < queue.size() && work < subsume_budget; q++)
+  {
+    clauset &c = *queue[q];
+    if(c.removed || c.lits.size() < 2)
+      continue;
+
+    // Candidates share every variable of c, so any one of its occurrence
+    // lists will do: pick the shortest
+    unsigned best = c.lits[0] >> 1;
+    for(litt p : c.lits)
+      if(occurs[p >> 1].size() < occurs[best].size())
+        best = p >> 1;
+
+    for(clauset *d : occurs[best])
+    {
+      if(
+        d == &c || d->removed || d->lits.size() < c.lits.size() ||
+        (c.abst & ~d->abst) != 0)
+        continue;
+
+      work += c.lits.size() + d->lits.size();
+      litt p = subsumes(c, *d);
+      if(p == lit_undef)
+      {
+        d->removed = true;
+        stats.subsumed++;
+      }
+      else if(p != lit_undef - 1)
+      {
+        // Resolving on p strengthens d by removing the negation of p
+        std::vector<litt> &lits = d->lits;
+        lits.erase(std::find(lits.begin(), lits.end(), p ^ 1));
+        stats.strengthened++;
+
+        d->abst = 0;
+        for(litt l : lits)
+          d->abst |= uint64_t(1) << ((l >> 1) & 63);
+
+        if(lits.size() < 2)
+          units.push_back(d);
+        else
+          queue.push_back(d);
+      }
+    }
+  }
+}
+
+sat_solvert::litt sat_solvert::subsumes(const clauset &c, const clauset &d)
+{
+  // Returns lit_undef if c subsumes d; a literal p of c if c with p negated
+  // would, so that d can drop the negation of p; and lit_undef - 1 otherwise
+  litt ret = lit_undef;
+  for(litt p : c.lits)
+  {
+    bool found = false;
+    for(litt q : d.lits)
+    {
+      if(p == q)
+      {
+        found = true;
+        break;
+      }
+      if(ret == lit_undef && p == (q ^ 1))
+      {
+        ret = p;
+        found = true;
+        break;
+      }
+    }
+    if(!found)
+      return lit_undef - 1;
+  }
+  return ret;
+}
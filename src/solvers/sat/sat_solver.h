@@ -0,0 +1,187 @@
+#ifndef _ESBMC_SOLVERS_SAT_SAT_SOLVER_H_
+#define _ESBMC_SOLVERS_SAT_SAT_SOLVER_H_
+
+#include <cstdint>
+#include <solvers/prop/literal.h>
+#include <util/threeval.h>
+#include <vector>
+
+/** A small CDCL SAT solver, kept in-tree so that the bit-blasting backend has
+ *  no external dependencies.
+ *
+ *  The design follows MiniSat: two watched literals with blocking literals,
+ *  VSIDS decisions with phase saving, first-UIP learning with local clause
+ *  minimisation, Luby restarts and activity based deletion of learnt clauses.
+ *
+ *  Literals are those of literalt, i.e. twice the variable number plus one if
+ *  negated; the constant variable of literalt must never be passed in here.
+ *
+ *  The solver is incremental: clauses may be added between calls to solve(),
+ *  and solve() accepts a set of assumptions that only hold for that call.
+ *  Everything learnt is a consequence of the clause set alone, so it stays
+ *  valid across calls.
+ *
+ *  Before searching, solve() preprocesses the clause set at decision level
+ *  zero: satisfied clauses and false literals are removed, and clauses are
+ *  reduced by subsumption and self-subsuming resolution. These keep the
+ *  clause set equivalent, which is what makes them safe for incremental use;
+ *  variable elimination does not, and is not performed. */
+class sat_solvert
+{
+public:
+  sat_solvert();
+  ~sat_solvert();
+
+  sat_solvert(const sat_solvert &) = delete;
+  sat_solvert &operator=(const sat_solvert &) = delete;
+
+  /** Returns a fresh variable number */
+  unsigned new_variable();
+
+  unsigned no_variables() const
+  {
+    return assigns.size();
+  }
+
+  /** Adds a clause. Returns false once the clause set is known to be
+   *  unsatisfiable, after which every solve() fails. */
+  bool add_clause(const bvt &bv);
+
+  /** Decides the clause set, with each of the assumptions taken to be true.
+   *  Returns true if satisfiable; the model is then available via l_get. */
+  bool solve(const bvt &assumptions);
+
+  /** Value of a literal in the model found by the last successful solve.
+   *  Variables created since are unknown. */
+  tvt l_get(literalt a) const;
+
+  struct statst
+  {
+    uint64_t decisions = 0;
+    uint64_t propagations = 0;
+    uint64_t conflicts = 0;
+    uint64_t restarts = 0;
+    uint64_t subsumed = 0;
+    uint64_t strengthened = 0;
+  } stats;
+
+  size_t no_clauses() const
+  {
+    return clauses.size();
+  }
+
+private:
+  typedef unsigned litt;
+  static constexpr litt lit_undef = ~0u;
+
+  struct clauset
+  {
+    bool learnt;
+    bool removed;
+    float activity;
+    uint64_t abst;
+    std::vector<litt> lits;
+  };
+
+  struct watcht
+  {
+    clauset *c;
+    litt blocker;
+  };
+
+  /** Binary max-heap of unassigned variables, ordered by activity */
+  class var_ordert
+  {
+  public:
+    explicit var_ordert(const std::vector<double> &_activity)
+      : activity(_activity)
+    {
+    }
+
+    bool empty() const
+    {
+      return heap.empty();
+    }
+    bool contains(unsigned v) const
+    {
+      return v < indices.size() && indices[v] >= 0;
+    }
+    void insert(unsigned v);
+    void increased(unsigned v)
+    {
+      percolate_up(indices[v]);
+    }
+    unsigned remove_max();
+
+  private:
+    const std::vector<double> &activity;
+    std::vector<unsigned> heap;
+    std::vector<int> indices;
+
+    bool lt(unsigned a, unsigned b) const
+    {
+      return activity[a] > activity[b];
+    }
+    void percolate_up(int i);
+    void percolate_down(int i);
+  };
+
+  bool ok;
+
+  std::vector<clauset *> clauses;
+  std::vector<clauset *> learnts;
+  std::vector<std::vector<watcht>> watches;
+
+  /** Per variable: 1 true, -1 false, 0 unassigned */
+  std::vector<int8_t> assigns;
+  std::vector<int8_t> model;
+  std::vector<unsigned> level;
+  std::vector<clauset *> reason;
+  std::vector<uint8_t> polarity;
+  std::vector<uint8_t> seen;
+  std::vector<double> activity;
+  var_ordert order;
+
+  std::vector<litt> trail;
+  std::vector<unsigned> trail_lim;
+  size_t qhead;
+  std::vector<litt> assumptions;
+
+  double var_inc;
+  double cla_inc;
+  double max_learnts;
+
+  /** Trail and clause counts at the end of the last preprocessing run */
+  size_t simp_trail;
+  size_t simp_clauses;
+
+  int8_t value(litt p) const
+  {
+    int8_t v = assigns[p >> 1];
+    return (p & 1) ? -v : v;
+  }
+
+  unsigned decision_level() const
+  {
+    return trail_lim.size();
+  }
+
+  void enqueue(litt p, clauset *from);
+  void attach(clauset *c);
+  bool locked(const clauset *c) const;
+  clauset *propagate();
+  void analyze(clauset *confl, std::vector<litt> &out, unsigned &bt);
+  void cancel_until(unsigned lvl);
+  litt pick_branch();
+  int search(int64_t nof_conflicts);
+  void reduce_db();
+  void purge_watches();
+  void bump_var(unsigned v);
+  void bump_clause(clauset &c);
+
+  void preprocess();
+  void subsume(std::vector<clauset *> &units);
+  static litt subsumes(const clauset &c, const clauset &d);
+};
+
+#endif /* _ESBMC_SOLVERS_SAT_SAT_SOLVER_H_ */
@@ -20,7 +20,10 @@ static inline bool array_indexes_are_same(
   return true;
 }
 
-array_convt::array_convt(smt_convt *_ctx) : array_iface(true, true), ctx(_ctx)
+array_convt::array_convt(smt_convt *_ctx)
+  : array_iface(true, true),
+    lazy_axioms(_ctx->options.get_bool_option("array-refinement")),
+    ctx(_ctx)
 {
 }
 
@@ -583,6 +586,16 @@ void array_convt::pop_array_ctx()
   array_valuation.resize(num_arrays); // terrible terrible damage
 
   array_equalities.erase(target_ctx); // Erase everything with that idx
+  // Lemmas of the popped context are gone and may be needed again, those of
+  // the outer ones still hold
+  for(auto it = lazy_lemmas.begin(); it != lazy_lemmas.end();)
+    it = it->second >= target_ctx ? lazy_lemmas.erase(it) : std::next(it);
+  lazy_updates.erase(
+    std::remove_if(
+      lazy_updates.begin(),
+      lazy_updates.end(),
+      [target_ctx](const lazy_update &u) { return u.ctx_level == target_ctx; }),
+    lazy_updates.end());
   auto &ctx_idx = array_of_vals.get<1>();
   ctx_idx.erase(target_ctx); // Similar
 
@@ -1104,6 +1117,24 @@ void array_convt::execute_array_trans(
         start_point);
     }
   }
+  else if(lazy_axioms)
+  {
+    // Only the updated element is known, the rest is left to
+    // refine_array_model. Selects at that index may already use the free
+    // value collate_array_values put there, so constrain it instead of
+    // replacing it.
+    auto it = expr_index_map[arr].find(w.idx);
+    assert(it != expr_index_map[arr].end());
+    ctx->assert_ast(dest_data[it->vec_idx]->eq(ctx, w.u.w.val));
+
+    lazy_update u;
+    u.array_id = arr;
+    u.update_num = idx + 1;
+    u.start_point = start_point;
+    u.end_point = dest_data.size();
+    u.ctx_level = ctx->ctx_level;
+    lazy_updates.push_back(u);
+  }
   else
   {
     execute_array_update(
@@ -1303,6 +1334,9 @@ void array_convt::add_initial_ackerman_constraints(
   // Add ackerman constraints: these state that for each element of an array,
   // where the indexes are equivalent (in the solver), then the value of the
   // elements are equivalent. The cost is quadratic, alas.
+  // Unless they're added lazily, see refine_array_model.
+  if(lazy_axioms)
+    return;
 
   for(auto const &it : idx_map)
   {
@@ -1324,6 +1358,126 @@ void array_convt::add_initial_ackerman_constraints(
   }
 }
 
+bool array_convt::model_equal(smt_astt a, smt_astt b)
+{
+  if(a == b)
+    return true;
+
+  // Compare values where we can fetch them, otherwise ask for the equality
+  switch(a->sort->id)
+  {
+  case SMT_SORT_BOOL:
+    return ctx->get_bool(a) == ctx->get_bool(b);
+  case SMT_SORT_BV:
+  case SMT_SORT_FIXEDBV:
+  case SMT_SORT_BVFP:
+  case SMT_SORT_BVFP_RM:
+    return ctx->get_bv(a, false) == ctx->get_bv(b, false);
+  default:
+    // An equality made after the solve has no value in the model. Assume
+    // they differ, refine_array_model collects each lemma only once.
+    return false;
+  }
+}
+
+const BigInt &
+array_convt::model_index_value(const expr2tc &idx, index_valuest &values)
+{
+  // Evaluated in the model, so that indexes of any shape compare by value
+  auto it = values.find(idx);
+  if(it == values.end())
+    it = values
+           .emplace(
+             idx,
+             ctx->get_bv(ctx->convert_ast(idx), is_signedbv_type(idx)))
+           .first;
+  return it->second;
+}
+
+bool array_convt::model_same_index(
+  const expr2tc &a,
+  const expr2tc &b,
+  index_valuest &values)
+{
+  return model_index_value(a, values) == model_index_value(b, values);
+}
+
+void array_convt::refine_array_model(std::vector<smt_astt> &lemmas)
+{
+  if(!lazy_axioms)
+    return;
+
+  // Index values in this model, each index is fetched only once
+  index_valuest values;
+  unsigned int num_lemmas = 0;
+
+  // Read-over-write: an element not written to by an update keeps the value
+  // it had before.
+  for(const lazy_update &u : lazy_updates)
+  {
+    const array_with &w = get_array_update(u.array_id, u.update_num);
+    smt_astt update_idx_ast = ctx->convert_ast(w.idx);
+
+    for(auto const &rec : expr_index_map[u.array_id])
+    {
+      if(rec.vec_idx < u.start_point || rec.vec_idx >= u.end_point)
+        continue;
+      if(rec.idx == w.idx)
+        continue;
+
+      // Indexes are all converted already, this doesn't disturb the vectors
+      smt_astt dest = array_valuation[u.array_id][u.update_num][rec.vec_idx];
+      smt_astt src =
+        array_valuation[u.array_id][w.u.w.src_array_update_num][rec.vec_idx];
+
+      bool hit = model_same_index(w.idx, rec.idx, values);
+      if(model_equal(dest, hit ? w.u.w.val : src))
+        continue;
+      if(!lazy_lemmas.emplace(std::make_pair(dest, src), ctx->ctx_level).second)
+        continue;
+
+      // Same constraint as execute_array_update
+      smt_astt cond = update_idx_ast->eq(ctx, ctx->convert_ast(rec.idx));
+      smt_astt dest_ite = w.u.w.val->ite(ctx, cond, src);
+      lemmas.push_back(dest->eq(ctx, dest_ite));
+      num_lemmas++;
+    }
+  }
+
+  // Ackerman: elements at equal indexes have equal initial values. Group the
+  // indexes by their value in the model and compare each with the first one
+  // of its group.
+  for(unsigned int arrid = 0; arrid < array_valuation.size(); arrid++)
+  {
+    const ast_vect &vals = array_valuation[arrid][0];
+    std::map<BigInt, const index_map_rec *> firsts;
+
+    for(auto const &rec : expr_index_map[arrid])
+    {
+      const BigInt &v = model_index_value(rec.idx, values);
+      auto [it, first] = firsts.emplace(v, &rec);
+      if(first || model_equal(vals[it->second->vec_idx], vals[rec.vec_idx]))
+        continue;
+      if(!lazy_lemmas
+            .emplace(
+              std::make_pair(vals[it->second->vec_idx], vals[rec.vec_idx]),
+              ctx->ctx_level)
+            .second)
+        continue;
+
+      smt_astt idxeq = ctx->convert_ast(it->second->idx)
+                         ->eq(ctx, ctx->convert_ast(rec.idx));
+      smt_astt valeq =
+        vals[it->second->vec_idx]->eq(ctx, vals[rec.vec_idx]);
+      lemmas.push_back(ctx->mk_implies(idxeq, valeq));
+      num_lemmas++;
+    }
+  }
+
+  if(num_lemmas != 0)
+    log_debug("array", "Found {} violated array lemmas", num_lemmas);
+}
+
 smt_astt array_ast::eq(smt_convt *ctx [[maybe_unused]], smt_astt sym) const
 {
   const array_ast *other = array_downcast(sym);
@@ -16,7 +16,9 @@
 //
 // As a result, this particular class is due some serious maintenence.
 
+#include <map>
 #include <set>
+#include <unordered_map>
 #include <solvers/smt/smt_conv.h>
 #include <irep2/irep2.h>
 
@@ -138,6 +140,7 @@ public:
   smt_astt
   convert_array_of(smt_astt init_val, unsigned long domain_width) override;
   void add_array_constraints_for_solving() override;
+  void refine_array_model(std::vector<smt_astt> &lemmas) override;
 
   // Heavy lifters
   virtual smt_astt convert_array_of_wsort(
@@ -237,14 +240,23 @@ public:
   void execute_new_updates();
   void apply_new_selects();
 
+  // Lazy axioms: model queries
+  typedef std::unordered_map<expr2tc, BigInt, irep2_hash> index_valuest;
+  bool model_equal(smt_astt a, smt_astt b);
+  const BigInt &model_index_value(const expr2tc &idx, index_valuest &values);
+  bool model_same_index(
+    const expr2tc &a,
+    const expr2tc &b,
+    index_valuest &values);
+
   inline array_ast *new_ast(smt_sortt _s)
   {
-    return new array_ast(this, ctx, _s);
+    return new(ctx) array_ast(this, ctx, _s);
   }
 
   inline array_ast *new_ast(smt_sortt _s, const std::vector<smt_astt> &_a)
   {
-    return new array_ast(this, ctx, _s, _a);
+    return new(ctx) array_ast(this, ctx, _s, _a);
   }
 
   void push_array_ctx() override;
@@ -448,6 +460,30 @@ public:
   // In reverse, these correspond to ast_vect and array_update_vect
   std::vector<std::vector<std::vector<smt_astt>>> array_valuation;
 
+  // With --array-refinement, neither the ackerman constraints between the
+  // initial values of an array, nor the constraints keeping the elements an
+  // update doesn't write to are asserted up front. refine_array_model checks
+  // them against the model instead, and collects those that are violated.
+  bool lazy_axioms;
+
+  // The updates whose untouched elements aren't constrained yet: the
+  // elements [start_point, end_point) of the valuation of the array after
+  // update update_num.
+  struct lazy_update
+  {
+    unsigned int array_id;
+    unsigned int update_num;
+    unsigned int start_point;
+    unsigned int end_point;
+    unsigned int ctx_level;
+  };
+  std::vector<lazy_update> lazy_updates;
+
+  // The lemmas asserted so far, by the two values they relate, and the
+  // context level they were asserted at. The model can't always tell whether
+  // one holds, asserting it again adds nothing.
+  std::map<std::pair<smt_astt, smt_astt>, unsigned int> lazy_lemmas;
+
   smt_convt *ctx;
 };
 
@@ -42,10 +42,105 @@ static BigInt power2m1(std::size_t n, bool negated)
   return b;
 }
 
-fp_convt::fp_convt(smt_convt *_ctx) : ctx(_ctx)
+fp_convt::fp_convt(smt_convt *_ctx)
+  : ctx(_ctx), abstract_ops(_ctx->options.get_bool_option("fp-refinement"))
 {
 }
 
+smt_astt fp_convt::mk_abstract_op(
+  abstract_opt::kindt kind,
+  smt_astt x,
+  smt_astt y,
+  smt_astt rm)
+{
+  // The result is left free until a model shows it needs the real circuit
+  abstract_opt op;
+  op.kind = kind;
+  op.x = x;
+  op.y = y;
+  op.rm = rm;
+  op.result = ctx->mk_fresh(x->sort, "fp_abstract_op::");
+  op.refined_level = UINT_MAX;
+  abstract_ops_list.push_back(op);
+  return op.result;
+}
+
+smt_astt fp_convt::encode_abstract_op(const abstract_opt &op)
+{
+  switch(op.kind)
+  {
+  case abstract_opt::ADD:
+    return encode_fpbv_add(op.x, op.y, op.rm);
+  case abstract_opt::MUL:
+    return encode_fpbv_mul(op.x, op.y, op.rm);
+  case abstract_opt::DIV:
+    return encode_fpbv_div(op.x, op.y, op.rm);
+  }
+  abort();
+}
+
+bool fp_convt::abstract_op_holds(const abstract_opt &op)
+{
+  ieee_floatt x = get_fpbv(op.x);
+  ieee_floatt y = get_fpbv(op.y);
+  BigInt rm = ctx->get_bv(op.rm, false);
+  x.rounding_mode = static_cast<ieee_floatt::rounding_modet>(rm.to_uint64());
+
+  switch(op.kind)
+  {
+  case abstract_opt::ADD:
+    x += y;
+    break;
+  case abstract_opt::MUL:
+    x *= y;
+    break;
+  case abstract_opt::DIV:
+    x /= y;
+    break;
+  }
+
+  // The circuits always produce the NaN of mk_smt_fpbv_nan, compare with that
+  BigInt expected = x.pack();
+  if(x.is_NaN())
+    expected = power2m1(x.spec.e, false) * power2(x.spec.f, false) + 1;
+
+  return ctx->get_bv(op.result, false) == expected;
+}
+
+void fp_convt::refine_fp_model(std::vector<smt_astt> &lemmas)
+{
+  // Checking needs the whole model, so collect the spurious ones first
+  std::vector<abstract_opt *> spurious;
+  for(abstract_opt &op : abstract_ops_list)
+    if(op.refined_level == UINT_MAX && !abstract_op_holds(op))
+      spurious.push_back(&op);
+
+  for(abstract_opt *op : spurious)
+  {
+    lemmas.push_back(op->result->eq(ctx, encode_abstract_op(*op)));
+    op->refined_level = ctx->ctx_level;
+  }
+
+  if(!spurious.empty())
+    log_debug("fp", "Refined {} floating-point operations", spurious.size());
+}
+
+void fp_convt::push_fp_ctx()
+{
+  abstract_ops_sizes.push_back(abstract_ops_list.size());
+}
+
+void fp_convt::pop_fp_ctx()
+{
+  abstract_ops_list.resize(abstract_ops_sizes.back());
+  abstract_ops_sizes.pop_back();
+
+  // Circuits asserted in the popped context are gone with it
+  for(abstract_opt &op : abstract_ops_list)
+    if(op.refined_level > ctx->ctx_level)
+      op.refined_level = UINT_MAX;
+}
+
 smt_astt fp_convt::mk_smt_fpbv(const ieee_floatt &thereal)
 {
   smt_sortt s = ctx->mk_bvfp_sort(thereal.spec.e, thereal.spec.f);
@@ -1248,7 +1343,7 @@ static void add_core(
   res_exp = ctx->mk_sign_ext(c_exp, 2); // rounder requires 2 extra bits!
 }
 
-smt_astt fp_convt::mk_smt_fpbv_add(smt_astt x, smt_astt y, smt_astt rm)
+smt_astt fp_convt::encode_fpbv_add(smt_astt x, smt_astt y, smt_astt rm)
 {
   assert(x->sort->get_data_width() == y->sort->get_data_width());
   assert(x->sort->get_exponent_width() == y->sort->get_exponent_width());
@@ -1347,13 +1442,20 @@ smt_astt fp_convt::mk_smt_fpbv_add(smt_astt x, smt_astt y, smt_astt rm)
   return ctx->mk_ite(c1, v1, result);
 }
 
+smt_astt fp_convt::mk_smt_fpbv_add(smt_astt x, smt_astt y, smt_astt rm)
+{
+  if(abstract_ops)
+    return mk_abstract_op(abstract_opt::ADD, x, y, rm);
+  return encode_fpbv_add(x, y, rm);
+}
+
 smt_astt fp_convt::mk_smt_fpbv_sub(smt_astt lhs, smt_astt rhs, smt_astt rm)
 {
   smt_astt t = mk_smt_fpbv_neg(rhs);
   return mk_smt_fpbv_add(lhs, t, rm);
 }
 
-smt_astt fp_convt::mk_smt_fpbv_mul(smt_astt x, smt_astt y, smt_astt rm)
+smt_astt fp_convt::encode_fpbv_mul(smt_astt x, smt_astt y, smt_astt rm)
 {
   assert(x->sort->get_data_width() == y->sort->get_data_width());
   assert(x->sort->get_exponent_width() == y->sort->get_exponent_width());
@@ -1455,7 +1557,21 @@ smt_astt fp_convt::mk_smt_fpbv_mul(smt_astt x, smt_astt y, smt_astt rm)
   return ctx->mk_ite(c1, v1, result);
 }
 
+smt_astt fp_convt::mk_smt_fpbv_mul(smt_astt x, smt_astt y, smt_astt rm)
+{
+  if(abstract_ops)
+    return mk_abstract_op(abstract_opt::MUL, x, y, rm);
+  return encode_fpbv_mul(x, y, rm);
+}
+
 smt_astt fp_convt::mk_smt_fpbv_div(smt_astt x, smt_astt y, smt_astt rm)
+{
+  if(abstract_ops)
+    return mk_abstract_op(abstract_opt::DIV, x, y, rm);
+  return encode_fpbv_div(x, y, rm);
+}
+
+smt_astt fp_convt::encode_fpbv_div(smt_astt x, smt_astt y, smt_astt rm)
 {
   assert(x->sort->get_data_width() == y->sort->get_data_width());
   assert(x->sort->get_exponent_width() == y->sort->get_exponent_width());
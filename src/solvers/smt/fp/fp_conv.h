@@ -219,9 +219,48 @@ public:
    */
   virtual smt_astt mk_from_fp_to_bv(smt_astt op);
 
+  /** With --fp-refinement, the results of additions, multiplications and
+   *  divisions start out as free variables. After a satisfying dec_solve,
+   *  evaluate these operations concretely on the model and collect the full
+   *  circuits for those whose result the model got wrong. The caller asserts
+   *  them once every refiner has read the model.
+   *  @param lemmas Where to append the circuits. */
+  void refine_fp_model(std::vector<smt_astt> &lemmas);
+
+  void push_fp_ctx();
+  void pop_fp_ctx();
+
 private:
   smt_convt *ctx;
 
+  /** An operation whose result is not (yet) tied to its operands. */
+  struct abstract_opt
+  {
+    enum kindt
+    {
+      ADD,
+      MUL,
+      DIV
+    } kind;
+    smt_astt x, y, rm;
+    smt_astt result;
+    /** Context level the circuit was asserted in, UINT_MAX if it wasn't. */
+    unsigned int refined_level;
+  };
+
+  bool abstract_ops;
+  std::vector<abstract_opt> abstract_ops_list;
+  std::vector<size_t> abstract_ops_sizes;
+
+  smt_astt
+  mk_abstract_op(abstract_opt::kindt kind, smt_astt x, smt_astt y, smt_astt rm);
+  smt_astt encode_abstract_op(const abstract_opt &op);
+  bool abstract_op_holds(const abstract_opt &op);
+
+  smt_astt encode_fpbv_add(smt_astt x, smt_astt y, smt_astt rm);
+  smt_astt encode_fpbv_mul(smt_astt x, smt_astt y, smt_astt rm);
+  smt_astt encode_fpbv_div(smt_astt x, smt_astt y, smt_astt rm);
+
   void unpack(
     smt_astt &src,
     smt_astt &sgn,
@@ -0,0 +1,120 @@
+#ifndef SOLVERS_SMT_SMT_ARENA_H_
+#define SOLVERS_SMT_SMT_ARENA_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/** Bump allocator backing the smt_ast's of one smt_convt.
+ *  Memory is handed out from a list of chunks and never returned piecemeal.
+ *  Scopes are opened by remembering the current position at each push; a pop
+ *  moves back to that position, so everything allocated since is reused by
+ *  the next allocations. Chunks beyond the one following the current position
+ *  are freed on pop, so a deep context does not pin its memory forever. The
+ *  arena does not run destructors, that's up to the owner of the objects.
+ */
+class smt_arenat
+{
+public:
+  smt_arenat() = default;
+  smt_arenat(const smt_arenat &) = delete;
+  smt_arenat &operator=(const smt_arenat &) = delete;
+
+  void *allocate(size_t size)
+  {
+    size = (size + alignment - 1) & ~(alignment - 1);
+    if(chunks.empty() || chunks[cur].size - offset < size)
+      next_chunk(size);
+
+    void *p = chunks[cur].data.get() + offset;
+    offset += size;
+    return p;
+  }
+
+  /** Opens a new scope. */
+  void push()
+  {
+    marks.push_back({cur, offset});
+  }
+
+  /** Releases everything allocated since the matching push. */
+  void pop()
+  {
+    assert(!marks.empty());
+    cur = marks.back().chunk;
+    offset = marks.back().offset;
+    marks.pop_back();
+    trim();
+  }
+
+  /** Releases everything allocated, and all scopes. */
+  void clear()
+  {
+    marks.clear();
+    cur = 0;
+    offset = 0;
+    trim();
+  }
+
+  /** Bytes handed out since the arena was last empty. */
+  size_t bytes_used() const
+  {
+    size_t n = offset;
+    for(size_t i = 0; i < cur; i++)
+      n += chunks[i].used;
+    return n;
+  }
+
+  static constexpr size_t alignment = alignof(std::max_align_t);
+  static constexpr size_t chunk_size = 64 * 1024;
+
+protected:
+  struct chunkt
+  {
+    std::unique_ptr<char[]> data;
+    size_t size;
+    /// Bytes used in this chunk when the arena moved on to the next one
+    size_t used;
+  };
+
+  void next_chunk(size_t size)
+  {
+    if(!chunks.empty())
+    {
+      chunks[cur].used = offset;
+      cur++;
+    }
+
+    // Reuse the chunk left by a pop if it is big enough, oversized requests
+    // get a chunk of their own
+    if(cur == chunks.size() || chunks[cur].size < size)
+    {
+      size_t n = std::max(size, chunk_size);
+      chunks.insert(
+        chunks.begin() + cur, chunkt{std::unique_ptr<char[]>(new char[n]), n, 0});
+    }
+
+    offset = 0;
+  }
+
+  void trim()
+  {
+    if(chunks.size() > cur + 2)
+      chunks.resize(cur + 2);
+  }
+
+  struct markt
+  {
+    size_t chunk;
+    size_t offset;
+  };
+
+  std::vector<chunkt> chunks;
+  size_t cur = 0;
+  size_t offset = 0;
+  std::vector<markt> marks;
+};
+
+#endif
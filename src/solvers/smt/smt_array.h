@@ -51,6 +51,15 @@ public:
 
   virtual void add_array_constraints_for_solving(){};
 
+  /** Called after dec_solve found the formula satisfiable: collect those
+   *  constraints that were deferred during conversion and that the current
+   *  model violates. Asserting anything invalidates the model, so the caller
+   *  asserts them once every refiner has looked at it.
+   *  The violated constraints are appended to the vector given. */
+  virtual void refine_array_model(std::vector<smt_astt> &)
+  {
+  }
+
   virtual void push_array_ctx(){};
   virtual void pop_array_ctx(){};
 
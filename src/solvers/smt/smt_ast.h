@@ -40,6 +40,14 @@ public:
   smt_ast(smt_convt *ctx, smt_sortt s);
   virtual ~smt_ast() = default;
 
+  /** ASTs are allocated in the arena of the converter they belong to, as in
+   *  `new (ctx) some_smt_ast(ctx, ...)`. Their memory goes away with the
+   *  converter, or when the context they were made in is popped. */
+  static void *operator new(size_t size, smt_convt *ctx);
+  static void operator delete(void *, smt_convt *)
+  {
+  }
+
   // "this" is the true operand.
   virtual smt_astt ite(smt_convt *ctx, smt_astt cond, smt_astt falseop) const;
 
@@ -86,6 +94,14 @@ public:
   {
     log_status("Chosen solver doesn't support printing the AST\n");
   }
+
+protected:
+  /** Only there for the virtual destructors, ASTs are never deleted: the
+   *  arena runs their destructors when it frees them. Being protected, a
+   *  `delete` of an AST doesn't compile. */
+  static void operator delete(void *)
+  {
+  }
 };
 
 template <typename solver_ast>
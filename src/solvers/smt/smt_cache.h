@@ -0,0 +1,139 @@
+#ifndef SOLVERS_SMT_SMT_CACHE_H_
+#define SOLVERS_SMT_SMT_CACHE_H_
+
+#include <cassert>
+#include <cstdint>
+#include <irep2/irep2.h>
+#include <vector>
+
+class smt_ast;
+typedef const smt_ast *smt_astt;
+
+/** Cache mapping expressions to their converted SMT ASTs.
+ *  Entries are kept in a vector in insertion order. An open addressing table
+ *  with linear probing indexes that vector; each slot holds an entry index
+ *  and the top half of the entry's hash, so that most mismatches are rejected
+ *  without touching the entry. Contexts are scoped by remembering the number
+ *  of entries at each push: a pop drops the entries added since, newest
+ *  first. Removing entries strictly in reverse insertion order means no probe
+ *  sequence of a remaining entry ever crossed a removed slot, so slots can be
+ *  emptied outright, without tombstones.
+ *
+ *  Like the multi_index container this replaces, inserting an expression
+ *  already present keeps the existing entry.
+ */
+class smt_cachet
+{
+public:
+  struct entryt
+  {
+    expr2tc val;
+    smt_astt ast;
+    size_t hash;
+  };
+
+  smt_cachet() : slots(initial_slots), mask(initial_slots - 1)
+  {
+  }
+
+  /** Returns the AST cached for expr, or nullptr. */
+  smt_astt find(const expr2tc &expr) const
+  {
+    size_t h = expr.crc();
+    for(size_t i = h & mask;; i = (i + 1) & mask)
+    {
+      const slott &s = slots[i];
+      if(s.idx == 0)
+        return nullptr;
+      if(s.tag != tag_of(h))
+        continue;
+      const entryt &e = entries[s.idx - 1];
+      if(e.hash == h && e.val == expr)
+        return e.ast;
+    }
+  }
+
+  void insert(const expr2tc &expr, smt_astt ast)
+  {
+    size_t h = expr.crc();
+    size_t i = h & mask;
+    for(; slots[i].idx != 0; i = (i + 1) & mask)
+    {
+      const entryt &e = entries[slots[i].idx - 1];
+      if(e.hash == h && e.val == expr)
+        return;
+    }
+
+    entries.push_back({expr, ast, h});
+    slots[i] = {uint32_t(entries.size()), tag_of(h)};
+
+    // Keep the load factor below 1/2
+    if(entries.size() * 2 > slots.size())
+      rehash(slots.size() * 2);
+  }
+
+  /** Opens a new scope. */
+  void push()
+  {
+    marks.push_back(entries.size());
+  }
+
+  /** Drops every entry inserted since the matching push(). */
+  void pop()
+  {
+    assert(!marks.empty());
+    size_t mark = marks.back();
+    marks.pop_back();
+
+    while(entries.size() > mark)
+    {
+      const uint32_t idx = entries.size();
+      size_t i = entries.back().hash & mask;
+      while(slots[i].idx != idx)
+        i = (i + 1) & mask;
+      slots[i] = slott();
+      entries.pop_back();
+    }
+  }
+
+  size_t size() const
+  {
+    return entries.size();
+  }
+
+private:
+  struct slott
+  {
+    /** 1 + index into entries, 0 for an empty slot. */
+    uint32_t idx = 0;
+    uint32_t tag = 0;
+  };
+
+  static constexpr size_t initial_slots = 1024;
+
+  std::vector<entryt> entries;
+  std::vector<slott> slots;
+  size_t mask;
+  std::vector<size_t> marks;
+
+  static uint32_t tag_of(size_t h)
+  {
+    return uint32_t(uint64_t(h) >> 32);
+  }
+
+  void rehash(size_t n)
+  {
+    // Re-insert in insertion order, pop() relies on that
+    slots.assign(n, slott());
+    mask = n - 1;
+    for(size_t k = 0; k < entries.size(); k++)
+    {
+      size_t i = entries[k].hash & mask;
+      while(slots[i].idx != 0)
+        i = (i + 1) & mask;
+      slots[i] = {uint32_t(k + 1), tag_of(entries[k].hash)};
+    }
+  }
+};
+
+#endif
@@ -455,8 +455,8 @@ smt_astt smt_convt::convert_typecast_to_ptr(const typecast2t &cast)
 
   smt_sortt s = convert_sort(cast.type);
   smt_astt output = mk_fresh(s, "smt_convt::int_to_ptr");
-  smt_astt output_obj = output->project(this, 0);
-  smt_astt output_offs = output->project(this, 1);
+  smt_astt output_obj = pointer_project(output, 0);
+  smt_astt output_offs = pointer_project(output, 1);
   if(config.ansi_c.cheri)
   {
     smt_astt output_cap = output->project(this, 2);
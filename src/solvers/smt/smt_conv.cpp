@@ -63,10 +63,55 @@ smt_convt::get_member_name_field(const type2tc &t, const expr2tc &name) const
   return get_member_name_field(t, str.value);
 }
 
+bool smt_convt::is_tuple_array_ast_type(const type2tc &type) const
+{
+  if(!is_array_type(type))
+    return false;
+
+  type2tc range = to_array_type(type).subtype;
+  while(is_array_type(range))
+    range = to_array_type(range).subtype;
+
+  return is_tuple_ast_type(range);
+}
+
 smt_convt::smt_convt(const namespacet &_ns, const optionst &_options)
   : ctx_level(0), boolean_sort(nullptr), ns(_ns), options(_options)
 {
   int_encoding = options.get_bool_option("int-encoding");
+
+  const std::string addr_space = options.get_option("address-space-encoding");
+  if(addr_space != "" && addr_space != "pairwise" && addr_space != "ordered")
+  {
+    log_error(
+      "Unknown address space encoding \"{}\", expected \"pairwise\" or "
+      "\"ordered\"",
+      addr_space);
+    abort();
+  }
+  ordered_addr_space = addr_space == "ordered";
+
+  const std::string ptr_encoding = options.get_option("pointer-encoding");
+  if(ptr_encoding != "" && ptr_encoding != "tuple" && ptr_encoding != "flat")
+  {
+    log_error(
+      "Unknown pointer encoding \"{}\", expected \"tuple\" or \"flat\"",
+      ptr_encoding);
+    abort();
+  }
+  flat_pointers = ptr_encoding == "flat";
+  if(flat_pointers && (int_encoding || config.ansi_c.cheri))
+  {
+    log_error(
+      "--pointer-encoding=flat needs bit-vector arithmetic and is not "
+      "supported for CHERI");
+    abort();
+  }
+
+  // Object numbers are unsigned ints, no need for wider object fields
+  flat_ptr_obj_bits = std::min<unsigned int>(
+    8 * sizeof(unsigned int), ptraddr_type2()->get_width());
+
   tuple_api = nullptr;
   array_api = nullptr;
   fp_api = nullptr;
@@ -131,10 +176,13 @@ void smt_convt::set_fp_conv(fp_convt *iface)
 
 void smt_convt::delete_all_asts()
 {
-  // Erase all the remaining asts in the live ast vector.
+  // Erase all the remaining asts in the live ast vector. Their storage is
+  // released at once afterwards.
   for(auto *ast : live_asts)
-    delete ast;
+    ast->~smt_ast();
   live_asts.clear();
+  live_asts_sizes.clear();
+  ast_arena.clear();
 }
 
 void smt_convt::smt_post_init()
@@ -166,6 +214,7 @@ void smt_convt::push_ctx()
 {
   tuple_api->push_tuple_ctx();
   array_api->push_array_ctx();
+  fp_api->push_fp_ctx();
 
   addr_space_data.push_back(addr_space_data.back());
   addr_space_sym_num.push_back(addr_space_sym_num.back());
@@ -173,6 +222,8 @@ void smt_convt::push_ctx()
   renumber_map.push_back(renumber_map.back());
 
   live_asts_sizes.push_back(live_asts.size());
+  ast_arena.push();
+  smt_cache.push();
 
   ctx_level++;
 }
@@ -181,8 +232,7 @@ void smt_convt::pop_ctx()
 {
   // Erase everything in caches added in the current context level. Everything
   // before the push is going to disappear.
-  smt_cachet::nth_index<1>::type &cache_numindex = smt_cache.get<1>();
-  cache_numindex.erase(ctx_level);
+  smt_cache.pop();
   pointer_logic.pop_back();
   addr_space_sym_num.pop_back();
   addr_space_data.pop_back();
@@ -193,12 +243,14 @@ void smt_convt::pop_ctx()
   // Go through all the asts created since the last push and delete them.
 
   for(unsigned int idx = live_asts_sizes.back(); idx < live_asts.size(); idx++)
-    delete live_asts[idx];
+    live_asts[idx]->~smt_ast();
 
   // And reset the storage back to that point.
   live_asts.resize(live_asts_sizes.back());
   live_asts_sizes.pop_back();
+  ast_arena.pop();
 
+  fp_api->pop_fp_ctx();
   array_api->pop_array_ctx();
   tuple_api->pop_tuple_ctx();
 }
@@ -234,17 +286,15 @@ smt_astt smt_convt::convert_assign(const expr2tc &expr)
   // IMPORTANT: the cache is now a fundamental part of how some flatteners work,
   // in that one can choose to create a set of expressions and their ASTs, then
   // store them in the cache, rather than have a more sophisticated conversion.
-  smt_cache_entryt e = {eq.side_1, side2, ctx_level};
-  smt_cache.insert(e);
+  smt_cache.insert(eq.side_1, side2);
 
   return side2;
 }
 
 smt_astt smt_convt::convert_ast(const expr2tc &expr)
 {
-  smt_cachet::const_iterator cache_result = smt_cache.find(expr);
-  if(cache_result != smt_cache.end())
-    return (cache_result->ast);
+  if(smt_astt cached = smt_cache.find(expr))
+    return cached;
 
   /* Vectors!
    *
@@ -394,7 +444,7 @@ smt_astt smt_convt::convert_ast(const expr2tc &expr)
       is_array_type(get_array_subtype(expr->type)) && is_constant_array2t(expr))
       flat_expr = flatten_array_body(expr);
 
-    if(is_struct_type(arr.subtype) || is_pointer_type(arr.subtype))
+    if(is_tuple_ast_type(arr.subtype))
     {
       // Domain sort may be mesed with:
       smt_sortt domain = mk_int_bv_sort(
@@ -659,7 +709,10 @@ smt_astt smt_convt::convert_ast(const expr2tc &expr)
         "Assigned tuple member has type mismatch");
 #endif
 
-      a = srcval->update(this, convert_ast(with.update_value), idx);
+      if(is_pointer_type(expr))
+        a = pointer_update(srcval, convert_ast(with.update_value), idx);
+      else
+        a = srcval->update(this, convert_ast(with.update_value), idx);
     }
     else if(is_union_type(expr))
     {
@@ -696,8 +749,8 @@ smt_astt smt_convt::convert_ast(const expr2tc &expr)
   case expr2t::same_object_id:
   {
     // Two projects, then comparison.
-    args[0] = args[0]->project(this, 0);
-    args[1] = args[1]->project(this, 0);
+    args[0] = pointer_project(args[0], 0);
+    args[1] = pointer_project(args[1], 0);
     a = mk_eq(args[0], args[1]);
     break;
   }
@@ -710,7 +763,7 @@ smt_astt smt_convt::convert_ast(const expr2tc &expr)
       ptr = &to_typecast2t(*ptr).from;
 
     args[0] = convert_ast(*ptr);
-    a = args[0]->project(this, 1);
+    a = pointer_project(args[0], 1);
     break;
   }
   case expr2t::pointer_object_id:
@@ -722,7 +775,7 @@ smt_astt smt_convt::convert_ast(const expr2tc &expr)
       ptr = &to_typecast2t(*ptr).from;
 
     args[0] = convert_ast(*ptr);
-    a = args[0]->project(this, 0);
+    a = pointer_project(args[0], 0);
     break;
   }
   case expr2t::pointer_capability_id:
@@ -1186,8 +1239,7 @@ smt_astt smt_convt::convert_ast(const expr2tc &expr)
     abort();
   }
 
-  struct smt_cache_entryt entry = {expr, a, ctx_level};
-  smt_cache.insert(entry);
+  smt_cache.insert(expr, a);
 
   return a;
 }
@@ -1218,7 +1270,10 @@ smt_sortt smt_convt::convert_sort(const type2tc &type)
 
   case type2t::code_id:
   case type2t::pointer_id:
-    result = tuple_api->mk_struct_sort(pointer_struct);
+    if(flat_pointers)
+      result = mk_bv_sort(flat_ptr_obj_bits + ptraddr_type2()->get_width());
+    else
+      result = tuple_api->mk_struct_sort(pointer_struct);
     break;
 
   case type2t::unsignedbv_id:
@@ -1418,7 +1473,7 @@ smt_astt smt_convt::convert_terminal(const expr2tc &expr)
       current_valid_objects_sym = expr;
 
     // Special case for tuple symbols
-    if(is_tuple_ast_type(expr))
+    if(is_tuple_ast_type(expr->type))
       return tuple_api->mk_tuple_symbol(
         sym.get_symbol_name(), convert_sort(sym.type));
 
@@ -1454,9 +1509,8 @@ smt_astt smt_convt::convert_terminal(const expr2tc &expr)
 std::string smt_convt::mk_fresh_name(const std::string &tag)
 {
   std::string new_name = "smt_conv::" + tag;
-  std::stringstream ss;
-  ss << new_name << fresh_map[new_name]++;
-  return ss.str();
+  unsigned int num = fresh_map[new_name]++;
+  return new_name + std::to_string(num);
 }
 
 smt_astt smt_convt::mk_fresh(
@@ -1686,6 +1740,9 @@ smt_astt smt_convt::convert_member(const expr2tc &expr)
     get_member_name_field(member.source_value->type, member.member);
 
   smt_astt src = convert_ast(member.source_value);
+  if(is_pointer_type(member.source_value))
+    return pointer_project(src, idx);
+
   return src->project(this, idx);
 }
 
@@ -2154,6 +2211,32 @@ void smt_convt::pre_solve()
   array_api->add_array_constraints_for_solving();
 }
 
+smt_convt::resultt smt_convt::refined_dec_solve()
+{
+  resultt res = dec_solve();
+  unsigned int rounds = 0;
+  while(res == P_SATISFIABLE)
+  {
+    // Asserting anything invalidates the model, which all of them read
+    std::vector<smt_astt> lemmas;
+    tuple_api->refine_tuple_model(lemmas);
+    array_api->refine_array_model(lemmas);
+    fp_api->refine_fp_model(lemmas);
+    if(lemmas.empty())
+      break;
+
+    for(smt_astt lemma : lemmas)
+      assert_ast(lemma);
+
+    rounds++;
+    res = dec_solve();
+  }
+
+  if(rounds != 0)
+    log_status("Refined the encoding {} time(s)", rounds);
+  return res;
+}
+
 expr2tc smt_convt::get(const expr2tc &expr)
 {
   if(is_constant_number(expr))
@@ -2343,9 +2426,11 @@ expr2tc smt_convt::get_by_ast(const type2tc &type, smt_astt a)
     return constant_floatbv2tc(fp_api->get_fpbv(a));
 
   case type2t::struct_id:
-  case type2t::pointer_id:
     return tuple_api->tuple_get(type, a);
 
+  case type2t::pointer_id:
+    return get_pointer(type, a);
+
   case type2t::union_id:
   {
     expr2tc uint_rep =
@@ -2406,7 +2491,11 @@ expr2tc smt_convt::get_by_type(const expr2tc &expr)
     return get_array(expr);
 
   case type2t::struct_id:
+    return tuple_api->tuple_get(expr);
+
   case type2t::pointer_id:
+    if(flat_pointers)
+      return get_pointer(expr->type, convert_ast(expr));
     return tuple_api->tuple_get(expr);
 
   default:
@@ -2653,6 +2742,9 @@ smt_astt smt_convt::pointer_array_of(
   operands.push_back(zero_val);
 
   expr2tc strct = constant_struct2tc(pointer_struct, std::move(operands));
+  if(flat_pointers)
+    return array_api->convert_array_of(pointer_create(strct), array_width);
+
   return tuple_api->tuple_array_of(strct, array_width);
 }
 
@@ -2692,7 +2784,10 @@ void smt_convt::rewrite_ptrs_to_structs(type2tc &type)
   // Type may contain pointers; replace those with the structure equivalent.
   // Ideally the real solver will never see pointer types.
   // Create a delegate that recurses over all subtypes, replacing pointers
-  // as we go.
+  // as we go. Flat pointers are plain bitvectors and stay as they are.
+  if(flat_pointers)
+    return;
+
   struct
   {
     const type2tc &pointer_struct;
@@ -12,6 +12,7 @@
 #include <util/message.h>
 #include <util/namespace.h>
 #include <util/threeval.h>
+#include <unordered_map>
 
 /** @file smt_conv.h
  *  SMT conversion tools and utilities.
@@ -87,7 +88,9 @@
 class fp_convt;
 class smt_convt;
 
+#include <solvers/smt/smt_arena.h>
 #include <solvers/smt/smt_array.h>
+#include <solvers/smt/smt_cache.h>
 #include <solvers/smt/tuple/smt_tuple.h>
 #include <solvers/smt/fp/fp_conv.h>
 
@@ -142,7 +145,7 @@ public:
   smt_astt
   new_solver_ast(typename the_solver_ast::solver_ast_type ast, smt_sortt sort)
   {
-    return new the_solver_ast(this, ast, sort);
+    return new(this) the_solver_ast(this, ast, sort);
   }
 
   /** Primary constructor. After construction, smt_post_init must be called
@@ -251,6 +254,13 @@ public:
 
   void pre_solve();
 
+  /** Solve the formula like dec_solve, but if the tuple or array flatteners
+   *  deferred some of their constraints, keep asserting those that the model
+   *  violates and solving again, until the model satisfies all of them or the
+   *  formula becomes unsat.
+   *  @return Result code of the last call to dec_solve. */
+  resultt refined_dec_solve();
+
   /** Get the satisfying assignment using the type.
    *  @param expr Variable to get the value of. Must be a symbol expression.
    *  @return Explicit assigned value of expr in the solver. May be nil, in
@@ -585,6 +595,18 @@ public:
    *  multiplications or casting is requried to honour the C semantics of
    *  pointer arith. */
   smt_astt convert_pointer_arith(const expr2tc &expr, const type2tc &t);
+  /** Fetch field 'field' of pointer_struct (0 for the object number, 1 for
+   *  the offset) out of a pointer AST, whichever way pointers are encoded. */
+  smt_astt pointer_project(smt_astt ptr, unsigned int field);
+  /** Return the pointer AST ptr with field 'field' replaced by value, see
+   *  pointer_project. */
+  smt_astt pointer_update(smt_astt ptr, smt_astt value, unsigned int field);
+  /** Convert a constant_struct2tc of pointer_struct type into a pointer AST */
+  smt_astt pointer_create(const expr2tc &ptr_struct_val);
+  /** Create a pointer-sorted symbol */
+  smt_astt mk_pointer_symbol(const std::string &name);
+  /** Extract the valuation of a pointer AST from the model */
+  expr2tc get_pointer(const type2tc &type, smt_astt ptr);
   /** Compare two pointers. This attempts to optimise cases where we can avoid
    *  comparing the integer representation of a pointer, as that's hugely
    *  inefficient sometimes (and gets bitblasted).
@@ -663,7 +685,8 @@ public:
   std::string get_cur_addrspace_ident();
   /** Create and assert address space constraints on the given object ID
    *  number. Essentially, this asserts that all the objects to date don't
-   *  overlap with /this/ one. */
+   *  overlap with /this/ one, either pairwise or by ordering it between its
+   *  neighbours, see ordered_addr_space. */
   void finalize_pointer_chain(unsigned int obj_num);
 
   /** Typecast data to bools */
@@ -700,6 +723,16 @@ public:
   /** Extract a type definition (i.e. a struct_union_data object) from a type.
    *  This method abstracts the fact that a pointer type is in fact a tuple. */
   const struct_union_data &get_type_def(const type2tc &type) const;
+  /** Whether values of this type are tuples. Pointers (and code) are tuples
+   *  of object number and offset, unless flat_pointers packs them into a
+   *  single bitvector. */
+  bool is_tuple_ast_type(const type2tc &type) const
+  {
+    return is_struct_type(type) ||
+           ((is_pointer_type(type) || is_code_type(type)) && !flat_pointers);
+  }
+  /** Whether this is an array, of any dimension, of tuples */
+  bool is_tuple_array_ast_type(const type2tc &type) const;
   /** Prep call for creating a tuple array */
   smt_astt tuple_array_create_despatch(const expr2tc &expr, smt_sortt domain);
 
@@ -760,25 +793,6 @@ public:
 
   // Types
 
-  // Type for (optional) AST cache
-
-  struct smt_cache_entryt
-  {
-    const expr2tc val;
-    smt_astt ast;
-    unsigned int level;
-  };
-
-  typedef boost::multi_index_container<
-    smt_cache_entryt,
-    boost::multi_index::indexed_by<
-      boost::multi_index::hashed_unique<
-        BOOST_MULTI_INDEX_MEMBER(smt_cache_entryt, const expr2tc, val)>,
-      boost::multi_index::ordered_non_unique<
-        BOOST_MULTI_INDEX_MEMBER(smt_cache_entryt, unsigned int, level),
-        std::greater<unsigned int>>>>
-    smt_cachet;
-
   typedef std::unordered_map<type2tc, smt_sortt, type2_hash> smt_sort_cachet;
 
   // Members
@@ -802,6 +816,16 @@ public:
   smt_sortt boolean_sort;
   /** Whether we are encoding expressions in integer mode or not. */
   bool int_encoding;
+  /** Whether address space constraints place objects in the order of their
+   *  numbers (linear in the number of objects) rather than asserting pairwise
+   *  non-overlap (quadratic). Selected by --address-space-encoding. */
+  bool ordered_addr_space;
+  /** Whether pointers are packed into a single bitvector, the object number
+   *  in the top flat_ptr_obj_bits bits and the offset below it, instead of
+   *  being pointer_struct tuples. Selected by --pointer-encoding=flat. */
+  bool flat_pointers;
+  /** Width of the object number field of flat pointers. */
+  unsigned int flat_ptr_obj_bits;
   /** A namespace containing all the types in the program. Used to resolve the
    *  rare case where we're doing some pointer arithmetic and need to have the
    *  concrete type of a pointer. */
@@ -818,7 +842,7 @@ public:
    *  with a particular prefix, this map stores how many times that prefix has
    *  been used, and thus what number should be appended to make the name
    *  unique. */
-  std::map<std::string, unsigned int> fresh_map;
+  std::unordered_map<std::string, unsigned int> fresh_map;
 
   /** Integer recording how many times the address space allocation record
    *  array has been modified. Essentially, this is like the SSA variable
@@ -850,6 +874,8 @@ public:
    *  contained when a push occurred. On pop, the live_asts vector is reset
    *  back to that point. */
   std::vector<unsigned int> live_asts_sizes;
+  /** Storage of the ASTs in live_asts, scoped along with it. */
+  smt_arenat ast_arena;
 
   tuple_iface *tuple_api;
   array_iface *array_api;
@@ -875,6 +901,11 @@ inline smt_ast::smt_ast(smt_convt *ctx, smt_sortt s) : sort(s), context(ctx)
   ctx->live_asts.push_back(this);
 }
 
+inline void *smt_ast::operator new(size_t size, smt_convt *ctx)
+{
+  return ctx->ast_arena.allocate(size);
+}
+
 inline BigInt ones(unsigned n_bits)
 {
   BigInt r;
@@ -118,7 +118,7 @@ smt_convt::convert_pointer_arith(const expr2tc &expr, const type2tc &type)
       {
         // Update field in tuple.
         smt_astt the_ptr = convert_ast(side1);
-        return the_ptr->update(this, convert_ast(the_ptr_offs), 1);
+        return pointer_update(the_ptr, convert_ast(the_ptr_offs), 1);
       }
 
       return convert_ast(the_ptr_offs);
@@ -188,7 +188,7 @@ smt_convt::convert_pointer_arith(const expr2tc &expr, const type2tc &type)
     simplify(newexpr);
 
     // That calculated the offset; update field in pointer.
-    return the_ptr->update(this, convert_ast(newexpr), 1);
+    return pointer_update(the_ptr, convert_ast(newexpr), 1);
   }
   }
 
@@ -196,6 +196,75 @@ smt_convt::convert_pointer_arith(const expr2tc &expr, const type2tc &type)
   abort();
 }
 
+smt_astt smt_convt::pointer_project(smt_astt ptr, unsigned int field)
+{
+  if(!flat_pointers)
+    return ptr->project(this, field);
+
+  unsigned int offs_bits = ptraddr_type2()->get_width();
+  if(field == 1)
+    return mk_extract(ptr, offs_bits - 1, 0);
+
+  assert(field == 0 && "Flat pointers have no capability field");
+  smt_astt obj = mk_extract(ptr, flat_ptr_obj_bits + offs_bits - 1, offs_bits);
+  if(flat_ptr_obj_bits == offs_bits)
+    return obj;
+
+  // Object numbers compare against pointer-address sized integers
+  return mk_zero_ext(obj, offs_bits - flat_ptr_obj_bits);
+}
+
+smt_astt
+smt_convt::pointer_update(smt_astt ptr, smt_astt value, unsigned int field)
+{
+  if(!flat_pointers)
+    return ptr->update(this, value, field);
+
+  unsigned int offs_bits = ptraddr_type2()->get_width();
+  if(field == 1)
+    return mk_concat(
+      mk_extract(ptr, flat_ptr_obj_bits + offs_bits - 1, offs_bits), value);
+
+  assert(field == 0 && "Flat pointers have no capability field");
+  return mk_concat(
+    mk_extract(value, flat_ptr_obj_bits - 1, 0),
+    mk_extract(ptr, offs_bits - 1, 0));
+}
+
+smt_astt smt_convt::pointer_create(const expr2tc &ptr_struct_val)
+{
+  if(!flat_pointers)
+    return tuple_api->tuple_create(ptr_struct_val);
+
+  const constant_struct2t &ptr = to_constant_struct2t(ptr_struct_val);
+  smt_astt obj = convert_ast(ptr.datatype_members[0]);
+  smt_astt offs = convert_ast(ptr.datatype_members[1]);
+  return mk_concat(mk_extract(obj, flat_ptr_obj_bits - 1, 0), offs);
+}
+
+smt_astt smt_convt::mk_pointer_symbol(const std::string &name)
+{
+  smt_sortt s = convert_sort(pointer_type2tc(get_empty_type()));
+  if(flat_pointers)
+    return mk_smt_symbol(name, s);
+
+  return tuple_api->mk_tuple_symbol(name, s);
+}
+
+expr2tc smt_convt::get_pointer(const type2tc &type, smt_astt ptr)
+{
+  if(!flat_pointers)
+    return tuple_api->tuple_get(type, ptr);
+
+  BigInt val = get_bv(ptr, false);
+  BigInt offs_range;
+  offs_range.setPower2(ptraddr_type2()->get_width());
+
+  unsigned int num = (val / offs_range).to_uint64();
+  pointer_logict::pointert p(num, val % offs_range);
+  return pointer_logic.back().pointer_expr(p, type);
+}
+
 void smt_convt::renumber_symbol_address(
   const expr2tc &guard,
   const expr2tc &addr_symbol,
@@ -254,10 +323,7 @@ smt_astt smt_convt::convert_identifier_pointer(
     {
       // For null, other pieces of code will have already initialized its
       // value, so we can just refer to a symbol.
-      type2tc t = pointer_type2tc(get_empty_type());
-      a = tuple_api->mk_tuple_symbol(symbol, convert_sort(t));
-
-      return a;
+      return mk_pointer_symbol(symbol);
     }
   }
 
@@ -265,9 +331,8 @@ smt_astt smt_convt::convert_identifier_pointer(
   // expression this is sourced from might have ended up with the wrong type,
   // alas.
   expr2tc new_addr_of = address_of2tc(expr->type, expr);
-  smt_cachet::const_iterator cache_result = smt_cache.find(new_addr_of);
-  if(cache_result != smt_cache.end())
-    return cache_result->ast;
+  if(smt_astt cached = smt_cache.find(new_addr_of))
+    return cached;
 
   // Has this been touched by realloc / been re-numbered?
   renumber_mapt::iterator it = renumber_map.back().find(symbol);
@@ -282,8 +347,7 @@ smt_astt smt_convt::convert_identifier_pointer(
   obj_num = pointer_logic.back().add_object(expr);
 
   // Produce a symbol representing this.
-  type2tc t = pointer_type2tc(get_empty_type());
-  a = tuple_api->mk_tuple_symbol(symbol, convert_sort(t));
+  a = mk_pointer_symbol(symbol);
 
   // If this object hasn't yet been put in the address space record, we need to
   // assert that the symbol has the object ID we've allocated, and then fill out
@@ -310,8 +374,7 @@ smt_astt smt_convt::convert_identifier_pointer(
   }
 
   // Insert canonical address-of this expression.
-  struct smt_cache_entryt entry = {new_addr_of, a, ctx_level};
-  smt_cache.insert(entry);
+  smt_cache.insert(new_addr_of, a);
 
   return a;
 }
@@ -326,7 +389,7 @@ smt_astt smt_convt::init_pointer_obj(unsigned int obj_num, const expr2tc &size)
     membs.push_back(
       constant_int2tc(ptr_struct.members[2], BigInt(0))); /* CHERI-TODO */
   expr2tc ptr_val_s = constant_struct2tc(pointer_struct, membs);
-  smt_astt ptr_val = tuple_api->tuple_create(ptr_val_s);
+  smt_astt ptr_val = pointer_create(ptr_val_s);
 
   type2tc ptr_loc_type = ptraddr_type2();
 
@@ -384,15 +447,47 @@ smt_astt smt_convt::init_pointer_obj(unsigned int obj_num, const expr2tc &size)
 void smt_convt::finalize_pointer_chain(unsigned int objnum)
 {
   type2tc inttype = ptraddr_type2();
-  unsigned int num_ptrs = addr_space_data.back().size();
-  if(num_ptrs == 0)
+  const std::map<unsigned, unsigned> &objs = addr_space_data.back();
+  if(objs.empty())
     return;
 
-  std::stringstream start1, end1;
-  start1 << "__ESBMC_ptr_obj_start_" << objnum;
-  end1 << "__ESBMC_ptr_obj_end_" << objnum;
-  expr2tc start_i = symbol2tc(inttype, start1.str());
-  expr2tc end_i = symbol2tc(inttype, end1.str());
+  auto obj_start = [&inttype](unsigned int obj) {
+    return symbol2tc(inttype, "__ESBMC_ptr_obj_start_" + std::to_string(obj));
+  };
+  auto obj_end = [&inttype](unsigned int obj) {
+    return symbol2tc(inttype, "__ESBMC_ptr_obj_end_" + std::to_string(obj));
+  };
+
+  expr2tc start_i = obj_start(objnum);
+  expr2tc end_i = obj_end(objnum);
+
+  if(ordered_addr_space)
+  {
+    /* Lay objects out in the order of their numbers: the new object only has
+     * to start after its nearest predecessor and end before its nearest
+     * successor, if either is already placed. By transitivity no two objects
+     * overlap, with a constant number of constraints per object. Obj1 is
+     * designed to overlap and takes no part in the chain; the predecessor of
+     * the first object is NULL (obj0).
+     *
+     * Unlike the pairwise encoding this does not let a new object reuse the
+     * addresses of a free'd one. */
+    auto succ = objs.upper_bound(objnum);
+    if(succ != objs.end())
+      assert_expr(lessthan2tc(end_i, obj_start(succ->first)));
+
+    auto pred = objs.lower_bound(objnum);
+    while(pred != objs.begin())
+    {
+      --pred;
+      if(pred->first == 1)
+        continue;
+
+      assert_expr(greaterthan2tc(start_i, obj_end(pred->first)));
+      break;
+    }
+    return;
+  }
 
   for(unsigned int j = 0; j < objnum; j++)
   {
@@ -400,11 +495,8 @@ void smt_convt::finalize_pointer_chain(unsigned int objnum)
     if(j == 1)
       continue;
 
-    std::stringstream startj, endj;
-    startj << "__ESBMC_ptr_obj_start_" << j;
-    endj << "__ESBMC_ptr_obj_end_" << j;
-    expr2tc start_j = symbol2tc(inttype, startj.str());
-    expr2tc end_j = symbol2tc(inttype, endj.str());
+    expr2tc start_j = obj_start(j);
+    expr2tc end_j = obj_end(j);
 
     // Formula: (i_end < j_start) || (i_start > j_end)
     // Previous assertions ensure start < end for all objs.
@@ -453,7 +545,7 @@ smt_astt smt_convt::convert_addr_of(const expr2tc &expr)
 
     /* constant 1 refers to member 'pointer_offset' of 'pointer_struct' */
     // Update pointer offset to offset to that field.
-    return a->update(this, convert_ast(offs), 1);
+    return pointer_update(a, convert_ast(offs), 1);
   }
 
   if(is_symbol2t(obj.ptr_obj))
@@ -571,13 +663,21 @@ void smt_convt::init_addr_space_array()
   expr2tc null_ptr_tuple = constant_struct2tc(pointer_struct, null_members);
   expr2tc invalid_ptr_tuple = constant_struct2tc(pointer_struct, inv_members);
 
-  null_ptr_ast = convert_ast(null_ptr_tuple);
-  invalid_ptr_ast = convert_ast(invalid_ptr_tuple);
+  null_ptr_ast = pointer_create(null_ptr_tuple);
+  invalid_ptr_ast = pointer_create(invalid_ptr_tuple);
 
   // Give value to 'NULL', 'INVALID' symbols
-  assert_expr(equality2tc(symbol2tc(pointer_struct, "NULL"), null_ptr_tuple));
-  assert_expr(
-    equality2tc(symbol2tc(pointer_struct, "INVALID"), invalid_ptr_tuple));
+  if(flat_pointers)
+  {
+    assert_ast(mk_pointer_symbol("NULL")->eq(this, null_ptr_ast));
+    assert_ast(mk_pointer_symbol("INVALID")->eq(this, invalid_ptr_ast));
+  }
+  else
+  {
+    assert_expr(equality2tc(symbol2tc(pointer_struct, "NULL"), null_ptr_tuple));
+    assert_expr(
+      equality2tc(symbol2tc(pointer_struct, "INVALID"), invalid_ptr_tuple));
+  }
 
   addr_space_data.back()[0] = 0;
   addr_space_data.back()[1] = 0;
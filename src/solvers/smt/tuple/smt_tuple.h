@@ -2,7 +2,6 @@
 #define _ESBMC_SOLVERS_SMT_TUPLE_SMT_TUPLE_H_
 
 #include <solvers/smt/smt_ast.h>
-#include <solvers/smt/tuple/smt_tuple_sort.h>
 
 // Abstract class defining the interface required for creating tuples.
 class tuple_iface
@@ -59,6 +58,10 @@ public:
     const type2tc &subtype) = 0;
 
   virtual void add_tuple_constraints_for_solving(){};
+  /** @see array_iface::refine_array_model */
+  virtual void refine_tuple_model(std::vector<smt_astt> &)
+  {
+  }
   virtual void push_tuple_ctx(){};
   virtual void pop_tuple_ctx(){};
 
@@ -1,5 +1,6 @@
 #include <solvers/smt/smt_conv.h>
 #include <solvers/smt/tuple/smt_tuple_array_ast.h>
+#include <solvers/smt/tuple/smt_tuple_sym.h>
 #include <sstream>
 #include <util/base_type.h>
 #include <util/c_types.h>
@@ -14,9 +15,8 @@ array_sym_smt_ast::ite(smt_convt *ctx, smt_astt cond, smt_astt falseop) const
   assert(is_array_type(sort->get_tuple_type()));
   const array_type2t &array_type = to_array_type(sort->get_tuple_type());
 
-  std::string name = ctx->mk_fresh_name("tuple_array_ite::") + ".";
-  expr2tc result = symbol2tc(sort->get_tuple_type(), name);
-  smt_astt result_sym = ctx->convert_ast(result);
+  tuple_sym_smt_astt result_sym = new(ctx) array_sym_smt_ast(
+    flat, ctx, sort, flat.fresh_symbol("tuple_array_ite::"));
 
   const struct_union_data &data = ctx->get_type_def(array_type.subtype);
 
@@ -38,7 +38,7 @@ array_sym_smt_ast::ite(smt_convt *ctx, smt_astt cond, smt_astt falseop) const
     i++;
   }
 
-  return ctx->convert_ast(result);
+  return result_sym;
 }
 
 smt_astt array_sym_smt_ast::eq(smt_convt *ctx, smt_astt other) const
@@ -90,8 +90,8 @@ smt_astt array_sym_smt_ast::update(
     index = idx_expr;
   }
 
-  std::string name = ctx->mk_fresh_name("tuple_array_update::") + ".";
-  tuple_sym_smt_astt result = new array_sym_smt_ast(ctx, sort, name);
+  tuple_sym_smt_astt result = new(ctx) array_sym_smt_ast(
+    flat, ctx, sort, flat.fresh_symbol("tuple_array_update::"));
 
   // Iterate over all members. They are _all_ indexed and updated.
   unsigned int i = 0;
@@ -121,8 +121,8 @@ smt_astt array_sym_smt_ast::select(smt_convt *ctx, const expr2tc &idx) const
   const struct_union_data &data = ctx->get_type_def(array_type.subtype);
   smt_sortt result_sort = ctx->convert_sort(array_type.subtype);
 
-  std::string name = ctx->mk_fresh_name("tuple_array_select::") + ".";
-  tuple_sym_smt_astt result = new tuple_sym_smt_ast(ctx, result_sort, name);
+  tuple_sym_smt_astt result = new(ctx) tuple_sym_smt_ast(
+    flat, ctx, result_sort, flat.fresh_symbol("tuple_array_select::"));
 
   unsigned int i = 0;
   for(auto const &it : data.members)
@@ -152,24 +152,16 @@ smt_astt array_sym_smt_ast::project(smt_convt *ctx, unsigned int idx) const
 
   assert(
     idx < data.members.size() && "Out-of-bounds tuple-array element accessed");
-  const std::string &fieldname = data.member_names[idx].as_string();
-  std::string sym_name = name + fieldname;
-
   const type2tc &restype = data.members[idx];
   type2tc new_arr_type =
     array_type2tc(restype, arr.array_size, arr.size_is_infinite);
   smt_sortt s = ctx->convert_sort(new_arr_type);
 
-  if(is_tuple_ast_type(restype) || is_tuple_array_ast_type(restype))
-  {
-    // This is a struct within a struct, so just generate the name prefix of
-    // the internal struct being projected.
-    sym_name = sym_name + ".";
-    return new array_sym_smt_ast(ctx, s, sym_name);
-  }
-
-  // This is a normal variable, so create a normal symbol of its name.
-  return ctx->mk_smt_symbol(sym_name, s);
+  // A struct within a struct is an array of that struct here, so it is always
+  // represented by an array_sym_smt_ast.
+  bool nested =
+    ctx->is_tuple_ast_type(restype) || ctx->is_tuple_array_ast_type(restype);
+  return flat.project(id, idx, data.member_names[idx], s, nested, nested);
 }
 
 void array_sym_smt_ast::assign(smt_convt *ctx, smt_astt sym) const
@@ -14,7 +14,7 @@ smt_astt smt_tuple_node_flattener::tuple_create(const expr2tc &structdef)
   // Add a . suffix because this is of tuple type.
   name += ".";
 
-  tuple_node_smt_ast *result = new tuple_node_smt_ast(
+  tuple_node_smt_ast *result = new(ctx) tuple_node_smt_ast(
     *this, ctx, ctx->convert_sort(structdef->type), name);
   result->elements.resize(structdef->get_num_sub_exprs());
 
@@ -40,7 +40,7 @@ smt_astt smt_tuple_node_flattener::tuple_fresh(smt_sortt s, std::string name)
     return array_conv.mk_array_symbol(name, s, subtype);
   }
 
-  return new tuple_node_smt_ast(*this, ctx, s, name);
+  return new(ctx) tuple_node_smt_ast(*this, ctx, s, name);
 }
 
 smt_astt
@@ -62,7 +62,7 @@ smt_tuple_node_flattener::mk_tuple_symbol(const std::string &name, smt_sortt s)
     name2 += ".";
 
   assert(s->id != SMT_SORT_ARRAY);
-  return new tuple_node_smt_ast(*this, ctx, s, name2);
+  return new(ctx) tuple_node_smt_ast(*this, ctx, s, name2);
 }
 
 smt_astt smt_tuple_node_flattener::mk_tuple_array_symbol(const expr2tc &expr)
@@ -160,11 +160,11 @@ expr2tc smt_tuple_node_flattener::tuple_get_rec(tuple_node_smt_astt tuple)
   for(auto const &it : strct.members)
   {
     expr2tc res;
-    if(is_tuple_ast_type(it))
+    if(ctx->is_tuple_ast_type(it))
     {
       res = tuple_get_rec(to_tuple_node_ast(tuple->elements[i]));
     }
-    else if(is_tuple_array_ast_type(it))
+    else if(ctx->is_tuple_array_ast_type(it))
     {
       res = expr2tc(); // XXX currently unimplemented
     }
@@ -173,8 +173,9 @@ expr2tc smt_tuple_node_flattener::tuple_get_rec(tuple_node_smt_astt tuple)
       res =
         ctx->get_bool(tuple->elements[i]) ? gen_true_expr() : gen_false_expr();
     }
-    else if(is_number_type(it) || is_union_type(it))
+    else if(is_number_type(it) || is_union_type(it) || is_pointer_type(it))
     {
+      // Pointers only get here when they are not tuples themselves
       res = ctx->get_by_ast(it, tuple->elements[i]);
     }
     else if(is_array_type(it))
@@ -264,6 +265,12 @@ void smt_tuple_node_flattener::add_tuple_constraints_for_solving()
   array_conv.add_array_constraints_for_solving();
 }
 
+void smt_tuple_node_flattener::refine_tuple_model(
+  std::vector<smt_astt> &lemmas)
+{
+  array_conv.refine_array_model(lemmas);
+}
+
 void smt_tuple_node_flattener::push_tuple_ctx()
 {
   array_conv.push_array_ctx();
@@ -42,6 +42,7 @@ public:
     smt_sortt domain) override;
 
   void add_tuple_constraints_for_solving() override;
+  void refine_tuple_model(std::vector<smt_astt> &lemmas) override;
   void push_tuple_ctx() override;
   void pop_tuple_ctx() override;
 
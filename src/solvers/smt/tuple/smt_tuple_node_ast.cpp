@@ -28,11 +28,11 @@ void tuple_node_smt_ast::make_free(smt_convt *ctx)
     smt_sortt newsort = ctx->convert_sort(it);
     std::string fieldname = name + "." + strct.member_names[i].as_string();
 
-    if(is_tuple_ast_type(it))
+    if(ctx->is_tuple_ast_type(it))
     {
       elements[i] = ctx->tuple_api->tuple_fresh(newsort, fieldname);
     }
-    else if(is_tuple_array_ast_type(it))
+    else if(ctx->is_tuple_array_ast_type(it))
     {
       std::string newname = ctx->mk_fresh_name(fieldname);
       smt_sortt subsort =
@@ -66,7 +66,7 @@ tuple_node_smt_ast::ite(smt_convt *ctx, smt_astt cond, smt_astt falseop) const
 
   std::string name = ctx->mk_fresh_name("tuple_ite::") + ".";
   tuple_node_smt_ast *result_sym =
-    new tuple_node_smt_ast(flat, ctx, sort, name);
+    new(ctx) tuple_node_smt_ast(flat, ctx, sort, name);
 
   const_cast<tuple_node_smt_ast *>(true_val)->make_free(ctx);
   const_cast<tuple_node_smt_ast *>(false_val)->make_free(ctx);
@@ -145,7 +145,8 @@ smt_astt tuple_node_smt_ast::update(
     "structure");
 
   std::string name = ctx->mk_fresh_name("tuple_update::") + ".";
-  tuple_node_smt_ast *result = new tuple_node_smt_ast(flat, ctx, sort, name);
+  tuple_node_smt_ast *result =
+    new(ctx) tuple_node_smt_ast(flat, ctx, sort, name);
   result->elements = elements;
   result->make_free(ctx);
   result->elements[idx] = value;
@@ -9,14 +9,12 @@
 smt_astt smt_tuple_sym_flattener::tuple_create(const expr2tc &structdef)
 {
   // From a vector of expressions, create a tuple representation by creating
-  // a fresh name and assigning members into it.
-  std::string name = ctx->mk_fresh_name("tuple_create::");
-
-  // Add a . suffix because this is of tuple type.
-  name += ".";
-
-  smt_astt result =
-    new tuple_sym_smt_ast(ctx, ctx->convert_sort(structdef->type), name);
+  // a fresh symbol and assigning members into it.
+  smt_astt result = new(ctx) tuple_sym_smt_ast(
+    *this,
+    ctx,
+    ctx->convert_sort(structdef->type),
+    fresh_symbol("tuple_create::"));
 
   for(unsigned int i = 0; i < structdef->get_num_sub_exprs(); i++)
   {
@@ -30,13 +28,13 @@ smt_astt smt_tuple_sym_flattener::tuple_create(const expr2tc &structdef)
 
 smt_astt smt_tuple_sym_flattener::tuple_fresh(smt_sortt s, std::string name)
 {
-  std::string n =
-    (name == "") ? ctx->mk_fresh_name("tuple_fresh::") + "." : name;
+  unsigned id =
+    (name == "") ? fresh_symbol("tuple_fresh::") : intern_symbol(name);
 
   if(s->id == SMT_SORT_ARRAY)
-    return new array_sym_smt_ast(ctx, s, n);
+    return new(ctx) array_sym_smt_ast(*this, ctx, s, id);
 
-  return new tuple_sym_smt_ast(ctx, s, n);
+  return new(ctx) tuple_sym_smt_ast(*this, ctx, s, id);
 }
 
 smt_astt
@@ -50,7 +48,7 @@ smt_tuple_sym_flattener::mk_tuple_symbol(const std::string &name, smt_sortt s)
     name2 += ".";
 
   assert(s->id != SMT_SORT_ARRAY);
-  return new tuple_sym_smt_ast(ctx, s, name2);
+  return new(ctx) tuple_sym_smt_ast(*this, ctx, s, intern_symbol(name2));
 }
 
 smt_astt smt_tuple_sym_flattener::mk_tuple_array_symbol(const expr2tc &expr)
@@ -59,7 +57,7 @@ smt_astt smt_tuple_sym_flattener::mk_tuple_array_symbol(const expr2tc &expr)
   const symbol2t &sym = to_symbol2t(expr);
   std::string name = sym.get_symbol_name() + "[]";
   smt_sortt sort = ctx->convert_sort(sym.type);
-  return new array_sym_smt_ast(ctx, sort, name);
+  return new(ctx) array_sym_smt_ast(*this, ctx, sort, intern_symbol(name));
 }
 
 smt_astt smt_tuple_sym_flattener::tuple_array_create(
@@ -74,8 +72,8 @@ smt_astt smt_tuple_sym_flattener::tuple_array_create(
   // index. Ignore infinite arrays, they're "not for you".
   // XXX - probably more efficient to update each member array, but not now.
   smt_sortt sort = ctx->convert_sort(array_type);
-  std::string name = ctx->mk_fresh_name("tuple_array_create::") + ".";
-  smt_astt newsym = new array_sym_smt_ast(ctx, sort, name);
+  smt_astt newsym = new(ctx) array_sym_smt_ast(
+    *this, ctx, sort, fresh_symbol("tuple_array_create::"));
 
   // Check size
   const array_type2t &arr_type = to_array_type(array_type);
@@ -115,40 +113,22 @@ smt_astt smt_tuple_sym_flattener::tuple_array_create(
   return newsym;
 }
 
-expr2tc smt_tuple_sym_flattener::tuple_get(const type2tc &, smt_astt)
-{
-  log_error(
-    "Fetching tuples from tuple-sym-flattener without the concrete symbol "
-    "is currently not implemented, returning empty expression...");
-  return expr2tc();
-}
-
-expr2tc smt_tuple_sym_flattener::tuple_get(const expr2tc &expr)
+expr2tc smt_tuple_sym_flattener::tuple_get(const type2tc &type, smt_astt a)
 {
-  assert(is_symbol2t(expr) && "Non-symbol in smtlib expr get()");
-  const symbol2t &sym = to_symbol2t(expr);
-  std::string name = sym.get_symbol_name();
+  tuple_sym_smt_astt ta = to_tuple_sym_ast(a);
 
   const type2tc &thetype =
-    (is_structure_type(expr->type)) ? expr->type : ctx->pointer_struct;
+    (is_structure_type(type)) ? type : ctx->pointer_struct;
   const struct_union_data &strct = ctx->get_type_def(thetype);
 
-  // XXX - what's the correct type to return here.
+  // Run through all fields and fetch them through their projections.
   std::vector<expr2tc> outmem;
-
-  // Run through all fields and despatch to 'get' again.
-  unsigned int i = 0;
-  for(auto const &it : strct.members)
-  {
-    std::stringstream ss;
-    ss << name << "." << strct.member_names[i];
-    expr2tc sym = symbol2tc(it, ss.str());
-    outmem.push_back(ctx->get(sym));
-    i++;
-  }
+  outmem.reserve(strct.members.size());
+  for(unsigned int i = 0; i < strct.members.size(); i++)
+    outmem.push_back(ctx->get_by_ast(strct.members[i], ta->project(ctx, i)));
 
   // If it's a pointer, rewrite.
-  if(is_pointer_type(expr->type))
+  if(is_pointer_type(type))
   {
     // Guard against free pointer value
     if(is_nil_expr(outmem[0]))
@@ -157,10 +137,19 @@ expr2tc smt_tuple_sym_flattener::tuple_get(const expr2tc &expr)
     unsigned int num = to_constant_int2t(outmem[0]).value.to_uint64();
     unsigned int offs = to_constant_int2t(outmem[1]).value.to_uint64();
     pointer_logict::pointert p(num, BigInt(offs));
-    return ctx->pointer_logic.back().pointer_expr(p, expr->type);
+    return ctx->pointer_logic.back().pointer_expr(p, type);
   }
 
-  return constant_struct2tc(expr->type, std::move(outmem));
+  return constant_struct2tc(type, std::move(outmem));
+}
+
+expr2tc smt_tuple_sym_flattener::tuple_get(const expr2tc &expr)
+{
+  assert(is_symbol2t(expr) && "Non-symbol in smtlib expr get()");
+  const symbol2t &sym = to_symbol2t(expr);
+  smt_astt a =
+    mk_tuple_symbol(sym.get_symbol_name(), ctx->convert_sort(expr->type));
+  return tuple_get(expr->type, a);
 }
 
 smt_astt smt_tuple_sym_flattener::tuple_array_of(
@@ -175,11 +164,9 @@ smt_astt smt_tuple_sym_flattener::tuple_array_of(
 
   expr2tc arrsize = constant_int2tc(index_type2(), BigInt(array_size));
   type2tc arrtype = array_type2tc(init_val->type, arrsize, false);
-  std::string name = ctx->mk_fresh_name("tuple_array_of::") + ".";
-  expr2tc tuple_arr_of_sym = symbol2tc(arrtype, irep_idt(name));
-
   smt_sortt sort = ctx->convert_sort(arrtype);
-  smt_astt newsym = new array_sym_smt_ast(ctx, sort, name);
+  smt_astt newsym = new(ctx)
+    array_sym_smt_ast(*this, ctx, sort, fresh_symbol("tuple_array_of::"));
 
   assert(subtype.members.size() == data.datatype_members.size());
   for(unsigned long i = 0; i < subtype.members.size(); i++)
@@ -188,8 +175,7 @@ smt_astt smt_tuple_sym_flattener::tuple_array_of(
     type2tc subarr_type = array_type2tc(val->type, arrsize, false);
     expr2tc sub_array_of = constant_array_of2tc(subarr_type, val);
 
-    smt_astt tuple_arr_of_sym_ast = ctx->convert_ast(tuple_arr_of_sym);
-    smt_astt target_array = tuple_arr_of_sym_ast->project(ctx, i);
+    smt_astt target_array = newsym->project(ctx, i);
 
     smt_astt sub_array_of_ast = ctx->convert_ast(sub_array_of);
     ctx->assert_ast(target_array->eq(ctx, sub_array_of_ast));
@@ -226,3 +212,86 @@ smt_sortt smt_tuple_sym_flattener::mk_struct_sort(const type2tc &type)
 
   return new smt_sort(SMT_SORT_STRUCT, type);
 }
+
+void smt_tuple_sym_flattener::push_tuple_ctx()
+{
+  projection_marks.push_back(projection_log.size());
+}
+
+void smt_tuple_sym_flattener::pop_tuple_ctx()
+{
+  // The projections made since the push are about to be freed
+  for(size_t i = projection_marks.back(); i < projection_log.size(); i++)
+    projections.erase(projection_log[i]);
+
+  projection_log.resize(projection_marks.back());
+  projection_marks.pop_back();
+}
+
+unsigned smt_tuple_sym_flattener::intern_symbol(const std::string &name)
+{
+  auto [it, inserted] = named_symbols.emplace(name, symbol_names.size());
+  if(inserted)
+    symbol_names.push_back({no_parent, irep_idt(), nullptr, name});
+  return it->second;
+}
+
+unsigned smt_tuple_sym_flattener::fresh_symbol(const char *tag)
+{
+  symbol_names.push_back({no_parent, irep_idt(), tag, ""});
+  return symbol_names.size() - 1;
+}
+
+const std::string &smt_tuple_sym_flattener::symbol_name(unsigned id)
+{
+  if(!symbol_names[id].name.empty())
+    return symbol_names[id].name;
+
+  // Add a . suffix because this is of tuple type.
+  std::string name;
+  if(symbol_names[id].parent == no_parent)
+    name = ctx->mk_fresh_name(symbol_names[id].tag) + ".";
+  else
+    name = symbol_name(symbol_names[id].parent) +
+           symbol_names[id].field_name.as_string() + ".";
+
+  return symbol_names[id].name = std::move(name);
+}
+
+smt_astt smt_tuple_sym_flattener::project(
+  unsigned id,
+  unsigned idx,
+  const irep_idt &field_name,
+  smt_sortt s,
+  bool nested,
+  bool array)
+{
+  auto it = projections.find(key(id, idx));
+  if(it != projections.end())
+    return it->second;
+
+  smt_astt result;
+  if(nested)
+  {
+    // This is a struct within a struct: number the inner struct, its name
+    // prefix is only generated if one of its fields needs it.
+    auto [field, inserted] =
+      field_symbols.emplace(key(id, idx), symbol_names.size());
+    if(inserted)
+      symbol_names.push_back({id, field_name, nullptr, ""});
+
+    if(array)
+      result = new(ctx) array_sym_smt_ast(*this, ctx, s, field->second);
+    else
+      result = new(ctx) tuple_sym_smt_ast(*this, ctx, s, field->second);
+  }
+  else
+  {
+    // This is a normal variable, so create a normal symbol of its name.
+    result = ctx->mk_smt_symbol(symbol_name(id) + field_name.as_string(), s);
+  }
+
+  projections.emplace(key(id, idx), result);
+  projection_log.push_back(key(id, idx));
+  return result;
+}
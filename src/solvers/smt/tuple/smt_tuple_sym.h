@@ -2,6 +2,7 @@
 #define SOLVERS_SMT_TUPLE_SMT_TUPLE_SYM_H_
 
 #include <solvers/smt/smt_conv.h>
+#include <unordered_map>
 #include <util/namespace.h>
 
 class tuple_sym_smt_ast;
@@ -30,15 +31,66 @@ public:
   expr2tc
   tuple_get_array_elem(smt_astt array, uint64_t index, const type2tc &subtype);
 
-  expr2tc tuple_get_rec(tuple_sym_smt_astt tuple);
   smt_astt tuple_array_create(
     const type2tc &array_type,
     smt_astt *input_args,
     bool const_array,
     smt_sortt domain) override;
 
+  void push_tuple_ctx() override;
+  void pop_tuple_ctx() override;
+
+  /** Tuple symbols are identified by number rather than by name. A number
+   *  stands either for a named symbol, for a fresh symbol, or for a field of
+   *  another tuple symbol that is a tuple itself. The textual name, which
+   *  solver symbols need, is only built for the tuples whose scalar fields
+   *  are actually used. */
+  unsigned intern_symbol(const std::string &name);
+  unsigned fresh_symbol(const char *tag);
+  const std::string &symbol_name(unsigned id);
+
+  /** Field \p idx of tuple symbol \p id, named \p field_name and of sort
+   *  \p s: another tuple symbol if \p nested, with array_sym_smt_ast as its
+   *  representation if \p array, and a solver symbol otherwise. Repeated
+   *  projections return the first result. */
+  smt_astt project(
+    unsigned id,
+    unsigned idx,
+    const irep_idt &field_name,
+    smt_sortt s,
+    bool nested,
+    bool array);
+
   smt_convt *ctx;
   const namespacet &ns;
+
+protected:
+  struct symbol_namet
+  {
+    /// Tuple this is a field of, or no_parent
+    unsigned parent;
+    irep_idt field_name;
+    /// Fresh name prefix, for fresh symbols
+    const char *tag;
+    /// Textual name, empty until symbol_name() is asked for it
+    std::string name;
+  };
+  static constexpr unsigned no_parent = ~0u;
+
+  static uint64_t key(unsigned id, unsigned idx)
+  {
+    return (uint64_t(id) << 32) | idx;
+  }
+
+  std::vector<symbol_namet> symbol_names;
+  std::unordered_map<std::string, unsigned> named_symbols;
+  std::unordered_map<uint64_t, unsigned> field_symbols;
+
+  /** Results of project(). The ASTs made in a context are freed when it is
+   *  popped, so each push records where the log stood. */
+  std::unordered_map<uint64_t, smt_astt> projections;
+  std::vector<uint64_t> projection_log;
+  std::vector<size_t> projection_marks;
 };
 
 #endif
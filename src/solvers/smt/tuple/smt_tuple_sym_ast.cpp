@@ -68,9 +68,8 @@ tuple_sym_smt_ast::ite(smt_convt *ctx, smt_astt cond, smt_astt falseop) const
   tuple_sym_smt_astt true_val = this;
   tuple_sym_smt_astt false_val = to_tuple_sym_ast(falseop);
 
-  std::string name = ctx->mk_fresh_name("tuple_ite::") + ".";
-  expr2tc result = symbol2tc(sort->get_tuple_type(), name);
-  smt_astt result_sym = ctx->convert_ast(result);
+  tuple_sym_smt_astt result_sym = new(ctx)
+    tuple_sym_smt_ast(flat, ctx, sort, flat.fresh_symbol("tuple_ite::"));
 
   const struct_union_data &data = ctx->get_type_def(sort->get_tuple_type());
 
@@ -86,7 +85,7 @@ tuple_sym_smt_ast::ite(smt_convt *ctx, smt_astt cond, smt_astt falseop) const
     ctx->assert_ast(result_sym_ast->eq(ctx, result_ast));
   }
 
-  return ctx->convert_ast(result);
+  return result_sym;
 }
 
 smt_astt tuple_sym_smt_ast::eq(smt_convt *ctx, smt_astt other) const
@@ -129,8 +128,8 @@ smt_astt tuple_sym_smt_ast::update(
   // XXX: future work, accept member_name exprs?
   const struct_union_data &data = ctx->get_type_def(sort->get_tuple_type());
 
-  std::string name = ctx->mk_fresh_name("tuple_update::") + ".";
-  tuple_sym_smt_astt result = new tuple_sym_smt_ast(ctx, sort, name);
+  tuple_sym_smt_astt result = new(ctx)
+    tuple_sym_smt_ast(flat, ctx, sort, flat.fresh_symbol("tuple_update::"));
 
   // Iterate over all members, deciding what to do with them.
   for(unsigned int j = 0; j < data.members.size(); j++)
@@ -167,34 +166,23 @@ smt_astt tuple_sym_smt_ast::select(
 
 smt_astt tuple_sym_smt_ast::project(smt_convt *ctx, unsigned int idx) const
 {
-  // Create an AST representing the i'th field of the tuple a. This means we
-  // have to open up the (tuple symbol) a, tack on the field name to the end
-  // of that name, and then return that. It now names the variable that contains
-  // the value of that field. If it's actually another tuple, we instead return
-  // a new tuple_sym_smt_ast containing its name.
+  // Create an AST representing the i'th field of the tuple a: the variable
+  // named by the tuple symbol with the field name tacked onto the end. If it's
+  // actually another tuple, we instead get a new tuple_sym_smt_ast for the
+  // field. The flattener keeps both, so asking again costs a lookup.
   const struct_union_data &data = ctx->get_type_def(sort->get_tuple_type());
 
   assert(idx < data.members.size() && "Out-of-bounds tuple element accessed");
-  const std::string &fieldname = data.member_names[idx].as_string();
-  std::string sym_name = name + fieldname;
 
   // Cope with recursive structs.
   const type2tc &restype = data.members[idx];
   smt_sortt s = ctx->convert_sort(restype);
 
-  if(is_tuple_ast_type(restype) || is_tuple_array_ast_type(restype))
-  {
-    // This is a struct within a struct, so just generate the name prefix of
-    // the internal struct being projected.
-    sym_name = sym_name + ".";
-    if(is_tuple_array_ast_type(restype))
-      return new array_sym_smt_ast(ctx, s, sym_name);
-
-    return new tuple_sym_smt_ast(ctx, s, sym_name);
-  }
-  else
-  {
-    // This is a normal variable, so create a normal symbol of its name.
-    return ctx->mk_smt_symbol(sym_name, s);
-  }
+  return flat.project(
+    id,
+    idx,
+    data.member_names[idx],
+    s,
+    ctx->is_tuple_ast_type(restype) || ctx->is_tuple_array_ast_type(restype),
+    ctx->is_tuple_array_ast_type(restype));
 }
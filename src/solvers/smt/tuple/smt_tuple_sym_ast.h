@@ -6,24 +6,30 @@
 class tuple_sym_smt_ast;
 typedef const tuple_sym_smt_ast *tuple_sym_smt_astt;
 
-class smt_tuple_node_flattener;
+class smt_tuple_sym_flattener;
 
 class tuple_sym_smt_ast : public smt_ast
 {
 public:
   /** Primary constructor.
    *  @param s The sort of the tuple, of type tuple_smt_sort.
-   *  @param _name The symbol prefix of the variables representing this tuples
-   *               value. */
-  tuple_sym_smt_ast(smt_convt *ctx, smt_sortt s, std::string _name)
-    : smt_ast(ctx, s), name(std::move(_name))
+   *  @param _id The interned tuple symbol whose fields hold this tuples
+   *             value. */
+  tuple_sym_smt_ast(
+    smt_tuple_sym_flattener &_flat,
+    smt_convt *ctx,
+    smt_sortt s,
+    unsigned _id)
+    : smt_ast(ctx, s), flat(_flat), id(_id)
   {
   }
   ~tuple_sym_smt_ast() override = default;
 
-  /** The symbol prefix of the variables representing this tuples value, as a
-   *  string (i.e., no associated type). */
-  const std::string name;
+  smt_tuple_sym_flattener &flat;
+
+  /** The tuple symbol representing this tuples value, numbered by
+   *  smt_tuple_sym_flattener::intern_symbol and friends. */
+  const unsigned id;
 
   smt_astt ite(smt_convt *ctx, smt_astt cond, smt_astt falseop) const override;
   smt_astt eq(smt_convt *ctx, smt_astt other) const override;
@@ -7,9 +7,15 @@
 
 #include <solvers/smt/tuple/smt_tuple_node.h>
 
+#include <algorithm>
 #include <cinttypes>
+#include <condition_variable>
+#include <cstdarg>
+#include <deque>
+#include <mutex>
 #include <regex>
 #include <sstream>
+#include <thread>
 
 #ifndef _WIN32
 #include <unistd.h>
@@ -193,6 +199,127 @@ smtlib_convt::file_emitter::~file_emitter() noexcept
     fclose(out_stream);
 }
 
+/** A bounded queue of formatted chunks and the thread writing them out.
+ *  Formatting happens in the converting thread into a pending buffer; full
+ *  buffers are handed over to the writer, which blocks on the pipe while the
+ *  solver parses. At most max_chunks are in flight, beyond that the producer
+ *  waits. The first write error is kept and reported on the next hand-over. */
+class smtlib_convt::process_emitter::async_writert
+{
+  static constexpr size_t chunk_size = 64 * 1024;
+  static constexpr size_t max_chunks = 16;
+
+  FILE *out;
+  std::mutex mtx;
+  std::condition_variable cv_ready;
+  std::condition_variable cv_space;
+  std::deque<std::string> chunks;
+  bool writing = false;
+  bool done = false;
+  int error = 0;
+  std::string pending;
+  std::thread thread;
+
+  void run()
+  {
+    std::unique_lock<std::mutex> lock(mtx);
+    for(;;)
+    {
+      cv_ready.wait(lock, [this] { return done || !chunks.empty(); });
+      if(chunks.empty())
+        return;
+
+      std::string chunk = std::move(chunks.front());
+      chunks.pop_front();
+      writing = true;
+      bool failed = error != 0;
+      lock.unlock();
+
+      // After an error, keep draining so that the producer never blocks
+      int err = 0;
+      if(!failed)
+      {
+        errno = 0;
+        if(
+          fwrite(chunk.data(), 1, chunk.size(), out) != chunk.size() ||
+          fflush(out) == EOF)
+          err = errno ? errno : EIO;
+      }
+
+      lock.lock();
+      writing = false;
+      if(err && !error)
+        error = err;
+      cv_space.notify_all();
+    }
+  }
+
+  int push(bool wait)
+  {
+    std::unique_lock<std::mutex> lock(mtx);
+    if(!pending.empty())
+    {
+      cv_space.wait(
+        lock, [this] { return chunks.size() < max_chunks || error; });
+      chunks.push_back(std::move(pending));
+      pending.clear();
+      cv_ready.notify_one();
+    }
+    if(wait)
+      cv_space.wait(
+        lock, [this] { return (chunks.empty() && !writing) || error; });
+    return error;
+  }
+
+public:
+  explicit async_writert(FILE *out)
+    : out(out), thread(&async_writert::run, this)
+  {
+  }
+
+  ~async_writert()
+  {
+    push(false);
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      done = true;
+    }
+    cv_ready.notify_one();
+    thread.join();
+  }
+
+  /** Formats into the pending buffer, handing it over once it is full.
+   *  Returns the first write error seen so far, or 0. */
+  int appendf(const char *fmt, ...)
+  {
+    va_list ap, ap2;
+    va_start(ap, fmt);
+    va_copy(ap2, ap);
+
+    size_t old = pending.size();
+    size_t avail = 256;
+    pending.resize(old + avail);
+    int n = vsnprintf(&pending[old], avail, fmt, ap);
+    if(n >= 0 && (size_t)n >= avail)
+    {
+      pending.resize(old + n + 1);
+      vsnprintf(&pending[old], n + 1, fmt, ap2);
+    }
+    pending.resize(old + std::max(n, 0));
+
+    va_end(ap2);
+    va_end(ap);
+
+    return pending.size() >= chunk_size ? push(false) : 0;
+  }
+
+  /** Hands over the pending buffer and waits until all is written. */
+  int flush()
+  {
+    return push(true);
+  }
+};
+
 smtlib_convt::process_emitter::process_emitter(const std::string &cmd)
   : out_stream(nullptr), in_stream(nullptr), org_sigpipe_handler(nullptr)
 {
@@ -252,6 +379,7 @@ smtlib_convt::process_emitter::process_emitter(const std::string &cmd)
     close(inpipe[1]);
     out_stream = fdopen(outpipe[1], "w");
     in_stream = fdopen(inpipe[0], "r");
+    writer = std::make_unique<async_writert>(out_stream);
 
     org_sigpipe_handler = reinterpret_cast<void *>(signal(SIGPIPE, SIG_IGN));
     if(org_sigpipe_handler == SIG_ERR)
@@ -335,6 +463,8 @@ smtlib_convt::process_emitter::process_emitter(const std::string &cmd)
 
 smtlib_convt::process_emitter::~process_emitter() noexcept
 {
+  // Drain and stop the writer before closing the stream beneath it
+  writer.reset();
   if(out_stream)
     fclose(out_stream);
   if(in_stream)
@@ -458,7 +588,8 @@ unsigned int smtlib_convt::emit_terminal_ast(
 unsigned int smtlib_convt::emit_ast(
   const smtlib_smt_ast *ast,
   std::string &output,
-  std::unordered_map<const smtlib_smt_ast *, std::string> &temp_symbols) const
+  std::unordered_map<const smtlib_smt_ast *, std::string> &temp_symbols,
+  bool use_definitions) const
 {
   unsigned int brace_level = 0;
   assert(ast->args.size() <= 4);
@@ -483,6 +614,15 @@ unsigned int smtlib_convt::emit_ast(
     return 0;
   }
 
+  if(use_definitions)
+  {
+    if(auto it = defined_terms.find(ast); it != defined_terms.end())
+    {
+      output = it->second;
+      return 0;
+    }
+  }
+
   // Get a temporary sym name
   size_t tempnum = temp_symbols.size();
   std::stringstream ss;
@@ -493,11 +633,28 @@ unsigned int smtlib_convt::emit_ast(
 
   for(unsigned long int i = 0; i < ast->args.size(); i++)
     brace_level += emit_ast(
-      static_cast<const smtlib_smt_ast *>(ast->args[i]), args[i], temp_symbols);
+      static_cast<const smtlib_smt_ast *>(ast->args[i]),
+      args[i],
+      temp_symbols,
+      use_definitions);
 
   // Emit a let, assigning the result of this AST func to the sym.
   // For some reason let requires a double-braced operand.
-  emit("(let ((%s (", tempname.c_str());
+  emit("(let ((%s ", tempname.c_str());
+  emit_app(ast, args);
+
+  // End operand to let (two braces).
+  emit("%s", "))\n");
+
+  // We end with one additional brace level.
+  output = tempname;
+  return brace_level + 1;
+}
+
+void smtlib_convt::emit_app(const smtlib_smt_ast *ast, const std::string *args)
+  const
+{
+  emit("%s", "(");
 
   // This asts function
   assert(static_cast<size_t>(ast->kind) < smt_func_name_table.size());
@@ -515,15 +672,47 @@ unsigned int smtlib_convt::emit_ast(
   for(unsigned long int i = 0; i < ast->args.size(); i++)
     emit(" %s", args[i].c_str());
 
-  // End func enclosing brace, then operand to let (two braces).
-  emit("%s", ")))\n");
+  emit("%s", ")");
+}
 
-  // We end with one additional brace level.
-  output = tempname;
-  return brace_level + 1;
+std::string smtlib_convt::define_ast(const smtlib_smt_ast *ast)
+{
+  if(auto it = defined_terms.find(ast); it != defined_terms.end())
+    return it->second;
+
+  std::string output;
+  switch(ast->kind)
+  {
+  case SMT_FUNC_INT:
+  case SMT_FUNC_BOOL:
+  case SMT_FUNC_BVINT:
+  case SMT_FUNC_REAL:
+  case SMT_FUNC_SYMBOL:
+    // Nothing to define, but remember the text; symbols are costly to quote
+    emit_terminal_ast(ast, output);
+    break;
+  default:
+  {
+    assert(ast->args.size() <= 4);
+    std::string args[4];
+    for(unsigned long int i = 0; i < ast->args.size(); i++)
+      args[i] = define_ast(static_cast<const smtlib_smt_ast *>(ast->args[i]));
+
+    output = "?d" + std::to_string(defined_num++);
+    std::string sort = sort_to_string(ast->sort);
+    emit("(define-fun %s () %s ", output.c_str(), sort.c_str());
+    emit_app(ast, args);
+    emit("%s", ")\n");
+  }
+  }
+
+  defined_terms.emplace(ast, output);
+  defined_order.push_back(ast);
+  return output;
 }
 
-void smtlib_convt::emit_ast(const smtlib_smt_ast *ast) const
+void smtlib_convt::emit_ast(const smtlib_smt_ast *ast, bool use_definitions)
+  const
 {
   // The algorithm: descend through the AST operands, binding values to
   // temporary symbols, then emit functions on those temporary symbols.
@@ -533,7 +722,8 @@ void smtlib_convt::emit_ast(const smtlib_smt_ast *ast) const
 
   std::string output;
   std::unordered_map<const smtlib_smt_ast *, std::string> temp_symbols;
-  unsigned int brace_level = emit_ast(ast, output, temp_symbols);
+  unsigned int brace_level =
+    emit_ast(ast, output, temp_symbols, use_definitions);
 
   /* Emit the final representation of the root, either a (possibly temporary)
    * symbol, or that of a terminal. */
@@ -554,7 +744,8 @@ void smtlib_smt_ast::dump() const
   FILE *tmp_file = std::exchange(ctx_m->emit_opt_output.out_stream, stderr);
   FILE *tmp_proc = std::exchange(ctx_m->emit_proc.out_stream, nullptr);
 
-  ctx->emit_ast(this);
+  // The definitions only exist in the solver, spell everything out
+  ctx->emit_ast(this, false);
   ctx->emit("%s", "\n");
   std::string sort_str = ctx->sort_to_string(sort);
   ctx->emit("sort: %s\n", sort_str.c_str());
@@ -611,6 +802,8 @@ sexpr smtlib_convt::get_value(smt_astt a) const
 {
   assert(emit_proc);
 
+  // No define-fun's here, they would leave the solver's sat mode that
+  // get-value needs. Existing definitions can be referred to though.
   emit("%s", "(get-value (");
   emit_ast(to_solver_smt_ast<smtlib_smt_ast>(a));
   emit("%s\n", "))");
@@ -725,16 +918,14 @@ template <typename... Ts>
 void smtlib_convt::process_emitter::emit(const char *fmt, Ts &&...ts) const
 {
   /* TODO: other error handling */
-  errno = 0;
-  if(fprintf(out_stream, fmt, ts...) < 0 && errno == EPIPE)
+  if(writer->appendf(fmt, ts...) == EPIPE)
     throw external_process_died(read_all(in_stream));
 }
 
 void smtlib_convt::process_emitter::flush() const
 {
   /* TODO: other error handling */
-  errno = 0;
-  if(fflush(out_stream) == EOF && errno == EPIPE)
+  if(writer->flush() == EPIPE)
     throw external_process_died(read_all(in_stream));
 }
 
@@ -809,19 +1000,15 @@ void smtlib_convt::assert_ast(smt_astt a)
 {
   const smtlib_smt_ast *sa = static_cast<const smtlib_smt_ast *>(a);
 
-  // Encode an assertion
-  emit("%s", "(assert\n");
-
-  emit_ast(sa);
-
-  // Final brace for closing the 'assert'.
-  emit("%s", ")\n");
+  // Define the subterms first, then assert the term referring to them
+  std::string term = define_ast(sa);
+  emit("(assert %s)\n", term.c_str());
 }
 
 smt_astt smtlib_convt::mk_smt_int(const BigInt &theint)
 {
   smt_sortt s = mk_int_sort();
-  smtlib_smt_ast *a = new smtlib_smt_ast(this, s, SMT_FUNC_INT);
+  smtlib_smt_ast *a = new(this) smtlib_smt_ast(this, s, SMT_FUNC_INT);
   a->intval = theint;
   return a;
 }
@@ -829,21 +1016,22 @@ smt_astt smtlib_convt::mk_smt_int(const BigInt &theint)
 smt_astt smtlib_convt::mk_smt_real(const std::string &str)
 {
   smt_sortt s = mk_real_sort();
-  smtlib_smt_ast *a = new smtlib_smt_ast(this, s, SMT_FUNC_REAL);
+  smtlib_smt_ast *a = new(this) smtlib_smt_ast(this, s, SMT_FUNC_REAL);
   a->realval = str;
   return a;
 }
 
 smt_astt smtlib_convt::mk_smt_bv(const BigInt &theint, smt_sortt s)
 {
-  smtlib_smt_ast *a = new smtlib_smt_ast(this, s, SMT_FUNC_BVINT);
+  smtlib_smt_ast *a = new(this) smtlib_smt_ast(this, s, SMT_FUNC_BVINT);
   a->intval = theint;
   return a;
 }
 
 smt_astt smtlib_convt::mk_smt_bool(bool val)
 {
-  smtlib_smt_ast *a = new smtlib_smt_ast(this, boolean_sort, SMT_FUNC_BOOL);
+  smtlib_smt_ast *a =
+    new(this) smtlib_smt_ast(this, boolean_sort, SMT_FUNC_BOOL);
   a->boolval = val;
   return a;
 }
@@ -858,7 +1046,7 @@ smt_astt smtlib_convt::mk_array_symbol(
 
 smt_astt smtlib_convt::mk_smt_symbol(const std::string &name, const smt_sort *s)
 {
-  smtlib_smt_ast *a = new smtlib_smt_ast(this, s, SMT_FUNC_SYMBOL);
+  smtlib_smt_ast *a = new(this) smtlib_smt_ast(this, s, SMT_FUNC_SYMBOL);
   a->symname = name;
 
   symbol_tablet::iterator it = symbol_table.find(name);
@@ -891,7 +1079,7 @@ smt_astt
 smtlib_convt::mk_extract(smt_astt a, unsigned int high, unsigned int low)
 {
   smt_sortt s = mk_bv_sort(high - low + 1);
-  smtlib_smt_ast *n = new smtlib_smt_ast(this, s, SMT_FUNC_EXTRACT);
+  smtlib_smt_ast *n = new(this) smtlib_smt_ast(this, s, SMT_FUNC_EXTRACT);
   n->extract_high = high;
   n->extract_low = low;
   n->args.push_back(a);
@@ -933,7 +1121,7 @@ smt_astt smtlib_convt::mk_concat(smt_astt a, smt_astt b)
       - concatenation of bitvectors of size i and j to get a new bitvector of
         size m, where m = i + j
   */
-  smtlib_smt_ast *ast = new smtlib_smt_ast(
+  smtlib_smt_ast *ast = new(this) smtlib_smt_ast(
     this,
     mk_bv_sort(a->sort->get_data_width() + b->sort->get_data_width()),
     SMT_FUNC_CONCAT);
@@ -947,7 +1135,7 @@ smt_astt smtlib_convt::mk_ite(smt_astt cond, smt_astt t, smt_astt f)
   assert(cond->sort->id == SMT_SORT_BOOL);
   assert(t->sort->get_data_width() == f->sort->get_data_width());
 
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, t->sort, SMT_FUNC_ITE);
+  smtlib_smt_ast *ast = new(this) smtlib_smt_ast(this, t->sort, SMT_FUNC_ITE);
   ast->args.push_back(cond);
   ast->args.push_back(t);
   ast->args.push_back(f);
@@ -965,6 +1153,7 @@ void smtlib_convt::push_ctx()
   smt_convt::push_ctx();
 
   emit("%s", "(push 1)\n");
+  defined_marks.push_back(defined_order.size());
 }
 
 smt_astt smtlib_convt::mk_add(smt_astt a, smt_astt b)
@@ -972,7 +1161,7 @@ smt_astt smtlib_convt::mk_add(smt_astt a, smt_astt b)
   assert(a->sort->id == SMT_SORT_INT || a->sort->id == SMT_SORT_REAL);
   assert(b->sort->id == SMT_SORT_INT || b->sort->id == SMT_SORT_REAL);
   assert(a->sort->id == b->sort->id);
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_ADD);
+  smtlib_smt_ast *ast = new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_ADD);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -983,7 +1172,7 @@ smt_astt smtlib_convt::mk_bvadd(smt_astt a, smt_astt b)
   assert(a->sort->id != SMT_SORT_INT && a->sort->id != SMT_SORT_REAL);
   assert(b->sort->id != SMT_SORT_INT && b->sort->id != SMT_SORT_REAL);
   assert(a->sort->get_data_width() == b->sort->get_data_width());
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_BVADD);
+  smtlib_smt_ast *ast = new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_BVADD);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -994,7 +1183,7 @@ smt_astt smtlib_convt::mk_sub(smt_astt a, smt_astt b)
   assert(a->sort->id == SMT_SORT_INT || a->sort->id == SMT_SORT_REAL);
   assert(b->sort->id == SMT_SORT_INT || b->sort->id == SMT_SORT_REAL);
   assert(a->sort->id == b->sort->id);
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_SUB);
+  smtlib_smt_ast *ast = new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_SUB);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1005,7 +1194,7 @@ smt_astt smtlib_convt::mk_bvsub(smt_astt a, smt_astt b)
   assert(a->sort->id != SMT_SORT_INT && a->sort->id != SMT_SORT_REAL);
   assert(b->sort->id != SMT_SORT_INT && b->sort->id != SMT_SORT_REAL);
   assert(a->sort->get_data_width() == b->sort->get_data_width());
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_BVSUB);
+  smtlib_smt_ast *ast = new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_BVSUB);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1016,7 +1205,7 @@ smt_astt smtlib_convt::mk_mul(smt_astt a, smt_astt b)
   assert(a->sort->id == SMT_SORT_INT || a->sort->id == SMT_SORT_REAL);
   assert(b->sort->id == SMT_SORT_INT || b->sort->id == SMT_SORT_REAL);
   assert(a->sort->id == b->sort->id);
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_MUL);
+  smtlib_smt_ast *ast = new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_MUL);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1027,7 +1216,7 @@ smt_astt smtlib_convt::mk_bvmul(smt_astt a, smt_astt b)
   assert(a->sort->id != SMT_SORT_INT && a->sort->id != SMT_SORT_REAL);
   assert(b->sort->id != SMT_SORT_INT && b->sort->id != SMT_SORT_REAL);
   assert(a->sort->get_data_width() == b->sort->get_data_width());
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_BVMUL);
+  smtlib_smt_ast *ast = new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_BVMUL);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1038,7 +1227,7 @@ smt_astt smtlib_convt::mk_mod(smt_astt a, smt_astt b)
   assert(a->sort->id == SMT_SORT_INT || a->sort->id == SMT_SORT_REAL);
   assert(b->sort->id == SMT_SORT_INT || b->sort->id == SMT_SORT_REAL);
   assert(a->sort->id == b->sort->id);
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_MOD);
+  smtlib_smt_ast *ast = new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_MOD);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1049,7 +1238,8 @@ smt_astt smtlib_convt::mk_bvsmod(smt_astt a, smt_astt b)
   assert(a->sort->id != SMT_SORT_INT && a->sort->id != SMT_SORT_REAL);
   assert(b->sort->id != SMT_SORT_INT && b->sort->id != SMT_SORT_REAL);
   assert(a->sort->get_data_width() == b->sort->get_data_width());
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_BVSMOD);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_BVSMOD);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1060,7 +1250,8 @@ smt_astt smtlib_convt::mk_bvumod(smt_astt a, smt_astt b)
   assert(a->sort->id != SMT_SORT_INT && a->sort->id != SMT_SORT_REAL);
   assert(b->sort->id != SMT_SORT_INT && b->sort->id != SMT_SORT_REAL);
   assert(a->sort->get_data_width() == b->sort->get_data_width());
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_BVUMOD);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_BVUMOD);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1071,7 +1262,7 @@ smt_astt smtlib_convt::mk_div(smt_astt a, smt_astt b)
   assert(a->sort->id == SMT_SORT_INT || a->sort->id == SMT_SORT_REAL);
   assert(b->sort->id == SMT_SORT_INT || b->sort->id == SMT_SORT_REAL);
   assert(a->sort->id == b->sort->id);
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_DIV);
+  smtlib_smt_ast *ast = new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_DIV);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1082,7 +1273,8 @@ smt_astt smtlib_convt::mk_bvsdiv(smt_astt a, smt_astt b)
   assert(a->sort->id != SMT_SORT_INT && a->sort->id != SMT_SORT_REAL);
   assert(b->sort->id != SMT_SORT_INT && b->sort->id != SMT_SORT_REAL);
   assert(a->sort->get_data_width() == b->sort->get_data_width());
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_BVSDIV);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_BVSDIV);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1093,7 +1285,8 @@ smt_astt smtlib_convt::mk_bvudiv(smt_astt a, smt_astt b)
   assert(a->sort->id != SMT_SORT_INT && a->sort->id != SMT_SORT_REAL);
   assert(b->sort->id != SMT_SORT_INT && b->sort->id != SMT_SORT_REAL);
   assert(a->sort->get_data_width() == b->sort->get_data_width());
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_BVUDIV);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_BVUDIV);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1104,7 +1297,7 @@ smt_astt smtlib_convt::mk_shl(smt_astt a, smt_astt b)
   assert(a->sort->id == SMT_SORT_INT || a->sort->id == SMT_SORT_REAL);
   assert(b->sort->id == SMT_SORT_INT || b->sort->id == SMT_SORT_REAL);
   assert(a->sort->id == b->sort->id);
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_SHL);
+  smtlib_smt_ast *ast = new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_SHL);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1115,7 +1308,7 @@ smt_astt smtlib_convt::mk_bvshl(smt_astt a, smt_astt b)
   assert(a->sort->id != SMT_SORT_INT && a->sort->id != SMT_SORT_REAL);
   assert(b->sort->id != SMT_SORT_INT && b->sort->id != SMT_SORT_REAL);
   assert(a->sort->get_data_width() == b->sort->get_data_width());
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_BVSHL);
+  smtlib_smt_ast *ast = new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_BVSHL);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1126,7 +1319,8 @@ smt_astt smtlib_convt::mk_bvashr(smt_astt a, smt_astt b)
   assert(a->sort->id != SMT_SORT_INT && a->sort->id != SMT_SORT_REAL);
   assert(b->sort->id != SMT_SORT_INT && b->sort->id != SMT_SORT_REAL);
   assert(a->sort->get_data_width() == b->sort->get_data_width());
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_BVASHR);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_BVASHR);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1137,7 +1331,8 @@ smt_astt smtlib_convt::mk_bvlshr(smt_astt a, smt_astt b)
   assert(a->sort->id != SMT_SORT_INT && a->sort->id != SMT_SORT_REAL);
   assert(b->sort->id != SMT_SORT_INT && b->sort->id != SMT_SORT_REAL);
   assert(a->sort->get_data_width() == b->sort->get_data_width());
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_BVLSHR);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_BVLSHR);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1146,7 +1341,7 @@ smt_astt smtlib_convt::mk_bvlshr(smt_astt a, smt_astt b)
 smt_astt smtlib_convt::mk_neg(smt_astt a)
 {
   assert(a->sort->id == SMT_SORT_INT || a->sort->id == SMT_SORT_REAL);
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_NEG);
+  smtlib_smt_ast *ast = new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_NEG);
   ast->args.push_back(a);
   return ast;
 }
@@ -1154,7 +1349,7 @@ smt_astt smtlib_convt::mk_neg(smt_astt a)
 smt_astt smtlib_convt::mk_bvneg(smt_astt a)
 {
   assert(a->sort->id != SMT_SORT_INT && a->sort->id != SMT_SORT_REAL);
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_BVNEG);
+  smtlib_smt_ast *ast = new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_BVNEG);
   ast->args.push_back(a);
   return ast;
 }
@@ -1162,7 +1357,7 @@ smt_astt smtlib_convt::mk_bvneg(smt_astt a)
 smt_astt smtlib_convt::mk_bvnot(smt_astt a)
 {
   assert(a->sort->id != SMT_SORT_INT && a->sort->id != SMT_SORT_REAL);
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_BVNOT);
+  smtlib_smt_ast *ast = new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_BVNOT);
   ast->args.push_back(a);
   return ast;
 }
@@ -1172,7 +1367,8 @@ smt_astt smtlib_convt::mk_bvnxor(smt_astt a, smt_astt b)
   assert(a->sort->id != SMT_SORT_INT && a->sort->id != SMT_SORT_REAL);
   assert(b->sort->id != SMT_SORT_INT && b->sort->id != SMT_SORT_REAL);
   assert(a->sort->get_data_width() == b->sort->get_data_width());
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_BVNXOR);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_BVNXOR);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1183,7 +1379,7 @@ smt_astt smtlib_convt::mk_bvnor(smt_astt a, smt_astt b)
   assert(a->sort->id != SMT_SORT_INT && a->sort->id != SMT_SORT_REAL);
   assert(b->sort->id != SMT_SORT_INT && b->sort->id != SMT_SORT_REAL);
   assert(a->sort->get_data_width() == b->sort->get_data_width());
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_BVNOR);
+  smtlib_smt_ast *ast = new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_BVNOR);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1194,7 +1390,8 @@ smt_astt smtlib_convt::mk_bvnand(smt_astt a, smt_astt b)
   assert(a->sort->id != SMT_SORT_INT && a->sort->id != SMT_SORT_REAL);
   assert(b->sort->id != SMT_SORT_INT && b->sort->id != SMT_SORT_REAL);
   assert(a->sort->get_data_width() == b->sort->get_data_width());
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_BVNAND);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_BVNAND);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1205,7 +1402,7 @@ smt_astt smtlib_convt::mk_bvxor(smt_astt a, smt_astt b)
   assert(a->sort->id != SMT_SORT_INT && a->sort->id != SMT_SORT_REAL);
   assert(b->sort->id != SMT_SORT_INT && b->sort->id != SMT_SORT_REAL);
   assert(a->sort->get_data_width() == b->sort->get_data_width());
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_BVXOR);
+  smtlib_smt_ast *ast = new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_BVXOR);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1216,7 +1413,7 @@ smt_astt smtlib_convt::mk_bvor(smt_astt a, smt_astt b)
   assert(a->sort->id != SMT_SORT_INT && a->sort->id != SMT_SORT_REAL);
   assert(b->sort->id != SMT_SORT_INT && b->sort->id != SMT_SORT_REAL);
   assert(a->sort->get_data_width() == b->sort->get_data_width());
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_BVOR);
+  smtlib_smt_ast *ast = new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_BVOR);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1227,7 +1424,7 @@ smt_astt smtlib_convt::mk_bvand(smt_astt a, smt_astt b)
   assert(a->sort->id != SMT_SORT_INT && a->sort->id != SMT_SORT_REAL);
   assert(b->sort->id != SMT_SORT_INT && b->sort->id != SMT_SORT_REAL);
   assert(a->sort->get_data_width() == b->sort->get_data_width());
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_BVAND);
+  smtlib_smt_ast *ast = new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_BVAND);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1237,7 +1434,7 @@ smt_astt smtlib_convt::mk_implies(smt_astt a, smt_astt b)
 {
   assert(a->sort->id == SMT_SORT_BOOL && b->sort->id == SMT_SORT_BOOL);
   smtlib_smt_ast *ast =
-    new smtlib_smt_ast(this, boolean_sort, SMT_FUNC_IMPLIES);
+    new(this) smtlib_smt_ast(this, boolean_sort, SMT_FUNC_IMPLIES);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1246,7 +1443,8 @@ smt_astt smtlib_convt::mk_implies(smt_astt a, smt_astt b)
 smt_astt smtlib_convt::mk_xor(smt_astt a, smt_astt b)
 {
   assert(a->sort->id == SMT_SORT_BOOL && b->sort->id == SMT_SORT_BOOL);
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, boolean_sort, SMT_FUNC_XOR);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, boolean_sort, SMT_FUNC_XOR);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1255,7 +1453,8 @@ smt_astt smtlib_convt::mk_xor(smt_astt a, smt_astt b)
 smt_astt smtlib_convt::mk_or(smt_astt a, smt_astt b)
 {
   assert(a->sort->id == SMT_SORT_BOOL && b->sort->id == SMT_SORT_BOOL);
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, boolean_sort, SMT_FUNC_OR);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, boolean_sort, SMT_FUNC_OR);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1264,7 +1463,8 @@ smt_astt smtlib_convt::mk_or(smt_astt a, smt_astt b)
 smt_astt smtlib_convt::mk_and(smt_astt a, smt_astt b)
 {
   assert(a->sort->id == SMT_SORT_BOOL && b->sort->id == SMT_SORT_BOOL);
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, boolean_sort, SMT_FUNC_AND);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, boolean_sort, SMT_FUNC_AND);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1273,7 +1473,8 @@ smt_astt smtlib_convt::mk_and(smt_astt a, smt_astt b)
 smt_astt smtlib_convt::mk_not(smt_astt a)
 {
   assert(a->sort->id == SMT_SORT_BOOL);
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, boolean_sort, SMT_FUNC_NOT);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, boolean_sort, SMT_FUNC_NOT);
   ast->args.push_back(a);
   return ast;
 }
@@ -1282,7 +1483,8 @@ smt_astt smtlib_convt::mk_lt(smt_astt a, smt_astt b)
 {
   assert(a->sort->id == SMT_SORT_INT || a->sort->id == SMT_SORT_REAL);
   assert(b->sort->id == SMT_SORT_INT || b->sort->id == SMT_SORT_REAL);
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, boolean_sort, SMT_FUNC_LT);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, boolean_sort, SMT_FUNC_LT);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1293,7 +1495,8 @@ smt_astt smtlib_convt::mk_bvult(smt_astt a, smt_astt b)
   assert(a->sort->id != SMT_SORT_INT && a->sort->id != SMT_SORT_REAL);
   assert(b->sort->id != SMT_SORT_INT && b->sort->id != SMT_SORT_REAL);
   assert(a->sort->get_data_width() == b->sort->get_data_width());
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, boolean_sort, SMT_FUNC_BVULT);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, boolean_sort, SMT_FUNC_BVULT);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1304,7 +1507,8 @@ smt_astt smtlib_convt::mk_bvslt(smt_astt a, smt_astt b)
   assert(a->sort->id != SMT_SORT_INT && a->sort->id != SMT_SORT_REAL);
   assert(b->sort->id != SMT_SORT_INT && b->sort->id != SMT_SORT_REAL);
   assert(a->sort->get_data_width() == b->sort->get_data_width());
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, boolean_sort, SMT_FUNC_BVSLT);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, boolean_sort, SMT_FUNC_BVSLT);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1314,7 +1518,8 @@ smt_astt smtlib_convt::mk_gt(smt_astt a, smt_astt b)
 {
   assert(a->sort->id == SMT_SORT_INT || a->sort->id == SMT_SORT_REAL);
   assert(b->sort->id == SMT_SORT_INT || b->sort->id == SMT_SORT_REAL);
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, boolean_sort, SMT_FUNC_GT);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, boolean_sort, SMT_FUNC_GT);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1325,7 +1530,8 @@ smt_astt smtlib_convt::mk_bvugt(smt_astt a, smt_astt b)
   assert(a->sort->id != SMT_SORT_INT && a->sort->id != SMT_SORT_REAL);
   assert(b->sort->id != SMT_SORT_INT && b->sort->id != SMT_SORT_REAL);
   assert(a->sort->get_data_width() == b->sort->get_data_width());
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, boolean_sort, SMT_FUNC_BVUGT);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, boolean_sort, SMT_FUNC_BVUGT);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1336,7 +1542,8 @@ smt_astt smtlib_convt::mk_bvsgt(smt_astt a, smt_astt b)
   assert(a->sort->id != SMT_SORT_INT && a->sort->id != SMT_SORT_REAL);
   assert(b->sort->id != SMT_SORT_INT && b->sort->id != SMT_SORT_REAL);
   assert(a->sort->get_data_width() == b->sort->get_data_width());
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, boolean_sort, SMT_FUNC_BVSGT);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, boolean_sort, SMT_FUNC_BVSGT);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1346,7 +1553,8 @@ smt_astt smtlib_convt::mk_le(smt_astt a, smt_astt b)
 {
   assert(a->sort->id == SMT_SORT_INT || a->sort->id == SMT_SORT_REAL);
   assert(b->sort->id == SMT_SORT_INT || b->sort->id == SMT_SORT_REAL);
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, boolean_sort, SMT_FUNC_LTE);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, boolean_sort, SMT_FUNC_LTE);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1357,7 +1565,8 @@ smt_astt smtlib_convt::mk_bvule(smt_astt a, smt_astt b)
   assert(a->sort->id != SMT_SORT_INT && a->sort->id != SMT_SORT_REAL);
   assert(b->sort->id != SMT_SORT_INT && b->sort->id != SMT_SORT_REAL);
   assert(a->sort->get_data_width() == b->sort->get_data_width());
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, boolean_sort, SMT_FUNC_BVULTE);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, boolean_sort, SMT_FUNC_BVULTE);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1368,7 +1577,8 @@ smt_astt smtlib_convt::mk_bvsle(smt_astt a, smt_astt b)
   assert(a->sort->id != SMT_SORT_INT && a->sort->id != SMT_SORT_REAL);
   assert(b->sort->id != SMT_SORT_INT && b->sort->id != SMT_SORT_REAL);
   assert(a->sort->get_data_width() == b->sort->get_data_width());
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, boolean_sort, SMT_FUNC_BVSLTE);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, boolean_sort, SMT_FUNC_BVSLTE);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1378,7 +1588,8 @@ smt_astt smtlib_convt::mk_ge(smt_astt a, smt_astt b)
 {
   assert(a->sort->id == SMT_SORT_INT || a->sort->id == SMT_SORT_REAL);
   assert(b->sort->id == SMT_SORT_INT || b->sort->id == SMT_SORT_REAL);
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, boolean_sort, SMT_FUNC_GTE);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, boolean_sort, SMT_FUNC_GTE);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1389,7 +1600,8 @@ smt_astt smtlib_convt::mk_bvuge(smt_astt a, smt_astt b)
   assert(a->sort->id != SMT_SORT_INT && a->sort->id != SMT_SORT_REAL);
   assert(b->sort->id != SMT_SORT_INT && b->sort->id != SMT_SORT_REAL);
   assert(a->sort->get_data_width() == b->sort->get_data_width());
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, boolean_sort, SMT_FUNC_BVUGTE);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, boolean_sort, SMT_FUNC_BVUGTE);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1400,7 +1612,8 @@ smt_astt smtlib_convt::mk_bvsge(smt_astt a, smt_astt b)
   assert(a->sort->id != SMT_SORT_INT && a->sort->id != SMT_SORT_REAL);
   assert(b->sort->id != SMT_SORT_INT && b->sort->id != SMT_SORT_REAL);
   assert(a->sort->get_data_width() == b->sort->get_data_width());
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, boolean_sort, SMT_FUNC_BVSGTE);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, boolean_sort, SMT_FUNC_BVSGTE);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1409,7 +1622,8 @@ smt_astt smtlib_convt::mk_bvsge(smt_astt a, smt_astt b)
 smt_astt smtlib_convt::mk_eq(smt_astt a, smt_astt b)
 {
   assert(a->sort->get_data_width() == b->sort->get_data_width());
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, boolean_sort, SMT_FUNC_EQ);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, boolean_sort, SMT_FUNC_EQ);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1421,7 +1635,7 @@ smt_astt smtlib_convt::mk_store(smt_astt a, smt_astt b, smt_astt c)
   assert(a->sort->get_domain_width() == b->sort->get_data_width());
   assert(
     a->sort->get_range_sort()->get_data_width() == c->sort->get_data_width());
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_STORE);
+  smtlib_smt_ast *ast = new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_STORE);
   ast->args.push_back(a);
   ast->args.push_back(b);
   ast->args.push_back(c);
@@ -1433,7 +1647,7 @@ smt_astt smtlib_convt::mk_select(smt_astt a, smt_astt b)
   assert(a->sort->id == SMT_SORT_ARRAY);
   assert(a->sort->get_domain_width() == b->sort->get_data_width());
   smtlib_smt_ast *ast =
-    new smtlib_smt_ast(this, a->sort->get_range_sort(), SMT_FUNC_SELECT);
+    new(this) smtlib_smt_ast(this, a->sort->get_range_sort(), SMT_FUNC_SELECT);
   ast->args.push_back(a);
   ast->args.push_back(b);
   return ast;
@@ -1442,7 +1656,8 @@ smt_astt smtlib_convt::mk_select(smt_astt a, smt_astt b)
 smt_astt smtlib_convt::mk_real2int(smt_astt a)
 {
   assert(a->sort->id == SMT_SORT_REAL);
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_REAL2INT);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_REAL2INT);
   ast->args.push_back(a);
   return ast;
 }
@@ -1450,7 +1665,8 @@ smt_astt smtlib_convt::mk_real2int(smt_astt a)
 smt_astt smtlib_convt::mk_int2real(smt_astt a)
 {
   assert(a->sort->id == SMT_SORT_INT);
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, a->sort, SMT_FUNC_INT2REAL);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, a->sort, SMT_FUNC_INT2REAL);
   ast->args.push_back(a);
   return ast;
 }
@@ -1458,7 +1674,8 @@ smt_astt smtlib_convt::mk_int2real(smt_astt a)
 smt_astt smtlib_convt::mk_isint(smt_astt a)
 {
   assert(a->sort->id == SMT_SORT_INT || a->sort->id == SMT_SORT_REAL);
-  smtlib_smt_ast *ast = new smtlib_smt_ast(this, boolean_sort, SMT_FUNC_IS_INT);
+  smtlib_smt_ast *ast =
+    new(this) smtlib_smt_ast(this, boolean_sort, SMT_FUNC_IS_INT);
   ast->args.push_back(a);
   return ast;
 }
@@ -1471,6 +1688,12 @@ void smtlib_convt::pop_ctx()
   symbol_tablet::nth_index<1>::type &syms_numindex = symbol_table.get<1>();
   syms_numindex.erase(ctx_level);
 
+  // And the definitions made since the push, whose ASTs may be deleted now.
+  for(size_t i = defined_marks.back(); i < defined_order.size(); i++)
+    defined_terms.erase(defined_order[i]);
+  defined_order.resize(defined_marks.back());
+  defined_marks.pop_back();
+
   smt_convt::pop_ctx();
 }
 
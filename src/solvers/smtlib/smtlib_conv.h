@@ -2,8 +2,10 @@
 #define _ESBMC_SOLVERS_SMTLIB_SMTLIB_CONV_H
 
 #include <list>
+#include <memory>
 #include <solvers/smt/smt_conv.h>
 #include <string>
+#include <unordered_map>
 #ifndef _WIN32
 #include <unistd.h>
 #endif
@@ -279,10 +281,21 @@ public:
   unsigned int emit_ast(
     const smtlib_smt_ast *ast,
     std::string &output,
-    std::unordered_map<const smtlib_smt_ast *, std::string> &temp_symbols)
-    const;
+    std::unordered_map<const smtlib_smt_ast *, std::string> &temp_symbols,
+    bool use_definitions) const;
 
-  void emit_ast(const smtlib_smt_ast *ast) const;
+  /** Emit ast as a single term, binding its subterms with let's. Subterms
+   *  that have been given a define-fun already are referred to by name if
+   *  use_definitions is set. */
+  void emit_ast(const smtlib_smt_ast *ast, bool use_definitions = true) const;
+
+  /** Emit a define-fun for every non-terminal subterm of ast that does not
+   *  have one yet and return the term referring to ast. Shared subterms are
+   *  thus sent to the solver once, rather than once per assertion. */
+  std::string define_ast(const smtlib_smt_ast *ast);
+
+  /** Emit the function symbol of ast and its already printed operands */
+  void emit_app(const smtlib_smt_ast *ast, const std::string *args) const;
 
   void push_ctx() override;
   void pop_ctx() override;
@@ -304,6 +317,11 @@ public:
     std::string solver_name;
     std::string solver_version;
 
+    /** Formats the output into chunks, which a separate thread writes to the
+     *  pipe, so that the solver parses while we convert. */
+    class async_writert;
+    std::unique_ptr<async_writert> writer;
+
     explicit process_emitter(const std::string &cmd);
     process_emitter(const process_emitter &) = delete;
 
@@ -358,6 +376,15 @@ public:
 
   symbol_tablet symbol_table;
 
+  /** Text of the terms already emitted: terminals, and the names of the
+   *  define-fun's of non-terminal ASTs. Entries are recorded in
+   *  defined_order, and defined_marks holds its size at each push, so that
+   *  pop_ctx() can forget the definitions the solver pops. */
+  std::unordered_map<const smtlib_smt_ast *, std::string> defined_terms;
+  std::vector<const smtlib_smt_ast *> defined_order;
+  std::vector<size_t> defined_marks;
+  unsigned int defined_num = 0;
+
   static const std::string temp_prefix;
 
   struct external_process_died : std::runtime_error
@@ -16,6 +16,7 @@ solver_creator create_new_cvc_solver;
 solver_creator create_new_mathsat_solver;
 solver_creator create_new_yices_solver;
 solver_creator create_new_bitwuzla_solver;
+solver_creator create_new_sat_solver;
 
 static const std::unordered_map<std::string, solver_creator *> esbmc_solvers = {
   {"smtlib", create_new_smtlib_solver},
@@ -38,7 +39,10 @@ static const std::unordered_map<std::string, solver_creator *> esbmc_solvers = {
   {"yices", create_new_yices_solver},
 #endif
 #ifdef BITWUZLA
-  {"bitwuzla", create_new_bitwuzla_solver}
+  {"bitwuzla", create_new_bitwuzla_solver},
+#endif
+#ifdef SATSOLVER
+  {"sat", create_new_sat_solver}
 #endif
 };
 
@@ -50,7 +54,8 @@ static const std::string all_solvers[] = {
   "cvc",
   "mathsat",
   "yices",
-  "bitwuzla"};
+  "bitwuzla",
+  "sat"};
 
 static std::string pick_default_solver()
 {
@@ -4,7 +4,7 @@
 
 #include <util/algorithms.h>
 #include <util/time_stopping.h>
-#include <util/crypto_hash.h>
+#include <util/fast_hash.h>
 #include <util/cache_defs.h>
 
 /**
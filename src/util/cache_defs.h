@@ -1,4 +1,5 @@
 #pragma once
+#include <boost/functional/hash.hpp>
 #include <irep2/irep2.h>
 
 // This header will prevent the dependency hell
@@ -14,14 +15,12 @@ struct hash<assert_pair>
 {
   auto operator()(const assert_pair &p) const -> size_t
   {
-    const expr2tc &e1 = p.first;
-    const expr2tc &e2 = p.second;
-    crypto_hash h1, h2;
-    e1->hash(h1);
-    h1.fin();
-    e2->hash(h2);
-    h2.fin();
-    return h1.to_size_t() ^ h2.to_size_t();
+    // The digests are cached in the nodes, no need to walk the expressions
+    const fast_hash::digestt &d1 = p.first->digest();
+    const fast_hash::digestt &d2 = p.second->digest();
+    size_t seed = d1[0] ^ d1[1];
+    boost::hash_combine(seed, d2[0] ^ d2[1]);
+    return seed;
   }
 };
 } // namespace std
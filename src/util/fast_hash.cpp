@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <util/fast_hash.h>
+
+namespace
+{
+const uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+const uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+const uint64_t prime3 = 0x165667B19E3779F9ULL;
+const uint64_t prime4 = 0x85EBCA77C2B2AE63ULL;
+const uint64_t prime5 = 0x27D4EB2F165667C5ULL;
+
+inline uint64_t rotl(uint64_t x, int r)
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t round(uint64_t acc, uint64_t input)
+{
+  acc += input * prime2;
+  acc = rotl(acc, 31);
+  return acc * prime1;
+}
+
+inline uint64_t avalanche(uint64_t h)
+{
+  h ^= h >> 33;
+  h *= prime2;
+  h ^= h >> 29;
+  h *= prime3;
+  h ^= h >> 32;
+  return h;
+}
+} // namespace
+
+fast_hash::fast_hash()
+  : hash{0, 0}, acc{prime1 + prime2, prime2}, total(0), buffered(0)
+{
+}
+
+void fast_hash::stripe(const unsigned char *data)
+{
+  uint64_t a, b;
+  memcpy(&a, data, sizeof(a));
+  memcpy(&b, data + sizeof(a), sizeof(b));
+  acc[0] = round(acc[0], a);
+  acc[1] = round(acc[1], b);
+}
+
+void fast_hash::ingest(void const *data, unsigned int size)
+{
+  const unsigned char *p = static_cast<const unsigned char *>(data);
+  total += size;
+
+  // Top up a partially filled stripe first
+  if(buffered != 0)
+  {
+    unsigned int n = std::min(size, (unsigned int)sizeof(buffer) - buffered);
+    memcpy(buffer + buffered, p, n);
+    buffered += n;
+    p += n;
+    size -= n;
+    if(buffered < sizeof(buffer))
+      return;
+    stripe(buffer);
+    buffered = 0;
+  }
+
+  for(; size >= sizeof(buffer); p += sizeof(buffer), size -= sizeof(buffer))
+    stripe(p);
+
+  memcpy(buffer, p, size);
+  buffered = size;
+}
+
+void fast_hash::fin()
+{
+  // Zero-pad the tail; the total length below tells paddings apart
+  if(buffered != 0)
+  {
+    memset(buffer + buffered, 0, sizeof(buffer) - buffered);
+    stripe(buffer);
+    buffered = 0;
+  }
+
+  uint64_t lo = acc[0] + rotl(acc[1], 17) + total * prime3;
+  uint64_t hi = acc[1] ^ rotl(acc[0], 41) ^ (total * prime4 + prime5);
+  hash[0] = avalanche(lo);
+  hash[1] = avalanche(hi + hash[0]);
+}
+
+std::string fast_hash::to_string() const
+{
+  std::ostringstream buf;
+  for(uint64_t i : hash)
+    buf << std::hex << std::setfill('0') << std::setw(16) << i;
+
+  return buf.str();
+}
@@ -0,0 +1,63 @@
+#ifndef CPROVER_UTIL_FAST_HASH_H
+#define CPROVER_UTIL_FAST_HASH_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/** Incremental 128-bit non-cryptographic hash.
+ *  A streaming multiply-rotate hash over 16 byte stripes in the style of
+ *  xxHash, with two independent 64-bit lanes combined on fin(). Unlike
+ *  crypto_hash it keeps its whole state inline and needs no allocation, which
+ *  makes it suitable for hashing irep2 nodes and execution states on every
+ *  step. It is no defence against adversarial collisions.
+ */
+class fast_hash
+{
+public:
+  typedef std::array<uint64_t, 2> digestt;
+
+  /** The digest, valid once fin() has been called. */
+  digestt hash;
+
+  fast_hash();
+  void ingest(void const *data, unsigned int size);
+  void fin();
+
+  bool operator<(const fast_hash &h2) const
+  {
+    return hash < h2.hash;
+  }
+
+  bool operator==(const fast_hash &h2) const
+  {
+    return hash == h2.hash;
+  }
+
+  size_t to_size_t() const
+  {
+    return hash[0] ^ hash[1];
+  }
+
+  std::string to_string() const;
+
+  /** Hasher for digests in unordered containers. */
+  struct digest_hash
+  {
+    size_t operator()(const digestt &d) const
+    {
+      return d[0] ^ d[1];
+    }
+  };
+
+private:
+  uint64_t acc[2];
+  uint64_t total;
+  unsigned char buffer[16];
+  unsigned int buffered;
+
+  void stripe(const unsigned char *data);
+};
+
+#endif
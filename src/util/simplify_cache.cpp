@@ -0,0 +1,65 @@
+#include <util/message.h>
+#include <util/simplify_cache.h>
+
+bool simplify_cachet::enabled = false;
+size_t simplify_cachet::generation_size = 1 << 16;
+
+simplify_cachet &simplify_cachet::get()
+{
+  static thread_local simplify_cachet cache;
+  return cache;
+}
+
+bool simplify_cachet::lookup(const expr2tc &expr, expr2tc &res)
+{
+  auto it = young.find(expr);
+  if(it != young.end())
+  {
+    ++hits;
+    res = it->second;
+    return true;
+  }
+
+  it = old.find(expr);
+  if(it == old.end())
+  {
+    ++misses;
+    return false;
+  }
+
+  ++hits;
+  res = it->second;
+  // Copy the key, a new generation may free the old table
+  expr2tc key = it->first;
+  insert(key, res);
+  return true;
+}
+
+void simplify_cachet::insert(const expr2tc &expr, const expr2tc &res)
+{
+  if(young.size() >= generation_size)
+  {
+    // Start a new generation, the entries of the old one are evicted
+    old = std::move(young);
+    young.clear();
+  }
+
+  young.emplace(expr, res);
+}
+
+void simplify_cachet::clear()
+{
+  young.clear();
+  old.clear();
+}
+
+void simplify_cachet::print_stats() const
+{
+  size_t total = hits + misses;
+  log_status(
+    "Simplification cache: {} entries, {} hits out of {} lookups ({:.1f}%)",
+    young.size() + old.size(),
+    hits,
+    total,
+    total ? (100.0 * hits) / total : 0.0);
+}
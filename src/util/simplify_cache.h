@@ -0,0 +1,45 @@
+#ifndef CPROVER_UTIL_SIMPLIFY_CACHE_H
+#define CPROVER_UTIL_SIMPLIFY_CACHE_H
+
+#include <irep2/irep2.h>
+#include <unordered_map>
+
+/** Bounded memo table for expr2t::simplify().
+ *  Maps an expression, hashed by its crc and compared structurally, to the
+ *  result of simplifying it (nil if it could not be simplified). Entries are
+ *  kept in two generations: once the young one is full it replaces the old
+ *  one, evicting whatever the old one held. Entries found in the old
+ *  generation are promoted back to the young one.
+ *
+ *  There is one table per thread, so that symex and the solver threads of
+ *  --parallel-solving never contend for it.
+ */
+class simplify_cachet
+{
+public:
+  /** Whether expr2t::simplify() consults the cache at all. */
+  static bool enabled;
+  static size_t generation_size;
+
+  /** Fetch the table of the calling thread. */
+  static simplify_cachet &get();
+
+  /** Look up the simplification of expr.
+   *  @return True and set res if the expression is cached. */
+  bool lookup(const expr2tc &expr, expr2tc &res);
+  void insert(const expr2tc &expr, const expr2tc &res);
+  void clear();
+
+  /** Log the number of entries and the hit rate of the calling thread. */
+  void print_stats() const;
+
+  size_t hits = 0;
+  size_t misses = 0;
+
+protected:
+  typedef std::unordered_map<expr2tc, expr2tc, irep2_hash> tablet;
+  tablet young;
+  tablet old;
+};
+
+#endif
@@ -4,6 +4,7 @@
 #include <util/base_type.h>
 #include <util/c_types.h>
 #include <util/expr_util.h>
+#include <util/simplify_cache.h>
 #include <irep2/irep2.h>
 #include <irep2/irep2_utils.h>
 #include <util/type_byte_size.h>
@@ -13,23 +14,12 @@ expr2tc expr2t::do_simplify() const
   return expr2tc();
 }
 
-expr2tc expr2t::simplify() const
+static expr2tc simplify_uncached(const expr2t &expr)
 {
   try
   {
-    // Corner case! Don't even try to simplify address of's operands, might end up
-    // taking the address of some /completely/ arbitary pice of data, by
-    // simplifiying an index to its data, discarding the symbol.
-    if(expr_id == address_of_id) // unlikely
-      return expr2tc();
-
-    // And overflows too. We don't wish an add to distribute itself, for example,
-    // when we're trying to work out whether or not it's going to overflow.
-    if(expr_id == overflow_id)
-      return expr2tc();
-
     // Try initial simplification
-    expr2tc res = do_simplify();
+    expr2tc res = expr.do_simplify();
     if(!is_nil_expr(res))
     {
       // Woot, we simplified some of this. It may have _additional_ fields that
@@ -48,9 +38,9 @@ expr2tc expr2t::simplify() const
     bool changed = false;
     std::list<expr2tc> newoperands;
 
-    for(unsigned int idx = 0; idx < get_num_sub_exprs(); idx++)
+    for(unsigned int idx = 0; idx < expr.get_num_sub_exprs(); idx++)
     {
-      const expr2tc *e = get_sub_expr(idx);
+      const expr2tc *e = expr.get_sub_expr(idx);
       expr2tc tmp;
 
       if(!is_nil_expr(*e))
@@ -68,10 +58,10 @@ expr2tc expr2t::simplify() const
       // holding something back until it's certain all its operands are
       // simplified. It's responsible for simplifying further if it's made that
       // call though.
-      return do_simplify();
+      return expr.do_simplify();
 
     // An operand has been changed; clone ourselves and update.
-    expr2tc new_us = clone();
+    expr2tc new_us = expr.clone();
     std::list<expr2tc>::iterator it2 = newoperands.begin();
     new_us->Foreach_operand([&it2](expr2tc &e) {
       if(!*it2)
@@ -98,6 +88,41 @@ expr2tc expr2t::simplify() const
   }
 }
 
+expr2tc expr2t::simplify() const
+{
+  // Corner case! Don't even try to simplify address of's operands, might end up
+  // taking the address of some /completely/ arbitary pice of data, by
+  // simplifiying an index to its data, discarding the symbol.
+  if(expr_id == address_of_id) // unlikely
+    return expr2tc();
+
+  // And overflows too. We don't wish an add to distribute itself, for example,
+  // when we're trying to work out whether or not it's going to overflow.
+  if(expr_id == overflow_id)
+    return expr2tc();
+
+  if(!simplify_cachet::enabled)
+    return simplify_uncached(*this);
+
+  // Only exprs owned by a container can be cached; the cache just keeps a
+  // reference and never modifies them.
+  std::shared_ptr<const irep2t> owner = weak_from_this().lock();
+  if(!owner)
+    return simplify_uncached(*this);
+
+  expr2tc self(std::static_pointer_cast<expr2t>(
+    std::const_pointer_cast<irep2t>(std::move(owner))));
+
+  simplify_cachet &cache = simplify_cachet::get();
+  expr2tc res;
+  if(cache.lookup(self, res))
+    return res;
+
+  res = simplify_uncached(*this);
+  cache.insert(self, res);
+  return res;
+}
+
 static expr2tc try_simplification(const expr2tc &expr)
 {
   expr2tc to_simplify = expr->do_simplify();
@@ -260,6 +285,77 @@ expr2tc attempt_associative_simplify(
   return expr2tc();
 }
 
+/* Truncate the two's complement bit pattern `bits` to the width of the integer
+ * type `type`, at most 64 bits wide, and sign-extend it for signed types. */
+static BigInt wrap_native_bv(const type2tc &type, uint64_t bits)
+{
+  unsigned int width = type->get_width();
+  assert(width > 0 && width <= 64);
+
+  uint64_t trunc_mask = 0;
+  if(width < 64)
+  {
+    trunc_mask = ~(uint64_t)0 << width;
+    bits &= ~trunc_mask;
+  }
+
+  if(is_signedbv_type(type))
+  {
+    // if the sign-bit is set, sign-extend it
+    if(bits >> (width - 1))
+      bits |= trunc_mask;
+    return BigInt((int64_t)bits);
+  }
+
+  return BigInt(bits);
+}
+
+/* Fold +, - and * over two integer constants of at most 64 bits on uint64_t.
+ * Wrap-around arithmetic modulo 2^64 agrees with BigInt arithmetic followed by
+ * truncation to the operand width, so no BigInt temporaries are needed for
+ * machine-sized constants. Returns nil when the fast path does not apply. */
+template <typename constructor>
+static expr2tc simplify_arith_2ops_native(
+  const expr2tc &side_1,
+  const expr2tc &side_2)
+{
+  constexpr bool is_add = std::is_same_v<constructor, add2t>;
+  constexpr bool is_sub = std::is_same_v<constructor, sub2t>;
+  constexpr bool is_mul = std::is_same_v<constructor, mul2t>;
+
+  if constexpr(!is_add && !is_sub && !is_mul)
+    return expr2tc();
+  else
+  {
+    if(!is_constant_int2t(side_1) || !is_constant_int2t(side_2))
+      return expr2tc();
+
+    // The result takes the type of the first operand, as in the BigInt path
+    const type2tc &type = side_1->type;
+    if(!is_bv_type(type) || type->get_width() > 64)
+      return expr2tc();
+
+    const BigInt &bl = to_constant_int2t(side_1).value;
+    const BigInt &br = to_constant_int2t(side_2).value;
+    if(!bl.is_uint64() || !br.is_uint64())
+      return expr2tc();
+
+    /* the bit patterns in two's complement, including the sign */
+    uint64_t l = bl.to_int64();
+    uint64_t r = br.to_int64();
+
+    uint64_t res;
+    if constexpr(is_add)
+      res = l + r;
+    else if constexpr(is_sub)
+      res = l - r;
+    else
+      res = l * r;
+
+    return constant_int2tc(type, wrap_native_bv(type, res));
+  }
+}
+
 template <template <typename> class TFunctor, typename constructor>
 static expr2tc simplify_arith_2ops(
   const type2tc &type,
@@ -305,6 +401,11 @@ static expr2tc simplify_arith_2ops(
   }
   else if(is_bv_type(simplied_side_1) || is_bv_type(simplied_side_2))
   {
+    simpl_res =
+      simplify_arith_2ops_native<constructor>(simplied_side_1, simplied_side_2);
+    if(!is_nil_expr(simpl_res))
+      return typecast_check_return(type, simpl_res);
+
     std::function<bool(const expr2tc &)> is_constant =
       (bool (*)(const expr2tc &)) & is_constant_int2t;
 
@@ -317,11 +418,19 @@ static expr2tc simplify_arith_2ops(
 
     // Fix rounding when an overflow occurs
     if(!is_nil_expr(simpl_res) && is_constant_int2t(simpl_res))
-      migrate_expr(
-        from_integer(
-          to_constant_int2t(simpl_res).value,
-          migrate_type_back(simpl_res->type)),
-        simpl_res);
+    {
+      const type2tc &res_type = simpl_res->type;
+      const BigInt &v = to_constant_int2t(simpl_res).value;
+      if(is_bv_type(res_type) && res_type->get_width() <= 64 && v.is_uint64())
+        simpl_res =
+          constant_int2tc(res_type, wrap_native_bv(res_type, v.to_int64()));
+      else
+        migrate_expr(
+          from_integer(
+            to_constant_int2t(simpl_res).value,
+            migrate_type_back(simpl_res->type)),
+          simpl_res);
+    }
   }
   else if(is_fixedbv_type(simplied_side_1) || is_fixedbv_type(simplied_side_2))
   {
@@ -1129,15 +1238,26 @@ static expr2tc simplify_logic_2ops(
 
   if(is_bv_type(simplied_side_1) || is_bv_type(simplied_side_2))
   {
+    /* Only the truth value of an integer constant matters to a logic op, test
+     * it in place and fold on bool instead of copying the BigInt around. */
+    auto truth_value = [](const expr2tc &e) -> expr2tc {
+      if(!is_constant_int2t(e))
+        return e;
+      return constant_bool2tc(!to_constant_int2t(e).value.is_zero());
+    };
+
     std::function<bool(const expr2tc &)> is_constant =
-      (bool (*)(const expr2tc &)) & is_constant_int2t;
+      (bool (*)(const expr2tc &)) & is_constant_bool2t;
 
-    std::function<BigInt &(expr2tc &)> get_value = [](expr2tc &c) -> BigInt & {
-      return to_constant_int2t(c).value;
+    std::function<bool &(expr2tc &)> get_value = [](expr2tc &c) -> bool & {
+      return to_constant_bool2t(c).value;
     };
 
-    simpl_res = TFunctor<BigInt>::simplify(
-      simplied_side_1, simplied_side_2, is_constant, get_value);
+    simpl_res = TFunctor<bool>::simplify(
+      truth_value(simplied_side_1),
+      truth_value(simplied_side_2),
+      is_constant,
+      get_value);
   }
   else if(is_fixedbv_type(simplied_side_1) || is_fixedbv_type(simplied_side_2))
   {
@@ -1407,27 +1527,7 @@ static expr2tc do_bit_munge_operation(
     if(can_eval)
     {
       uint64_t res = opfunc(l, r);
-
-      uint64_t trunc_mask = 0;
-      if(type->get_width() < 64)
-      {
-        // truncate the result to the type's width
-        trunc_mask = ~(uint64_t)0 << type->get_width();
-        res &= ~trunc_mask;
-      }
-
-      BigInt z;
-      if(is_signedbv_type(type))
-      {
-        // if res's sign-bit is set, sign-extend it
-        if(res >> (type->get_width() - 1))
-          res |= trunc_mask;
-        z = BigInt((int64_t)res);
-      }
-      else
-        z = BigInt((uint64_t)res);
-
-      return constant_int2tc(type, z);
+      return constant_int2tc(type, wrap_native_bv(type, res));
     }
   }
 
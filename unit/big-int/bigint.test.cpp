@@ -85,6 +85,69 @@ SCENARIO("bigint basic usage", "[bigint]")
   }
 }
 
+SCENARIO("bigint values move between inline and heap storage", "[bigint]")
+{
+  GIVEN("A 128-bit value and a value that spills to the heap")
+  {
+    BigInt small;
+    small.setPower2(127);
+    BigInt large;
+    large.setPower2(200);
+
+    WHEN("They are copied")
+    {
+      BigInt a(small), b(large);
+      REQUIRE(a == small);
+      REQUIRE(b == large);
+      a = large;
+      b = small;
+      REQUIRE(a == large);
+      REQUIRE(b == small);
+    }
+    WHEN("They are swapped")
+    {
+      BigInt a(small), b(large);
+      a.swap(b);
+      REQUIRE(a == large);
+      REQUIRE(b == small);
+      a.swap(b);
+      REQUIRE(a == small);
+      REQUIRE(b == large);
+    }
+    WHEN("They are moved")
+    {
+      BigInt a(small), b(large);
+      BigInt c(std::move(a)), d(std::move(b));
+      REQUIRE(c == small);
+      REQUIRE(d == large);
+      c = std::move(d);
+      REQUIRE(c == large);
+    }
+    WHEN("An inline value grows past 128 bits")
+    {
+      BigInt a(small);
+      a *= small;
+      BigInt expected;
+      expected.setPower2(254);
+      REQUIRE(a == expected);
+      a /= small;
+      REQUIRE(a == small);
+    }
+    WHEN("Two 64-bit values are multiplied")
+    {
+      // (2^64 - 1)^2 = 2^128 - 2^65 + 1
+      BigInt a(BigInt::ullong_t(0xffffffffffffffffULL));
+      a *= a;
+      BigInt expected, carry;
+      expected.setPower2(128);
+      carry.setPower2(65);
+      expected -= carry;
+      expected += 1;
+      REQUIRE(a == expected);
+    }
+  }
+}
+
 SCENARIO("bigint comparations", "[bigint]")
 {
   GIVEN("Two bigints with int64 values")
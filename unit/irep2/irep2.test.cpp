@@ -54,6 +54,8 @@ void test_constructed_equally(const expr2tc e1, const expr2tc e2)
   c_hash2.fin();
   REQUIRE(to_array(c_hash) == to_array(c_hash2));
   REQUIRE(c_hash.to_size_t() == c_hash2.to_size_t());
+  // "Their digest should be the same"
+  REQUIRE(e1->digest() == e2->digest());
 }
 
 void test_constructed_differently(const expr2tc e1, const expr2tc e2)
@@ -74,6 +76,8 @@ void test_constructed_differently(const expr2tc e1, const expr2tc e2)
   c_hash2.fin();
   REQUIRE(to_array(c_hash) != to_array(c_hash2));
   REQUIRE(c_hash.to_size_t() != c_hash2.to_size_t());
+  // "Their digest should not be the same"
+  REQUIRE(e1->digest() != e2->digest());
 }
 
 } // namespace
@@ -114,4 +118,67 @@ SCENARIO("irep2 hashing", "[core][irep2]")
         test_constructed_differently(e.first, e.second);
     }
   }
+  GIVEN("An expression whose digest has been computed")
+  {
+    expr2tc a = add2tc(gen_ulong(0)->type, gen_ulong(1), gen_ulong(2));
+    const fast_hash::digestt before = a->digest();
+
+    THEN("Modifying it recomputes the digest")
+    {
+      to_add2t(a).side_2 = gen_ulong(3);
+      REQUIRE(a->digest() != before);
+      REQUIRE(
+        a->digest() ==
+        add2tc(gen_ulong(0)->type, gen_ulong(1), gen_ulong(3))->digest());
+    }
+    THEN("Operators with the same operands differ")
+    {
+      expr2tc b = sub2tc(gen_ulong(0)->type, gen_ulong(1), gen_ulong(2));
+      REQUIRE(b->digest() != before);
+    }
+  }
+}
+
+SCENARIO("irep2 hash-consing", "[core][irep2]")
+{
+  GIVEN("Hash-consing is enabled")
+  {
+    irep2_hash_cons::enable();
+
+    THEN("Structurally equal expressions share one node")
+    {
+      // Non-const accesses would detach, compare through const containers
+      const expr2tc a = add2tc(gen_ulong(0)->type, gen_ulong(1), gen_ulong(2));
+      const expr2tc b = add2tc(gen_ulong(0)->type, gen_ulong(1), gen_ulong(2));
+      REQUIRE(a.get() == b.get());
+      REQUIRE(a->interned);
+      REQUIRE(to_add2t(a).side_1.get() == to_add2t(b).side_1.get());
+      test_constructed_equally(a, b);
+    }
+    THEN("Different expressions are distinct nodes")
+    {
+      const expr2tc a = gen_testing_struct(1, 2);
+      const expr2tc b = gen_testing_struct(1, 1);
+      REQUIRE(a.get() != b.get());
+      test_constructed_differently(a, b);
+    }
+    THEN("Modifying a shared node detaches it")
+    {
+      expr2tc a = add2tc(gen_ulong(0)->type, gen_ulong(1), gen_ulong(2));
+      expr2tc b = a;
+      to_add2t(b).side_2 = gen_ulong(3);
+      REQUIRE(!b->interned);
+      REQUIRE(a == add2tc(gen_ulong(0)->type, gen_ulong(1), gen_ulong(2)));
+      REQUIRE(b == add2tc(gen_ulong(0)->type, gen_ulong(1), gen_ulong(3)));
+    }
+    THEN("Unreferenced nodes are collected")
+    {
+      {
+        expr2tc a = gen_ulong(0xdead);
+      }
+      REQUIRE(irep2_hash_cons::collect() > 0);
+    }
+
+    irep2_hash_cons::disable();
+  }
 }
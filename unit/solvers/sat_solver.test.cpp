@@ -0,0 +1,181 @@
+#define CATCH_CONFIG_MAIN // This tells Catch to provide a main() - only do this in one cpp file
+#include <catch2/catch.hpp>
+#include <random>
+#include <solvers/sat/sat_solver.h>
+
+namespace
+{
+typedef std::vector<bvt> cnft;
+
+literalt lit(unsigned v, bool negated = false)
+{
+  return literalt(v, negated);
+}
+
+bool satisfies(const cnft &cnf, unsigned long assignment)
+{
+  for(const bvt &c : cnf)
+  {
+    bool sat = false;
+    for(const literalt &l : c)
+      sat |= bool((assignment >> l.var_no()) & 1) != l.sign();
+    if(!sat)
+      return false;
+  }
+  return true;
+}
+
+bool brute_force(const cnft &cnf, unsigned vars)
+{
+  for(unsigned long a = 0; a < (1UL << vars); a++)
+    if(satisfies(cnf, a))
+      return true;
+  return false;
+}
+
+bool model_satisfies(const sat_solvert &solver, const cnft &cnf)
+{
+  unsigned long a = 0;
+  for(unsigned v = 0; v < solver.no_variables(); v++)
+    if(solver.l_get(lit(v)).is_true())
+      a |= 1UL << v;
+  return satisfies(cnf, a);
+}
+
+cnft random_cnf(std::mt19937 &rng, unsigned vars, unsigned clauses)
+{
+  std::uniform_int_distribution<unsigned> var(0, vars - 1), len(2, 4);
+  cnft cnf(clauses);
+  for(bvt &c : cnf)
+    for(unsigned n = len(rng); c.size() < n;)
+      c.push_back(lit(var(rng), rng() & 1));
+  return cnf;
+}
+
+// n + 1 pigeons into n holes
+cnft pigeonhole(unsigned n)
+{
+  auto p = [n](unsigned pigeon, unsigned hole) { return pigeon * n + hole; };
+  cnft cnf;
+  for(unsigned i = 0; i <= n; i++)
+  {
+    bvt c;
+    for(unsigned h = 0; h < n; h++)
+      c.push_back(lit(p(i, h)));
+    cnf.push_back(c);
+  }
+  for(unsigned h = 0; h < n; h++)
+    for(unsigned i = 0; i <= n; i++)
+      for(unsigned j = i + 1; j <= n; j++)
+        cnf.push_back({lit(p(i, h), true), lit(p(j, h), true)});
+  return cnf;
+}
+} // namespace
+
+TEST_CASE("sat solver decisions", "[unit][solvers][sat]")
+{
+  SECTION("a satisfiable formula has a model")
+  {
+    sat_solvert solver;
+    unsigned a = solver.new_variable(), b = solver.new_variable();
+    cnft cnf = {{lit(a), lit(b)}, {lit(a, true), lit(b)}, {lit(b, true), lit(a)}};
+    for(const bvt &c : cnf)
+      solver.add_clause(c);
+    REQUIRE(solver.solve({}));
+    REQUIRE(solver.l_get(lit(a)).is_true());
+    REQUIRE(solver.l_get(lit(b)).is_true());
+    REQUIRE(solver.l_get(lit(b, true)).is_false());
+  }
+
+  SECTION("pigeonhole formulas are unsatisfiable")
+  {
+    for(unsigned n = 2; n <= 6; n++)
+    {
+      sat_solvert solver;
+      while(solver.no_variables() < n * (n + 1))
+        solver.new_variable();
+      for(const bvt &c : pigeonhole(n))
+        solver.add_clause(c);
+      REQUIRE(!solver.solve({}));
+    }
+  }
+
+  SECTION("random formulas agree with brute force")
+  {
+    std::mt19937 rng(1);
+    const unsigned vars = 12;
+    for(unsigned round = 0; round < 200; round++)
+    {
+      // Above 100 clauses so that preprocessing kicks in
+      cnft cnf = random_cnf(rng, vars, 60 + round % 100);
+      sat_solvert solver;
+      while(solver.no_variables() < vars)
+        solver.new_variable();
+      for(const bvt &c : cnf)
+        solver.add_clause(c);
+
+      bool sat = solver.solve({});
+      REQUIRE(sat == brute_force(cnf, vars));
+      if(sat)
+        REQUIRE(model_satisfies(solver, cnf));
+    }
+  }
+}
+
+TEST_CASE("incremental sat solving", "[unit][solvers][sat]")
+{
+  std::mt19937 rng(2);
+  const unsigned vars = 10;
+
+  SECTION("assumptions only hold for one call")
+  {
+    sat_solvert solver;
+    unsigned a = solver.new_variable(), b = solver.new_variable();
+    solver.add_clause({lit(a), lit(b)});
+    REQUIRE(!solver.solve({lit(a, true), lit(b, true)}));
+    REQUIRE(solver.solve({lit(a, true)}));
+    REQUIRE(solver.l_get(lit(b)).is_true());
+    REQUIRE(solver.solve({}));
+  }
+
+  SECTION("clauses can be added between calls")
+  {
+    for(unsigned round = 0; round < 50; round++)
+    {
+      sat_solvert solver;
+      while(solver.no_variables() < vars)
+        solver.new_variable();
+
+      cnft cnf;
+      for(unsigned step = 0; step < 8; step++)
+      {
+        cnft more = random_cnf(rng, vars, 6);
+        for(const bvt &c : more)
+        {
+          solver.add_clause(c);
+          cnf.push_back(c);
+        }
+
+        // Guard a batch by an activation literal, as contexts do
+        unsigned act = solver.new_variable();
+        cnft guarded = random_cnf(rng, vars, 10);
+        for(bvt c : guarded)
+        {
+          c.push_back(lit(act, true));
+          solver.add_clause(c);
+        }
+
+        cnft both = cnf;
+        both.insert(both.end(), guarded.begin(), guarded.end());
+        bool sat = solver.solve({lit(act)});
+        REQUIRE(sat == brute_force(both, vars));
+        if(sat)
+          REQUIRE(model_satisfies(solver, both));
+
+        // Retire the batch for good
+        solver.add_clause({lit(act, true)});
+        REQUIRE(solver.solve({}) == brute_force(cnf, vars));
+      }
+    }
+  }
+}
@@ -0,0 +1,59 @@
+#define CATCH_CONFIG_MAIN // This tells Catch to provide a main() - only do this in one cpp file
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <cstring>
+#include <solvers/smt/smt_arena.h>
+
+TEST_CASE("smt arena allocations", "[unit][solvers][smt_arena]")
+{
+  smt_arenat arena;
+  std::vector<char *> blocks;
+
+  // Enough to span several chunks
+  for(unsigned i = 0; i < 10000; i++)
+  {
+    char *p = static_cast<char *>(arena.allocate(24));
+    REQUIRE(reinterpret_cast<uintptr_t>(p) % smt_arenat::alignment == 0);
+    memset(p, i & 0xff, 24);
+    blocks.push_back(p);
+  }
+
+  // Nothing overlaps
+  for(unsigned i = 0; i < blocks.size(); i++)
+    REQUIRE(blocks[i][23] == char(i & 0xff));
+
+  SECTION("oversized requests get a chunk of their own")
+  {
+    size_t used = arena.bytes_used();
+    char *big = static_cast<char *>(arena.allocate(4 * smt_arenat::chunk_size));
+    memset(big, 0, 4 * smt_arenat::chunk_size);
+    REQUIRE(arena.bytes_used() == used + 4 * smt_arenat::chunk_size);
+  }
+}
+
+TEST_CASE("smt arena scopes", "[unit][solvers][smt_arena]")
+{
+  smt_arenat arena;
+  void *first = arena.allocate(8);
+  size_t used = arena.bytes_used();
+
+  arena.push();
+  void *inner = arena.allocate(8);
+  for(unsigned i = 0; i < 20000; i++)
+    arena.allocate(16);
+
+  arena.push();
+  arena.allocate(3 * smt_arenat::chunk_size);
+  arena.pop();
+
+  arena.pop();
+  REQUIRE(arena.bytes_used() == used);
+
+  // Storage released by the pop is handed out again
+  REQUIRE(arena.allocate(8) == inner);
+  REQUIRE(first != inner);
+
+  arena.clear();
+  REQUIRE(arena.bytes_used() == 0);
+  REQUIRE(arena.allocate(8) == first);
+}
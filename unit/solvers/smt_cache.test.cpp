@@ -0,0 +1,64 @@
+#define CATCH_CONFIG_MAIN // This tells Catch to provide a main() - only do this in one cpp file
+#include <catch2/catch.hpp>
+#include <irep2/irep2_utils.h>
+#include <solvers/smt/smt_cache.h>
+
+namespace
+{
+// The cache never dereferences its ASTs, any distinct pointers will do
+smt_astt fake_ast(uintptr_t n)
+{
+  return reinterpret_cast<smt_astt>(n + 1);
+}
+} // namespace
+
+TEST_CASE("smt cache lookups", "[unit][solvers][smt_cache]")
+{
+  smt_cachet cache;
+  const unsigned n = 5000; // enough to grow the table a few times
+
+  for(unsigned i = 0; i < n; i++)
+    cache.insert(gen_ulong(i), fake_ast(i));
+
+  REQUIRE(cache.size() == n);
+  for(unsigned i = 0; i < n; i++)
+    REQUIRE(cache.find(gen_ulong(i)) == fake_ast(i));
+  REQUIRE(cache.find(gen_ulong(n)) == nullptr);
+
+  SECTION("inserting a present expression keeps the first AST")
+  {
+    cache.insert(gen_ulong(7), fake_ast(n));
+    REQUIRE(cache.size() == n);
+    REQUIRE(cache.find(gen_ulong(7)) == fake_ast(7));
+  }
+}
+
+TEST_CASE("smt cache scopes", "[unit][solvers][smt_cache]")
+{
+  smt_cachet cache;
+  cache.insert(gen_ulong(0), fake_ast(0));
+
+  cache.push();
+  for(unsigned i = 1; i < 3000; i++)
+    cache.insert(gen_ulong(i), fake_ast(i));
+
+  cache.push();
+  cache.insert(gen_ulong(0), fake_ast(42));
+  cache.insert(gen_ulong(3000), fake_ast(3000));
+  REQUIRE(cache.find(gen_ulong(3000)) == fake_ast(3000));
+
+  cache.pop();
+  REQUIRE(cache.find(gen_ulong(3000)) == nullptr);
+  REQUIRE(cache.find(gen_ulong(0)) == fake_ast(0));
+  REQUIRE(cache.find(gen_ulong(2999)) == fake_ast(2999));
+
+  cache.pop();
+  REQUIRE(cache.size() == 1);
+  REQUIRE(cache.find(gen_ulong(0)) == fake_ast(0));
+  for(unsigned i = 1; i <= 3000; i++)
+    REQUIRE(cache.find(gen_ulong(i)) == nullptr);
+
+  // The table is still usable after shrinking back
+  cache.insert(gen_ulong(1), fake_ast(1));
+  REQUIRE(cache.find(gen_ulong(1)) == fake_ast(1));
+}
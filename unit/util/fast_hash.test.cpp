@@ -0,0 +1,40 @@
+#define CATCH_CONFIG_MAIN // This tells Catch to provide a main() - only do this in one cpp file
+#include <catch2/catch.hpp>
+
+#include <util/fast_hash.h>
+
+namespace
+{
+fast_hash hash_of(const std::string &data, size_t chunk)
+{
+  fast_hash h;
+  for(size_t i = 0; i < data.size(); i += chunk)
+    h.ingest(data.data() + i, std::min(chunk, data.size() - i));
+  h.fin();
+  return h;
+}
+} // namespace
+
+TEST_CASE("fast hash digests", "[unit][util][fast_hash]")
+{
+  const std::string data = "The quick brown fox jumps over the lazy dog";
+
+  SECTION("the digest does not depend on how data is split")
+  {
+    fast_hash whole = hash_of(data, data.size());
+    for(size_t chunk : {1, 3, 15, 16, 17})
+      REQUIRE(hash_of(data, chunk) == whole);
+  }
+
+  SECTION("different data gives different digests")
+  {
+    REQUIRE(!(hash_of(data, 5) == hash_of(data + ".", 5)));
+    REQUIRE(!(hash_of("", 1) == hash_of(std::string(1, '\0'), 1)));
+    REQUIRE(!(hash_of("ab", 1) == hash_of("ba", 1)));
+  }
+
+  SECTION("digests print as 32 hex digits")
+  {
+    REQUIRE(hash_of(data, 7).to_string().size() == 32);
+  }
+}
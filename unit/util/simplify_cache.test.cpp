@@ -0,0 +1,62 @@
+#define CATCH_CONFIG_MAIN // This tells Catch to provide a main() - only do this in one cpp file
+#include <catch2/catch.hpp>
+
+#include <irep2/irep2_utils.h>
+#include <util/simplify_cache.h>
+
+namespace
+{
+expr2tc gen_u32(unsigned v)
+{
+  return constant_int2tc(get_uint_type(32), BigInt(v));
+}
+
+expr2tc gen_sum(unsigned a, unsigned b)
+{
+  return add2tc(get_uint_type(32), gen_u32(a), gen_u32(b));
+}
+} // namespace
+
+TEST_CASE("simplify cache memoizes results", "[unit][util][simplify_cache]")
+{
+  simplify_cachet::enabled = true;
+  simplify_cachet &cache = simplify_cachet::get();
+  cache.clear();
+  cache.hits = cache.misses = 0;
+
+  const expr2tc sum = gen_sum(1, 2);
+
+  SECTION("a repeated simplification is a hit with the same result")
+  {
+    expr2tc first = sum->simplify();
+    size_t hits = cache.hits;
+    expr2tc second = gen_sum(1, 2)->simplify();
+    REQUIRE(cache.hits == hits + 1);
+    REQUIRE(first == gen_u32(3));
+    REQUIRE(second == first);
+  }
+
+  SECTION("irreducible expressions are cached as such")
+  {
+    expr2tc sym = symbol2tc(get_uint_type(32), "x");
+    REQUIRE(is_nil_expr(sym->simplify()));
+    size_t hits = cache.hits;
+    REQUIRE(is_nil_expr(sym->simplify()));
+    REQUIRE(cache.hits == hits + 1);
+  }
+
+  SECTION("entries are evicted after two generations")
+  {
+    size_t saved = simplify_cachet::generation_size;
+    simplify_cachet::generation_size = 2;
+    sum->simplify();
+    for(unsigned i = 10; i < 15; i++)
+      gen_sum(i, i)->simplify();
+    size_t misses = cache.misses;
+    sum->simplify();
+    REQUIRE(cache.misses > misses);
+    simplify_cachet::generation_size = saved;
+  }
+
+  simplify_cachet::enabled = false;
+}
@@ -0,0 +1,98 @@
+#define CATCH_CONFIG_MAIN // This tells Catch to provide a main() - only do this in one cpp file
+#include <catch2/catch.hpp>
+
+#include <irep2/irep2_utils.h>
+
+namespace
+{
+expr2tc gen_uint(unsigned width, uint64_t v)
+{
+  return constant_int2tc(get_uint_type(width), BigInt(v));
+}
+
+expr2tc gen_int(unsigned width, int64_t v)
+{
+  return constant_int2tc(get_int_type(width), BigInt(v));
+}
+
+expr2tc simplified(expr2tc e)
+{
+  simplify(e);
+  return e;
+}
+} // namespace
+
+TEST_CASE(
+  "constant folding wraps around the operand width",
+  "[unit][util][simplify]")
+{
+  SECTION("unsigned arithmetic")
+  {
+    const type2tc u8 = get_uint_type(8);
+    REQUIRE(
+      simplified(add2tc(u8, gen_uint(8, 200), gen_uint(8, 100))) ==
+      gen_uint(8, 44));
+    REQUIRE(
+      simplified(sub2tc(u8, gen_uint(8, 1), gen_uint(8, 2))) ==
+      gen_uint(8, 255));
+    REQUIRE(
+      simplified(mul2tc(u8, gen_uint(8, 16), gen_uint(8, 17))) ==
+      gen_uint(8, 16));
+
+    const type2tc u64 = get_uint_type(64);
+    REQUIRE(
+      simplified(add2tc(u64, gen_uint(64, UINT64_MAX), gen_uint(64, 2))) ==
+      gen_uint(64, 1));
+  }
+
+  SECTION("signed arithmetic")
+  {
+    const type2tc s8 = get_int_type(8);
+    REQUIRE(
+      simplified(add2tc(s8, gen_int(8, 127), gen_int(8, 1))) ==
+      gen_int(8, -128));
+    REQUIRE(
+      simplified(sub2tc(s8, gen_int(8, -128), gen_int(8, 1))) ==
+      gen_int(8, 127));
+    REQUIRE(
+      simplified(mul2tc(s8, gen_int(8, -3), gen_int(8, 5))) ==
+      gen_int(8, -15));
+
+    const type2tc s64 = get_int_type(64);
+    REQUIRE(
+      simplified(add2tc(s64, gen_int(64, INT64_MAX), gen_int(64, 1))) ==
+      gen_int(64, INT64_MIN));
+  }
+
+  SECTION("wider types are folded on BigInt")
+  {
+    const type2tc u128 = get_uint_type(128);
+    BigInt big(UINT64_MAX);
+    expr2tc sum = simplified(add2tc(
+      u128, constant_int2tc(u128, big), constant_int2tc(u128, BigInt(1))));
+    REQUIRE(is_constant_int2t(sum));
+    REQUIRE(to_constant_int2t(sum).value == big + 1);
+  }
+
+  SECTION("bitwise operations")
+  {
+    const type2tc s16 = get_int_type(16);
+    REQUIRE(
+      simplified(bitxor2tc(s16, gen_int(16, -1), gen_int(16, 0x00ff))) ==
+      gen_int(16, -256));
+    REQUIRE(
+      simplified(shl2tc(s16, gen_int(16, 1), gen_int(16, 15))) ==
+      gen_int(16, -32768));
+  }
+
+  SECTION("logic operations on integers")
+  {
+    REQUIRE(
+      simplified(and2tc(gen_uint(32, 7), gen_uint(32, 0))) ==
+      gen_false_expr());
+    REQUIRE(
+      simplified(or2tc(gen_uint(32, 0), gen_uint(32, 3))) == gen_true_expr());
+    REQUIRE(
+      simplified(xor2tc(gen_int(8, -1), gen_int(8, 2))) == gen_false_expr());
+  }
+}